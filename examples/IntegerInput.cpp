@@ -68,40 +68,38 @@ int main()
     symbolBox.setPosition({20, 188});
     symbolBox.setSize({480, 592});
 
-    // Create symbol to show
-    sf::Uint32 symbolCode = 'A';
-    symbolBox.setString(symbolCode);
-    characterCodeBox.setString(std::to_string(symbolCode));
+    // Create symbol to show. Both widgets follow it, so actions only change the code
+    SmallGui::Observable <sf::Uint32> symbolCode('A');
+    symbolBox.bindString <sf::Uint32>(symbolCode, [](const sf::Uint32& code) { return sf::String(code); });
+    characterCodeBox.bindString(symbolCode);
 
     // Add event listeners
-    previousCharacterButton.setAction(sf::Event::MouseButtonReleased, [&symbolCode, &symbolBox, &characterCodeBox]()
+    previousCharacterButton.setAction(sf::Event::MouseButtonReleased, [&symbolCode]()
     {
-        symbolCode--;
-        symbolBox.setString(symbolCode);
-        characterCodeBox.setString(std::to_string(symbolCode));
+        symbolCode.set(symbolCode.get() - 1);
     });
 
-    characterCodeBox.setAction(sf::Event::TextEntered, [&symbolCode, &symbolBox, &characterCodeBox]()
+    characterCodeBox.setAction(sf::Event::TextEntered, [&symbolCode, &characterCodeBox]()
     {
+        auto code = symbolCode.get();
+
         try
         {
             const auto stringified = static_cast <std::string>(characterCodeBox.getString());
-            symbolCode = stringified.empty() ? 0 : std::stoi(stringified);
+            code = stringified.empty() ? 0 : std::stoi(stringified);
         }
         catch (const std::exception&)
         {
             // Do nothing
         }
 
-        symbolBox.setString(symbolCode);
-        characterCodeBox.setString(std::to_string(symbolCode));
+        // Set even if the code is the same: the box is reformatted if something wrong has been typed
+        symbolCode.set(code);
     });
 
-    nextCharacterButton.setAction(sf::Event::MouseButtonReleased, [&symbolCode, &symbolBox, &characterCodeBox]()
+    nextCharacterButton.setAction(sf::Event::MouseButtonReleased, [&symbolCode]()
     {
-        symbolCode++;
-        symbolBox.setString(symbolCode);
-        characterCodeBox.setString(std::to_string(symbolCode));
+        symbolCode.set(symbolCode.get() + 1);
     });
 
     // Run the application
@@ -118,6 +116,9 @@ int main()
                 window.close();
         }
 
+        // Deliver the changed code to the widgets
+        ui.applyBindings();
+
         window.clear();
 
         // Draw the interface
@@ -0,0 +1,70 @@
+#include "SmallSfmlGui.hpp"
+
+#include <iostream>
+#include <list>
+
+// Usage: LayoutSnapshotTool <description> <snapshot> [font:<name>=<file>] [texture:<name>=<file>] ...
+//
+// Creates widgets from the description and saves their text layout,
+// so the application only has to load the snapshot on startup
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: LayoutSnapshotTool <description> <snapshot> [font:<name>=<file>] [texture:<name>=<file>] ..." << std::endl;
+        return -1;
+    }
+
+    // Lists keep addresses of the resources while new ones are added
+    std::list <sf::Font> fonts;
+    std::list <sf::Texture> textures;
+    SmallGui::UiLoader loader;
+
+    for (int i = 3; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        const auto separator = argument.find('=');
+        const auto colon = argument.find(':');
+
+        if (colon == std::string::npos || separator == std::string::npos || separator < colon)
+        {
+            std::cerr << "Invalid resource \"" << argument << "\"" << std::endl;
+            return -1;
+        }
+
+        const auto kind = argument.substr(0, colon);
+        const auto name = argument.substr(colon + 1, separator - colon - 1);
+        const auto file = argument.substr(separator + 1);
+
+        if (kind == "font")
+        {
+            fonts.emplace_back();
+            if (!fonts.back().loadFromFile(file))
+                return -1;
+
+            // Snapshots tell fonts apart by the contents of their files
+            loader.addFont(name, fonts.back(), SmallGui::LayoutSnapshot::hashFile(file));
+        }
+        else if (kind == "texture")
+        {
+            textures.emplace_back();
+            if (!textures.back().loadFromFile(file))
+                return -1;
+
+            loader.addTexture(name, textures.back());
+        }
+        else
+        {
+            std::cerr << "Unknown resource type \"" << kind << "\"" << std::endl;
+            return -1;
+        }
+    }
+
+    if (!loader.loadFromFile(argv[1]))
+        return -1;
+
+    if (!SmallGui::WidgetPool::getInstance().saveLayoutSnapshot(argv[2]))
+        return -1;
+
+    return 0;
+}
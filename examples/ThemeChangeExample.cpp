@@ -27,6 +27,10 @@ int main()
     SmallGui::TextSettings textAreaSettings(font, 36, SmallGui::TextHorizontalAlignment::Left, SmallGui::TextVerticalAlignment::Top);
     SmallGui::TextSettings textSettings(font, 36, SmallGui::TextHorizontalAlignment::Left);
 
+    // The text area is zoomed, so its text is drawn with the distance field font: new sizes only scale the same glyphs
+    SmallGui::DistanceFieldFont distanceFieldFont(font);
+    textAreaSettings.setDistanceFieldFont(distanceFieldFont);
+
     SmallGui::DecorationSettings iconIdleStyle(sf::Color::Transparent, sf::Color::Black, sf::Text::Style::Regular, 0.0f);
     SmallGui::DecorationSettings iconHoveredStyle(sf::Color(229, 243, 255), sf::Color::Black, sf::Text::Style::Regular, 1.0f, sf::Color(204, 232, 255));
     SmallGui::DecorationSettings iconPressedStyle(sf::Color(204, 232, 255), sf::Color::Black, sf::Text::Style::Regular, 1.0f, sf::Color(153, 209, 255));
@@ -122,19 +126,22 @@ int main()
         ui.forceThemeUpdate();
     });
 
-    // Run the application
+    // Run the application. The loop sleeps until something happens, and the window is drawn only if anything has changed
+    SmallGui::EventLoop loop(window);
+
     while (window.isOpen())
     {
-        sf::Event event;
+        const auto isRedrawNeeded = loop.waitFrame();
 
-        while (window.pollEvent(event))
+        for (const auto& event : loop.getEvents())
         {
-            ui.processEvent(event);
-
             if (event.type == sf::Event::Closed)
                 window.close();
         }
 
+        if (!isRedrawNeeded)
+            continue;
+
         window.clear();
 
         window.draw(background);
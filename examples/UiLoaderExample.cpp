@@ -0,0 +1,77 @@
+#include "SmallSfmlGui.hpp"
+
+// The description can be also kept in a file and loaded by 'loadFromFile'
+const char* description = R"(
+# Settings of the text and decorations
+TextSettings       labelText   font=arial characterSize=32 horizontalAlignment=Left
+TextSettings       buttonText  font=arial characterSize=32
+DecorationSettings idle        fillColor=#2B2D31 textColor=White outlineThickness=1 outlineColor=#485259
+DecorationSettings active      fillColor=#485259 textColor=White outlineThickness=1 outlineColor=#485259
+DecorationSettings label       fillColor=#2B2D31 textColor=White outlineThickness=0
+
+# Themes are combinations of the settings
+Theme              buttons     text=buttonText idle=idle hover=active press=active
+Theme              labels      text=labelText idle=label hover=label press=label
+
+# Widgets
+StaticText         greeting    theme=labels position=10,10 size=fit string="What is your name?"
+TextBox            name        theme=buttons position=10,70 size=400,60 maxInputLength=20
+PushButton         hello       theme=buttons position=420,70 size=fit string="Say hello"
+StaticText         answer      theme=labels position=10,140 size=580,60
+)";
+
+int main()
+{
+    // Create a window
+    sf::RenderWindow window(sf::VideoMode(600, 210), "UI Loader");
+    window.setFramerateLimit(30);
+
+    // Then create an instance of user interface handler
+    auto& ui = SmallGui::WidgetPool::getInstance();
+    ui.initialize(&window);
+
+    // Load the font. Make sure that you have added it to the folder
+    sf::Font font;
+    if (!font.loadFromFile("arial.ttf"))
+        return 0;
+
+    // Build all themes and widgets at once
+    SmallGui::UiLoader loader;
+    loader.addFont("arial", font);
+
+    if (!loader.loadFromMemory(description))
+        return -1;
+
+    // Widgets are found by their names to set actions
+    auto name = loader.getWidget <SmallGui::TextBox>("name");
+    auto answer = loader.getWidget <SmallGui::StaticText>("answer");
+
+    loader.getWidget("hello")->setAction(sf::Event::MouseButtonReleased, [name, answer]()
+    {
+        answer->setString(L"Hello, " + name->getString() + L"!");
+    });
+
+    // Run the application
+    while (window.isOpen())
+    {
+        sf::Event event;
+
+        while (window.pollEvent(event))
+        {
+            // Process events by GUI
+            ui.processEvent(event);
+
+            if (event.type == sf::Event::Closed)
+                window.close();
+        }
+
+        window.clear(sf::Color(43, 45, 49));
+
+        // Draw all non-hidden GUI elements
+        window.draw(ui);
+
+        window.display();
+    }
+
+    return 0;
+}
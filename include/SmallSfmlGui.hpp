@@ -6,8 +6,22 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <functional>
 #include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <bitset>
+#include <memory_resource>
 
 namespace SmallGui
 {
@@ -198,6 +212,8 @@ namespace SmallGui
         Bottom
     };
 
+    class DistanceFieldFont;
+
     /////////////////////////////////////////////////
     /// \brief Contains size-dependent info about appearance of the text in the widget
     ///
@@ -278,13 +294,101 @@ namespace SmallGui
             const FontMetrics& getFontMetrics() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes the font
+            /// \brief Makes font metrics recalculated when they are needed next time, and declared glyphs prewarmed again.
+            /// Required if the font has been loaded after it was passed to the settings
+            ///
+            /////////////////////////////////////////////////
+            void refreshFontMetrics() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the distance field font used to draw the text
+            ///
+            /// \return 'nullptr' if the text is drawn with the usual font, else the distance field font
+            ///
+            /////////////////////////////////////////////////
+            const DistanceFieldFont* getDistanceFieldFont() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the character size glyphs are actually rasterized at.
+            /// It is the base size of the distance field font, or the character size otherwise
+            ///
+            /// \return Character size of glyphs
+            ///
+            /////////////////////////////////////////////////
+            unsigned int getGlyphCharacterSize() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the scale turning glyphs into the characters of the required size
+            ///
+            /// \return The scale, 1 if the distance field font is not used
+            ///
+            /////////////////////////////////////////////////
+            float getGlyphScale() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the font. Turns off the distance field font
             ///
             /// \param font: new font
             ///
             /////////////////////////////////////////////////
             void setFont(const sf::Font& font);
 
+            /////////////////////////////////////////////////
+            /// \brief Makes the text drawn with the distance field font.
+            /// Then changing the character size only scales the text instead of rasterizing new glyphs
+            ///
+            /// \param font: the distance field font, its font also becomes the current font
+            ///
+            /////////////////////////////////////////////////
+            void setDistanceFieldFont(const DistanceFieldFont& font);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the hash of the font file, e.g. from LayoutSnapshot::hashFile() or ResourceLoader::getFontHash().
+            /// Layout snapshots use it to tell fonts apart, text with an unknown font is not saved to them.
+            /// Changing the font resets the hash
+            ///
+            /// \param hash: hash of the font data, zero if it is unknown
+            ///
+            /////////////////////////////////////////////////
+            void setFontHash(const sf::Uint64 hash);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the hash of the font file
+            ///
+            /// \return The hash, zero if it is unknown
+            ///
+            /////////////////////////////////////////////////
+            sf::Uint64 getFontHash() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Declares characters the text is expected to contain, so their glyphs can be made before the first drawing
+            ///
+            /// \param characters: the characters, repeated and already declared ones are skipped
+            ///
+            /////////////////////////////////////////////////
+            void addGlyphs(const sf::String& characters);
+
+            /////////////////////////////////////////////////
+            /// \brief Declares a range of characters the text is expected to contain, e.g. digits or Latin-1
+            ///
+            /// \param first: the first character of the range
+            /// \param last: the last character of the range, included
+            ///
+            /////////////////////////////////////////////////
+            void addGlyphRange(const sf::Uint32 first, const sf::Uint32 last);
+
+            /////////////////////////////////////////////////
+            /// \brief Rasterizes the declared glyphs that are not rasterized yet. Fonts are not thread-safe,
+            /// so it is done on the calling thread in portions that fit the time limit
+            ///
+            /// \param isBold: should bold glyphs be made?
+            /// \param timeLimit: when to stop and continue on the next call, zero means no limit
+            ///
+            /// \return 'true' if all declared glyphs are ready, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool prewarmGlyphs(const bool isBold, const sf::Time timeLimit = sf::Time::Zero) const;
+
             /////////////////////////////////////////////////
             /// \brief Changes character size
             ///
@@ -314,10 +418,21 @@ namespace SmallGui
             /// Member data
             /////////////////////////////////////////////////
             const sf::Font* m_font;                         //!< Font for all text
+            const DistanceFieldFont* m_distanceFieldFont;   //!< Font for scalable text, 'nullptr' for the usual text
+            sf::Uint64 m_fontHash;                          //!< Hash of the font data, zero if it is unknown
             unsigned int m_characterSize;                   //!< Character size for all text
             TextHorizontalAlignment m_horizontalAlignment;  //!< Horizontal alignment for all text
             TextVerticalAlignment m_verticalAlignment;      //!< Vertical alignment for all text
-            FontMetrics m_fontMetrics;                      //!<
+            mutable FontMetrics m_fontMetrics;              //!< Metrics are calculated on demand, the font may be not loaded yet
+            mutable bool m_fontMetricsNeedUpdate;           //!< Have the font or the size changed since metrics were calculated?
+            std::vector <sf::Uint32> m_glyphRepertoire;     //!< Characters expected in the text
+            mutable size_t m_prewarmedGlyphCount[2];        //!< How many characters of the repertoire are ready: regular and bold
+
+            /////////////////////////////////////////////////
+            /// \brief Makes all glyphs of the repertoire not ready, e.g. when the font changes
+            ///
+            /////////////////////////////////////////////////
+            void resetPrewarmedGlyphs();
 
             /////////////////////////////////////////////////
             /// \brief Calculates font metrics based on character size. Required to align text
@@ -325,7 +440,7 @@ namespace SmallGui
             /// \return Font metrics
             ///
             /////////////////////////////////////////////////
-            FontMetrics calculateFontMetrics();
+            FontMetrics calculateFontMetrics() const;
     };
 
     /////////////////////////////////////////////////
@@ -345,779 +460,5239 @@ namespace SmallGui
             const DecorationSettings& getIdleColorSettings() const;
             const DecorationSettings& getHoveredColorSettings() const;
             const DecorationSettings& getPressedColorSettings() const;
+            sf::Time getTransitionDuration() const;
+
+            void setTransitionDuration(const sf::Time duration);
+
+            bool prewarmGlyphs(const sf::Time timeLimit = sf::Time::Zero) const;
 
         private:
             const TextSettings& m_textSettings;
             const DecorationSettings& m_idleColorSettings;
             const DecorationSettings& m_hoverColorSettings;
             const DecorationSettings& m_pressColorSettings;
+            sf::Time m_transitionDuration;      // Colors change smoothly between states if it is not zero
     };
 
-    class Widget;
-
     /////////////////////////////////////////////////
-    /// \brief Contains possible states of the widget
+    /// \brief Packs many small images into a few large textures, so widgets using them can share one texture.
+    /// Images can be added at any time: placed images never move, new pages are created when the current ones are full
     ///
     /////////////////////////////////////////////////
-    enum class WidgetState
+    class TextureAtlas
     {
-        Idle,
-        Hovered,
-        Pressed,
-        Hidden
-    };
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Place of an image in the atlas
+            ///
+            /////////////////////////////////////////////////
+            struct Region
+            {
+                const sf::Texture* texture;     //!< The page containing the image
+                sf::IntRect textureRect;        //!< The area of the image on the page
+            };
 
-    /////////////////////////////////////////////////
-    /// \brief A singleton that contains all created widgets
-    ///
-    /////////////////////////////////////////////////
-    class WidgetPool : public sf::Drawable
-    {
-        friend class Widget;
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /// \param pageSize: width and height of each page in pixels
+            /// \param spacing: empty pixels between images to avoid bleeding of smoothed textures
+            ///
+            /////////////////////////////////////////////////
+            TextureAtlas(const unsigned int pageSize = 1024, const unsigned int spacing = 1);
 
-        public:
             /////////////////////////////////////////////////
-            /// \brief A destructor to clean up
+            /// \brief Disabled because regions point to the pages of the atlas
             ///
             /////////////////////////////////////////////////
-            virtual ~WidgetPool();
+            TextureAtlas(TextureAtlas const&) = delete;
 
             /////////////////////////////////////////////////
-            /// \brief Prohibition of creation another instance. It is not acceptable by the singleton pattern
+            /// \brief Disabled because regions point to the pages of the atlas
             ///
             /////////////////////////////////////////////////
-            WidgetPool(WidgetPool const&) = delete;
+            void operator=(TextureAtlas const&) = delete;
 
             /////////////////////////////////////////////////
-            /// \brief Prohibition of copying. It is not acceptable by the singleton pattern
+            /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            void operator=(WidgetPool const&) = delete;
+            virtual ~TextureAtlas();
 
             /////////////////////////////////////////////////
-            /// \brief Gets or creates an instance of the singleton
+            /// \brief Places the image into the atlas
             ///
-            /// \return Returns the instance
+            /// \param name: name to find the image later, must be unique
+            /// \param image: the image to copy
+            ///
+            /// \return 'nullptr' if the name is taken or the image is larger than a page, else the region of the image
             ///
             /////////////////////////////////////////////////
-            static WidgetPool& getInstance();
+            const Region* add(const std::string& name, const sf::Image& image);
 
             /////////////////////////////////////////////////
-            /// \brief Binds widgets to the window. Multiple windows are not supported
+            /// \brief Loads the image from the file and places it into the atlas
+            ///
+            /// \param name: name to find the image later, must be unique
+            /// \param fileName: path to the image
+            ///
+            /// \return 'nullptr' if loading or placing has failed, else the region of the image
             ///
             /////////////////////////////////////////////////
-            void initialize(const sf::RenderWindow* window);
+            const Region* addFromFile(const std::string& name, const std::string& fileName);
 
             /////////////////////////////////////////////////
-            /// \brief Processes user actions on widgets
+            /// \brief Finds the image by its name
+            ///
+            /// \param name: name given when the image was added
+            ///
+            /// \return 'nullptr' if there is no such image, else the region of the image
             ///
             /////////////////////////////////////////////////
-            void processEvent(const sf::Event event);
+            const Region* getRegion(std::string_view name) const;
 
             /////////////////////////////////////////////////
-            /// \brief Forces appearance of all widgets to be updated on the current frame. Must be used if any style is changed
+            /// \brief Gets the number of textures the images are packed into
+            ///
+            /// \return The number of pages
             ///
             /////////////////////////////////////////////////
-            void forceThemeUpdate() const;
+            size_t getPageCount() const;
 
         private:
             /////////////////////////////////////////////////
-            /// \brief Constructs the object. Privateness allows to follow the singleton pattern
+            /// \brief A horizontal segment of the top edge of packed images
             ///
             /////////////////////////////////////////////////
-            WidgetPool();
+            struct SkylineSegment
+            {
+                unsigned int x;
+                unsigned int y;
+                unsigned int width;
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Finds a widget hovered by mouse
+            /// \brief A texture and the skyline of the images placed on it
             ///
-            /// \param mousePosition: current mouse position in the world coordinates
+            /////////////////////////////////////////////////
+            struct Page
+            {
+                sf::Texture texture;
+                std::vector <SkylineSegment> skyline;
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the lowest place for the rectangle on the page, leftmost of equal ones
             ///
-            /// \return 'nullptr' if nothing is hovered, else the pointer to the hovered widget
+            /// \param page: the page to search
+            /// \param width: width of the rectangle
+            /// \param height: height of the rectangle
+            /// \param segmentIndex: where to put the index of the segment the rectangle starts at
+            ///
+            /// \return 'false' if the rectangle does not fit the page
             ///
             /////////////////////////////////////////////////
-            Widget* getActiveWidget(const sf::Vector2f& mousePosition) const;
+            bool findPlace(const Page& page, const unsigned int width, const unsigned int height, size_t& segmentIndex) const;
 
             /////////////////////////////////////////////////
-            /// \brief Adds the widget to the pool
+            /// \brief Raises the skyline of the page over the placed rectangle
             ///
-            /// \param widget: a widget to add
+            /// \param page: the page containing the rectangle
+            /// \param segmentIndex: index of the segment the rectangle starts at
+            /// \param width: width of the rectangle
+            /// \param height: height of the rectangle
             ///
             /////////////////////////////////////////////////
-            void addWidget(Widget* widget);
+            void raiseSkyline(Page& page, const size_t segmentIndex, const unsigned int width, const unsigned int height);
 
             /////////////////////////////////////////////////
-            /// \brief Draws all widgets on the window. Inherited from sf::Drawable
+            /// \brief Gets the height of the skyline under the rectangle starting at the segment
+            ///
+            /// \param page: the page to search
+            /// \param segmentIndex: index of the segment the rectangle starts at
+            /// \param width: width of the rectangle
+            ///
+            /// \return The height, or 'm_pageSize' if the rectangle crosses the right edge
             ///
             /////////////////////////////////////////////////
-            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+            unsigned int getSkylineHeight(const Page& page, const size_t segmentIndex, const unsigned int width) const;
 
             /////////////////////////////////////////////////
             /// Member data
             /////////////////////////////////////////////////
-            const sf::RenderWindow* m_window;   //!< The window which widgets belong to
-            std::list <Widget*> m_widgets;      //!< The container for all created widgets
-            Widget* m_activeWidget;             //!< The widget that is hovered or clicked by mouse
-            Widget* m_lastHoveredWidget;        //!< The widget that was hovered on the previous frame
-            Widget* m_lastClickedWidget;        //!< The widget that was clicked last
+            unsigned int m_pageSize;                                    //!< Width and height of the pages
+            unsigned int m_spacing;                                     //!< Empty pixels between images
+            std::list <Page> m_pages;                                   //!< List keeps addresses of textures when pages are added
+            std::map <std::string, Region, std::less<>> m_regions;      //!< Placed images by names
     };
 
     /////////////////////////////////////////////////
-    /// \brief Base class for all widgets
+    /// \brief Glyphs of a font stored as signed distance fields. They are rasterized once at the base size
+    /// and drawn sharp at any size with a shader, so zooming the text does not create new glyph textures
     ///
     /////////////////////////////////////////////////
-    class Widget : public sf::Drawable
+    class DistanceFieldFont
     {
-        friend class WidgetPool;
-
         public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Vertices of the text, one array for each texture
             ///
             /////////////////////////////////////////////////
-            Widget();
+            using VertexBatches = std::map <const sf::Texture*, sf::VertexArray>;
 
             /////////////////////////////////////////////////
-            /// \brief All widgets are constructed using WidgetPool only through the default constructor
+            /// \brief Default constructor
+            ///
+            /// \param font: the font to take glyphs from
+            /// \param baseCharacterSize: character size the glyphs are rasterized at
+            /// \param spread: distance in pixels covered by the field around the edges of glyphs
             ///
             /////////////////////////////////////////////////
-            Widget(Widget const&) = delete;
+            DistanceFieldFont(const sf::Font& font, const unsigned int baseCharacterSize = 48, const unsigned int spread = 6);
 
             /////////////////////////////////////////////////
-            /// \brief All widgets are constructed using WidgetPool only through the default constructor
+            /// \brief Disabled because text settings use the font through pointers
             ///
             /////////////////////////////////////////////////
-            void operator=(Widget const&) = delete;
+            DistanceFieldFont(DistanceFieldFont const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because text settings use the font through pointers
+            ///
+            /////////////////////////////////////////////////
+            void operator=(DistanceFieldFont const&) = delete;
 
             /////////////////////////////////////////////////
             /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            virtual ~Widget() = 0;
+            virtual ~DistanceFieldFont();
 
             /////////////////////////////////////////////////
-            /// \brief Changes position of the widget
+            /// \brief Gets the font glyphs are taken from
             ///
-            /// \param position: new position of the widget
+            /// \return The font
             ///
             /////////////////////////////////////////////////
-            virtual void setPosition(const sf::Vector2f& position);
+            const sf::Font& getFont() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes size of the widget
+            /// \brief Gets the character size the glyphs are rasterized at
             ///
-            /// \param size: new size of the widget
+            /// \return Base character size
             ///
             /////////////////////////////////////////////////
-            virtual void setSize(const sf::Vector2f& size);
+            unsigned int getBaseCharacterSize() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes theme of the widget
+            /// \brief Gets the shader turning distance fields into glyphs
             ///
-            /// \param theme: new theme of the widget
+            /// \return 'nullptr' if shaders are not available, then the usual text should be drawn instead
             ///
             /////////////////////////////////////////////////
-            void setTheme(const Theme& theme);
+            const sf::Shader* getShader() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes background texture rectangle
+            /// \brief Adds vertices of the text. Its string, position, scale, color and style are used,
+            /// its character size is replaced with the base one. Missing glyphs are made on the way
             ///
-            /// \param rectangle: new rectangle for the texture
+            /// \param text: the text to convert
+            /// \param batches: where to append the vertices
             ///
             /////////////////////////////////////////////////
-            void setBackgroundTextureRect(const sf::IntRect& rectangle);
+            void appendText(const sf::Text& text, VertexBatches& batches) const;
 
             /////////////////////////////////////////////////
-            /// \brief Sets the function to be called after the widget is released by the left mouse button
+            /// \brief Makes distance fields of the glyphs of the string that are not made yet
             ///
-            /// \param doActionOnButtonRelease: a function to call
+            /// \param string: the string containing the glyphs
+            /// \param isBold: should bold glyphs be made?
             ///
             /////////////////////////////////////////////////
-            void setAction(const sf::Event::EventType eventType, const std::function <void()> doAction);
+            void loadGlyphs(const sf::String& string, const bool isBold) const;
 
+        private:
             /////////////////////////////////////////////////
-            /// \brief Gets the current position of the widget
-            ///
-            /// \return Current position of the widget
+            /// \brief Glyph stored in the atlas. Bounds include the spread
             ///
             /////////////////////////////////////////////////
-            sf::Vector2f getPosition() const;
+            struct Glyph
+            {
+                float advance;
+                sf::FloatRect bounds;
+                const sf::Texture* texture;
+                sf::IntRect textureRect;
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Gets the current size of the widget
+            /// \brief Calculates the distance field of the area of the image
             ///
-            /// \return Current size of the widget
+            /// \param image: the image containing the glyph
+            /// \param area: the glyph on the image
+            /// \param spread: how far from edges the distance is measured
+            ///
+            /// \return The image with the distance in the alpha channel, 0.5 is the edge
             ///
             /////////////////////////////////////////////////
-            sf::Vector2f getSize() const;
+            static sf::Image makeDistanceField(const sf::Image& image, const sf::IntRect& area, const unsigned int spread);
 
             /////////////////////////////////////////////////
-            /// \brief Gets the current theme of the widget
-            ///
-            /// \return Current theme of the widget
+            /// Member data
+            /////////////////////////////////////////////////
+            const sf::Font* m_font;                                 //!< Font to take glyphs from
+            unsigned int m_baseCharacterSize;                       //!< Character size the glyphs are rasterized at
+            unsigned int m_spread;                                  //!< Width of the field around the glyphs
+            mutable TextureAtlas m_atlas;                           //!< Textures with distance fields
+            mutable std::unordered_map <sf::Uint64, Glyph> m_glyphs;  //!< Made glyphs by code points, bold ones have the 33rd bit set
+            sf::Shader m_shader;                                    //!< Shader drawing glyphs
+            bool m_isShaderLoaded;                                  //!< Is the shader available?
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Remembers measured strings: positions of characters with kerning, the advance and the bounds.
+    /// Identical labels, common in lists, are measured once. The least recently used runs are forgotten first
+    ///
+    /////////////////////////////////////////////////
+    class ShapedRunCache
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief A measured string. Matches sf::Text with the default line and letter spacing
             ///
             /////////////////////////////////////////////////
-            const Theme& getTheme() const;
+            struct ShapedRun
+            {
+                std::vector <float> positions;  //!< Horizontal position of each character, kerning included
+                float advance;                  //!< Position of the pen after the last character
+                sf::FloatRect bounds;           //!< The same as sf::Text::getLocalBounds()
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Gets the current texture rectangle of the widget
+            /// \brief Default constructor
             ///
-            /// \return Current texture rectangle of the widget
+            /// \param capacity: the maximum number of runs to keep
             ///
             /////////////////////////////////////////////////
-            sf::IntRect getBackgroundTextureRect() const;
+            ShapedRunCache(const size_t capacity = 4096);
 
             /////////////////////////////////////////////////
-            /// \brief Gets the local bounds of the rectangle of the widget
+            /// \brief Default destructor
             ///
-            /// \return Current local bounds of the widget
             /////////////////////////////////////////////////
-            sf::FloatRect getLocalBounds() const;
+            virtual ~ShapedRunCache();
 
             /////////////////////////////////////////////////
-            /// \brief Gets the global bounds of the rectangle of the widget
+            /// \brief Gets the measured string, measures it if it is not in the cache
             ///
-            /// \return Current global bounds of the widget
+            /// \param string: the string to measure
+            /// \param font: the font of the string
+            /// \param characterSize: size of the characters
+            /// \param style: style of the text, only bold and italic matter
+            ///
+            /// \return The run. Valid until the next call
             ///
             /////////////////////////////////////////////////
-            sf::FloatRect getGlobalBounds() const;
+            const ShapedRun& getRun(const sf::String& string, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style);
 
             /////////////////////////////////////////////////
-            /// \brief Allows the widget to be drawn
+            /// \brief Gets the measured part of the string without copying it into a new string
+            ///
+            /// \param string: the string containing the part to measure
+            /// \param position: index of the first character of the part
+            /// \param length: number of characters in the part
+            /// \param font: the font of the string
+            /// \param characterSize: size of the characters
+            /// \param style: style of the text, only bold and italic matter
+            ///
+            /// \return The run. Valid until the next call
             ///
             /////////////////////////////////////////////////
-            void show();
+            const ShapedRun& getRun(const sf::String& string, const size_t position, const size_t length,
+                                    const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style);
 
             /////////////////////////////////////////////////
-            /// \brief Prohibits the widget to be drawn
+            /// \brief Measures the string without the cache. Used for long strings changing often, which would fill the cache with copies
+            ///
+            /// \param string: the string to measure
+            /// \param font: the font of the string
+            /// \param characterSize: size of the characters
+            /// \param style: style of the text, only bold and italic matter
+            /// \param run: the measured string, its storage is reused
             ///
             /////////////////////////////////////////////////
-            void hide();
+            static void measure(const sf::String& string, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style, ShapedRun& run);
 
             /////////////////////////////////////////////////
-            /// \brief Checks if the widget is hidden
-            ///
-            /// \return 'true' if the widget is hidden, 'false' if it is shown
+            /// \brief Forgets all runs. Must be used if any font has been loaded again
             ///
             /////////////////////////////////////////////////
-            bool isHidden() const;
+            void clear();
 
-        protected:
             /////////////////////////////////////////////////
-            /// Member data
+            /// \brief Changes the maximum number of runs, the least recently used are forgotten if there are more
+            ///
+            /// \param capacity: the maximum number of runs, zero disables caching
+            ///
             /////////////////////////////////////////////////
-            mutable sf::RectangleShape m_rectangle;                             //!< Rectangle that represents background and borders
-            const Theme* m_theme;                                               //!< Pointer to the theme using which the widget is stylized
-            WidgetState m_state;                                                //!< Current state of the widget
-            mutable bool m_contentNeedsUpdate;                                  //!< Does the theme need to be updated?
-            std::map <sf::Event::EventType, std::function <void()>> m_doAction; //!< Functions to be called on events
+            void setCapacity(const size_t capacity);
 
             /////////////////////////////////////////////////
-            /// \brief Updates theme when the state changes
+            /// \brief Gets the maximum number of runs
+            ///
+            /// \return The capacity
             ///
             /////////////////////////////////////////////////
-            virtual void refreshTheme() const;
+            size_t getCapacity() const;
 
             /////////////////////////////////////////////////
-            /// \brief Updates theme of the rectangle when the state changes
+            /// \brief Gets the number of runs in the cache
+            ///
+            /// \return Number of runs
             ///
             /////////////////////////////////////////////////
-            void refreshRectangleTheme() const;
+            size_t getSize() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes state and calls refreshTheme()
+            /// \brief Gets the number of requests answered from the cache
             ///
-            /// \param state: new state of the widget
+            /// \return Number of hits
             ///
             /////////////////////////////////////////////////
-            void changeState(const WidgetState state);
+            size_t getHitCount() const;
 
             /////////////////////////////////////////////////
-            /// \brief Draws the rectangle (does not update theme) Used only inside draw() method
+            /// \brief Gets the number of requests that required measuring
+            ///
+            /// \return Number of misses
             ///
             /////////////////////////////////////////////////
-            void drawRectangle(sf::RenderTarget& target, sf::RenderStates states) const;
+            size_t getMissCount() const;
 
         private:
             /////////////////////////////////////////////////
-            /// \brief Forces appearance to be updated on the current frame. Should be used if the style is changed
+            /// \brief Everything the measurement depends on
             ///
             /////////////////////////////////////////////////
-            void forceThemeUpdate() const;
+            struct Key
+            {
+                std::basic_string <sf::Uint32> string;
+                const sf::Font* font;
+                unsigned int characterSize;
+                sf::Uint32 style;
+
+                bool operator==(const Key& other) const;
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Draws the widget on the window. Inherited from sf::Drawable
+            /// \brief Hash of the key for the index
             ///
             /////////////////////////////////////////////////
-            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const;
+            };
+
+            using Entry = std::pair <Key, ShapedRun>;
 
             /////////////////////////////////////////////////
-            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            /// \brief Measures the string the same way sf::Text does
             ///
-            /// \param event: event caught by the window
-            /// \param mousePosition: current mouse position in the world coordinates
+            /// \param key: the string and its font settings
+            ///
+            /// \return The measured run
             ///
             /////////////////////////////////////////////////
-            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition);
+            static ShapedRun shape(const Key& key);
+
+            /////////////////////////////////////////////////
+            /// \brief Measures the characters the same way sf::Text does
+            ///
+            /// \param begin: the first character
+            /// \param end: the character after the last one
+            /// \param font: the font of the characters
+            /// \param characterSize: size of the characters
+            /// \param style: style of the text, only bold and italic matter
+            /// \param run: the measured characters, its storage is reused
+            ///
+            /////////////////////////////////////////////////
+            static void shape(const sf::Uint32* begin, const sf::Uint32* end, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style, ShapedRun& run);
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            size_t m_capacity;                                                              //!< The maximum number of runs
+            std::list <Entry> m_runs;                                                       //!< Runs from the most recently used
+            std::unordered_map <Key, std::list <Entry>::iterator, KeyHash> m_index;         //!< Runs by keys
+            ShapedRun m_uncachedRun;                                                        //!< The last run if caching is disabled
+            Key m_lookupKey;                                                                //!< Reused for searching, so hits do not allocate
+            size_t m_hitCount;                                                              //!< Requests answered from the cache
+            size_t m_missCount;                                                             //!< Requests that required measuring
     };
 
     /////////////////////////////////////////////////
-    /// \brief Widget that contains text
+    /// \brief Memory for temporary data of a layout. Allocation only moves a pointer, and nothing is freed
+    /// until the arena is reset. Blocks are kept after resetting, so layouts of the same size do not use the heap
     ///
     /////////////////////////////////////////////////
-    class TextBasedWidget : public Widget
+    class ScratchArena : public std::pmr::memory_resource
     {
         public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Default constructor
+            ///
+            /// \param blockSize: size of the first block in bytes
             ///
             /////////////////////////////////////////////////
-            TextBasedWidget();
+            ScratchArena(const size_t blockSize = 16384);
 
             /////////////////////////////////////////////////
             /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            virtual ~TextBasedWidget() = 0;
+            virtual ~ScratchArena();
 
             /////////////////////////////////////////////////
-            /// \brief Calculates the size of the widget based on the text. Updates splitting and theme before resizing
+            /// \brief Makes all memory free again. Everything allocated before becomes invalid.
+            /// If the last layout did not fit one block, the blocks are replaced by a single one of their total size
             ///
             /////////////////////////////////////////////////
-            void setSizeFitToText();
+            void reset();
 
             /////////////////////////////////////////////////
-            /// \brief Sets the string inside the widget
+            /// \brief Gets the number of blocks ever allocated on the heap. Other memory of widgets is not counted
             ///
-            /// \param text: text to draw, non-printable characters are not affected
+            /// \return Number of blocks taken by the arena
             ///
             /////////////////////////////////////////////////
-            void setString(const sf::String& text);
+            size_t getAllocationCount() const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes padding (borders inside the widget)
+            /// \brief Gets the total size of the kept blocks
             ///
-            /// \param padding: new padding of the widget
+            /// \return Size in bytes
             ///
             /////////////////////////////////////////////////
-            void setPadding(const sf::Vector2f& padding);
+            size_t getReservedSize() const;
 
+        private:
             /////////////////////////////////////////////////
-            /// \brief Allows the widget to split text in several lines, or forces to keep all the string in one line
-            ///
-            /// \param isMultiline: should the text be drawn in multiple lines?
+            /// \brief Memory taken from the heap at once
             ///
             /////////////////////////////////////////////////
-            void setMultilined(bool isMultiline);
+            struct Block
+            {
+                std::unique_ptr <unsigned char[]> data;     //!< The memory
+                size_t size;                                //!< Size of the memory
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Changes position of the widget
-            ///
-            /// \param position: new position of the widget
+            /// \brief Gives memory from the current block, takes a new block if it does not fit. Inherited from std::pmr::memory_resource
             ///
             /////////////////////////////////////////////////
-            virtual void setPosition(const sf::Vector2f& position) override;
+            virtual void* do_allocate(size_t bytes, size_t alignment) override;
 
             /////////////////////////////////////////////////
-            /// \brief Gets the string kept inside the widget
+            /// \brief Does nothing, memory is freed by resetting. Inherited from std::pmr::memory_resource
             ///
-            /// \return The string that is drawn on the widget
+            /////////////////////////////////////////////////
+            virtual void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Compares the arenas by addresses. Inherited from std::pmr::memory_resource
             ///
             /////////////////////////////////////////////////
-            sf::String getString() const;
+            virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
 
             /////////////////////////////////////////////////
-            /// \brief Gets the current padding of the widget
+            /// Member data
+            /////////////////////////////////////////////////
+            std::vector <Block> m_blocks;       //!< Kept blocks
+            size_t m_blockSize;                 //!< The least size of a new block
+            size_t m_currentBlock;              //!< Index of the block memory is given from
+            size_t m_offset;                    //!< Used bytes of the current block
+            size_t m_allocationCount;           //!< Blocks ever allocated on the heap
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Loads fonts and textures on worker threads. Returned resources can be given to themes and widgets at once:
+    /// they stay empty, so nothing is drawn instead of them, until update() finishes their loading
+    ///
+    /////////////////////////////////////////////////
+    class ResourceLoader
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
             ///
-            /// \return Current padding of the widget
+            /// \param workerCount: number of threads reading and decoding files
             ///
             /////////////////////////////////////////////////
-            sf::Vector2f getPadding() const;
+            ResourceLoader(const unsigned int workerCount = 2);
 
             /////////////////////////////////////////////////
-            /// \brief Gets the flag allowing the text to be split to multiple lines
+            /// \brief Disabled because resources are used through pointers
             ///
-            /// \return 'true' if the text is allowed to be split to multiple lines, else 'false'
+            /////////////////////////////////////////////////
+            ResourceLoader(ResourceLoader const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because resources are used through pointers
             ///
             /////////////////////////////////////////////////
-            bool isMultiline() const;
+            void operator=(ResourceLoader const&) = delete;
 
-        protected:
             /////////////////////////////////////////////////
-            /// Member data
+            /// \brief Stops workers. Files not loaded yet are skipped
+            ///
             /////////////////////////////////////////////////
-            mutable std::vector <sf::Text> m_lines;     //!< Lines of the text to be drawn
-            sf::String m_string;                        //!< The whole text put in the widget
-            sf::Vector2f m_padding;                     //!< Padding for the content
-            bool m_isMultiline;                         //!< Is the text allowed to be split in multiple lines?
-            bool m_isTrimmable;                         //!< Should word separators be deleted from the ends and beginnings?
+            virtual ~ResourceLoader();
 
             /////////////////////////////////////////////////
-            /// \brief Converts 'm_string' to 'm_lines' by pushing to one or splitting to several lines
+            /// \brief Starts loading the font in the background
+            ///
+            /// \param fileName: path to the font
+            ///
+            /// \return The font, empty until it is loaded. The same file gives the same font
             ///
             /////////////////////////////////////////////////
-            void updateTextSplitting() const;
+            const sf::Font& loadFont(const std::string& fileName);
 
             /////////////////////////////////////////////////
-            /// \brief Calculates position of each line
+            /// \brief Starts loading the texture in the background
+            ///
+            /// \param fileName: path to the image
+            ///
+            /// \return The texture, empty until it is loaded. The same file gives the same texture
             ///
             /////////////////////////////////////////////////
-            void placeText() const;
+            const sf::Texture& loadTexture(const std::string& fileName);
 
             /////////////////////////////////////////////////
-            /// \brief Updates theme when the state changes
+            /// \brief Finishes loading of the files read by workers. Must be called on the thread drawing the window,
+            /// e.g. once a frame. Widgets are laid out again if anything has been loaded
+            ///
+            /// \return Number of resources that have become ready
             ///
             /////////////////////////////////////////////////
-            virtual void refreshTheme() const override;
+            size_t update();
 
             /////////////////////////////////////////////////
-            /// \brief Updates theme of text when the state changes
+            /// \brief Gets the number of resources not ready yet
+            ///
+            /// \return Number of loading resources
             ///
             /////////////////////////////////////////////////
-            void refreshTextTheme() const;
+            size_t getPendingCount() const;
 
             /////////////////////////////////////////////////
-            /// \brief Draws the text (does not update theme) Used only inside draw() method
+            /// \brief Gets the hash of the font file, to be passed to TextSettings::setFontHash()
+            ///
+            /// \param fileName: path to the font given to loadFont()
+            ///
+            /// \return The hash, zero until the font is loaded
             ///
             /////////////////////////////////////////////////
-            void drawText(sf::RenderTarget& target, sf::RenderStates states) const;
+            sf::Uint64 getFontHash(const std::string& fileName) const;
 
         private:
             /////////////////////////////////////////////////
-            /// \brief Draws the widget on the window. Inherited from sf::Drawable
+            /// \brief A font and its file. The data must live as long as the font
             ///
             /////////////////////////////////////////////////
-            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+            struct FontEntry
+            {
+                sf::Font font;
+                std::vector <char> data;
+                sf::Uint64 hash = 0;
+            };
 
             /////////////////////////////////////////////////
-            /// \brief Finds position of the first separator between words
-            ///
-            /// \param begin: position where the search starts from
+            /// \brief Takes jobs from the queue until the loader is destroyed
             ///
             /////////////////////////////////////////////////
-            size_t findFirstWordSeparatorPosition(size_t begin) const;
+            void runWorker();
 
             /////////////////////////////////////////////////
-            /// \brief Deletes all word separators from the beginning and ends of strings
+            /// \brief Puts the job to the queue
             ///
-            /// \param line: a line to trim
+            /// \param job: the work to do on a worker thread
             ///
             /////////////////////////////////////////////////
-            sf::String trimLine(const sf::String& line) const;
+            void addJob(std::function <void()> job);
 
             /////////////////////////////////////////////////
             /// Member data
             /////////////////////////////////////////////////
-            static const sf::String m_wordSeparators;   //!< A string containing separators between words to split them
+            std::map <std::string, FontEntry, std::less<>> m_fonts;         //!< Fonts by file names. Map keeps addresses of the elements
+            std::map <std::string, sf::Texture, std::less<>> m_textures;    //!< Textures by file names
+            size_t m_pendingCount;                                          //!< Resources not ready yet
+            std::deque <std::function <void()>> m_jobs;                     //!< Files to read
+            std::vector <std::function <void()>> m_finishers;               //!< Work left for the main thread
+            bool m_isStopping;                                              //!< Should workers quit?
+            std::mutex m_mutex;                                             //!< Guards jobs, finishers and the stop flag
+            std::condition_variable m_jobAdded;                             //!< Wakes up workers
+            std::vector <std::thread> m_workers;                            //!< Threads reading files
     };
 
     /////////////////////////////////////////////////
-    /// \brief Clickable and labeled widget
+    /// \brief A versioned binary blob with precomputed layout of widgets: line breaks and positions of lines.
+    /// Allows to skip layout at startup if fonts, sizes and strings have not changed since the snapshot was made
     ///
     /////////////////////////////////////////////////
-    class PushButton : public TextBasedWidget
+    class LayoutSnapshot
     {
         public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Version of the format. Snapshots of other versions are rejected
             ///
             /////////////////////////////////////////////////
-            PushButton();
+            static constexpr sf::Uint32 Version = 1;
+
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty snapshot
+            ///
+            /////////////////////////////////////////////////
+            LayoutSnapshot();
 
             /////////////////////////////////////////////////
             /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            virtual ~PushButton();
-    };
+            virtual ~LayoutSnapshot();
 
-    /////////////////////////////////////////////////
-    /// \brief A clickable widget that is represented by an icon
-    ///
-    /////////////////////////////////////////////////
-    class IconButton : public Widget
-    {
-        public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Reads the whole snapshot into memory at once and checks its header
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the snapshot has been loaded and has the current version, else 'false'
             ///
             /////////////////////////////////////////////////
-            IconButton();
+            bool loadFromFile(const std::string& fileName);
 
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Writes the snapshot to the file
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the snapshot has been written, else 'false'
             ///
             /////////////////////////////////////////////////
-            virtual ~IconButton();
+            bool saveToFile(const std::string& fileName) const;
 
             /////////////////////////////////////////////////
-            /// \brief Changes position of the widget
+            /// \brief Removes all data and writes the header
             ///
-            /// \param position: new position of the widget
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Appends a value of a trivial type
+            ///
+            /// \param value: a value to write
             ///
             /////////////////////////////////////////////////
-            virtual void setPosition(const sf::Vector2f& position) override;
+            template <typename T>
+            void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable <T>::value, "Only trivial types can be written directly");
+
+                const auto bytes = reinterpret_cast <const char*>(&value);
+                m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+            }
 
             /////////////////////////////////////////////////
-            /// \brief Changes size of the widget
+            /// \brief Reads the next value of a trivial type
             ///
-            /// \param size: new size of the widget
+            /// \param value: where to put the value
+            ///
+            /// \return 'false' if the current record has ended
             ///
             /////////////////////////////////////////////////
-            virtual void setSize(const sf::Vector2f& size) override;
+            template <typename T>
+            bool read(T& value)
+            {
+                static_assert(std::is_trivially_copyable <T>::value, "Only trivial types can be read directly");
+
+                if (m_readPosition + sizeof(T) > m_recordEnd)
+                    return false;
+
+                std::memcpy(&value, m_data.data() + m_readPosition, sizeof(T));
+                m_readPosition += sizeof(T);
+
+                return true;
+            }
 
             /////////////////////////////////////////////////
-            /// \brief Changes texture of the icon
+            /// \brief Appends the string as its length and UTF-32 characters
             ///
-            /// \param texture: new texture of the icon
+            /// \param string: a string to write
             ///
             /////////////////////////////////////////////////
-            void setIconTexture(const sf::Texture& texture);
+            void writeString(const sf::String& string);
 
             /////////////////////////////////////////////////
-            /// \brief Changes texture rectangle of the icon
+            /// \brief Reads the next string
             ///
-            /// \param texture: new texture rectangle of the icon
+            /// \param string: where to put the string
+            ///
+            /// \return 'false' if the current record has ended
             ///
             /////////////////////////////////////////////////
-            void setIconTextureRect(const sf::IntRect& rectangle);
+            bool readString(sf::String& string);
 
             /////////////////////////////////////////////////
-            /// \brief Gets texture of the icon
+            /// \brief Starts a record of the widget. Records are skippable, so a widget that cannot restore its layout does not break the next ones
             ///
-            /// \return Current texture of the icon
+            /////////////////////////////////////////////////
+            void beginRecord();
+
+            /////////////////////////////////////////////////
+            /// \brief Finishes the record started by beginRecord()
             ///
             /////////////////////////////////////////////////
-            const sf::Texture* getIconTexture() const;
+            void endRecord();
 
             /////////////////////////////////////////////////
-            /// \brief Gets texture rectangle of the icon
+            /// \brief Starts reading the next record
             ///
-            /// \return Current texture rectangle of the icon
+            /// \return 'false' if there are no more records
             ///
             /////////////////////////////////////////////////
-            sf::IntRect getIconTextureRect() const;
+            bool openRecord();
 
-        private:
             /////////////////////////////////////////////////
-            /// Member date
+            /// \brief Skips the rest of the current record
+            ///
             /////////////////////////////////////////////////
-            mutable sf::Sprite m_icon;      //!< Icon to be drawn
+            void closeRecord();
 
             /////////////////////////////////////////////////
-            /// \brief Changes the size of the icon
+            /// \brief Calculates FNV-1a hash. Used to check that the layout has been made for the same inputs
+            ///
+            /// \param data: bytes to hash
+            /// \param size: number of bytes
+            /// \param hash: hash of the previous data to continue
+            ///
+            /// \return The hash
             ///
             /////////////////////////////////////////////////
-            void updateSpriteSize() const;
+            static sf::Uint64 hash(const void* data, const size_t size, sf::Uint64 hash = 14695981039346656037ULL);
 
             /////////////////////////////////////////////////
-            /// \brief Draws the widget on the window. Inherited from sf::Drawable
+            /// \brief Calculates the hash of the whole file, e.g. of a font to identify it in snapshots
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return The hash, zero if the file cannot be read
             ///
             /////////////////////////////////////////////////
-            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+            static sf::Uint64 hashFile(const std::string& fileName);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Signature at the beginning of the file: "SGLS"
+            ///
+            /////////////////////////////////////////////////
+            static constexpr sf::Uint32 Magic = 0x534C4753;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::vector <char> m_data;      //!< The whole snapshot
+            size_t m_recordBegin;           //!< Where the size of the record being written is stored
+            size_t m_readPosition;          //!< Where the next value is read from
+            size_t m_recordEnd;             //!< Where the record being read ends
     };
 
     /////////////////////////////////////////////////
-    /// \brief A clickable widget that is represented by a box and shows the list of items when clicked. Can be used as a drop down menu
+    /// \brief Rectangle with a fill, a texture and an outline, stored as plain values.
+    /// Unlike sf::RectangleShape, it keeps no vertices and no transform: they are made by DrawSink only when it is drawn
     ///
     /////////////////////////////////////////////////
-    class DropDownList : public TextBasedWidget
+    class PlainRectangle
     {
         public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Default constructor to create a white rectangle of zero size without outline
             ///
             /////////////////////////////////////////////////
-            DropDownList();
+            PlainRectangle();
 
             /////////////////////////////////////////////////
-            /// \brief Default destructor
+            /// \brief Sets the position of the top left corner
+            ///
+            /// \param position: the position
             ///
             /////////////////////////////////////////////////
-            virtual ~DropDownList();
+            void setPosition(const sf::Vector2f& position);
 
             /////////////////////////////////////////////////
-            /// \brief Add new item to the list
+            /// \brief Sets the size without the outline
             ///
-            /// \param label: text to be shown on the new list item
-            /// \param doAction: function to be called after the item receives 'MouseButtonRelease'
+            /// \param size: the size
             ///
             /////////////////////////////////////////////////
-            void addListItem(const sf::String& label, const std::function <void()> doAction);
+            void setSize(const sf::Vector2f& size);
 
             /////////////////////////////////////////////////
-            /// \brief Sets the specified theme for all list items
+            /// \brief Sets the texture of the fill. If there has been neither texture nor texture rectangle, the rectangle covers the whole texture
             ///
-            /// \param theme: a theme for items
+            /// \param texture: the texture, 'nullptr' to disable texturing
             ///
             /////////////////////////////////////////////////
-            void setItemsTheme(const Theme& theme);
+            void setTexture(const sf::Texture* texture);
 
-        private:
             /////////////////////////////////////////////////
-            /// Member data
+            /// \brief Sets the part of the texture shown by the fill
+            ///
+            /// \param rectangle: the part in pixels
+            ///
             /////////////////////////////////////////////////
-            std::list <PushButton> m_items;     //!< List of items. May cause the program crash if some magic moves the item in the memory: WidgetPool will have an outdated pointer
-            const Theme* m_itemsTheme;          //!< A theme for all items to apply automatically
-            bool m_isOpened;                    //!< Are the items shown?
+            void setTextureRect(const sf::IntRect& rectangle);
 
             /////////////////////////////////////////////////
-            /// \brief Allows all items to be shown
+            /// \brief Sets the color of the fill
+            ///
+            /// \param color: the color
             ///
             /////////////////////////////////////////////////
-            void showItems();
+            void setFillColor(const sf::Color& color);
 
             /////////////////////////////////////////////////
-            /// \brief Prohibites all items from being shown
+            /// \brief Sets the color of the outline
+            ///
+            /// \param color: the color
             ///
             /////////////////////////////////////////////////
-            void hideItems();
+            void setOutlineColor(const sf::Color& color);
 
             /////////////////////////////////////////////////
-            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            /// \brief Sets the thickness of the outline. A positive outline is drawn outside, a negative one inside
             ///
-            /// \param event: event caught by the window
-            /// \param mousePosition: current mouse position in the world coordinates
+            /// \param thickness: the thickness
             ///
             /////////////////////////////////////////////////
-            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
-    };
+            void setOutlineThickness(const float thickness);
 
-    /////////////////////////////////////////////////
-    /// \brief A gui element that allows the user to input text. Does not allow to input multilined text, but can show it if it is too long
-    ///
-    /////////////////////////////////////////////////
-    class TextBox : public TextBasedWidget
-    {
-        public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Gets the position of the top left corner
+            ///
+            /// \return The position
             ///
             /////////////////////////////////////////////////
-            TextBox();
+            const sf::Vector2f& getPosition() const;
 
             /////////////////////////////////////////////////
-            /// \brief Default destructor
+            /// \brief Gets the size without the outline
+            ///
+            /// \return The size
             ///
             /////////////////////////////////////////////////
-            virtual ~TextBox();
+            const sf::Vector2f& getSize() const;
 
             /////////////////////////////////////////////////
-            /// \brief Gets the value showing how many symbols user can input
+            /// \brief Gets the texture of the fill
             ///
-            /// \return Current maximum allowed length in characters
+            /// \return 'nullptr' if there is no texture, else the texture
             ///
             /////////////////////////////////////////////////
-            size_t getMaxInputLength() const;
+            const sf::Texture* getTexture() const;
 
             /////////////////////////////////////////////////
-            /// \brief Sets the value showing how many symbols user can input
+            /// \brief Gets the part of the texture shown by the fill
             ///
-            /// \param New maximum allowed length in characters
+            /// \return The part in pixels
             ///
             /////////////////////////////////////////////////
-            void setMaxInputLength(const size_t maxInputLength = sf::String::InvalidPos);
+            const sf::IntRect& getTextureRect() const;
 
-        private:
             /////////////////////////////////////////////////
-            /// Member data
+            /// \brief Gets the color of the fill
+            ///
+            /// \return The color
+            ///
             /////////////////////////////////////////////////
-            size_t m_maxInputLength;        //!< Maximum allowed length in characters. Initially set to the maximum size of sf::String
+            const sf::Color& getFillColor() const;
 
             /////////////////////////////////////////////////
-            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            /// \brief Gets the color of the outline
             ///
-            /// \param event: event caught by the window
-            /// \param mousePosition: current mouse position in the world coordinates
+            /// \return The color
             ///
             /////////////////////////////////////////////////
-            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+            const sf::Color& getOutlineColor() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the thickness of the outline
+            ///
+            /// \return The thickness
+            ///
+            /////////////////////////////////////////////////
+            float getOutlineThickness() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the bounds relative to the position, including the outline drawn outside
+            ///
+            /// \return The bounds, the same as sf::RectangleShape has
+            ///
+            /////////////////////////////////////////////////
+            sf::FloatRect getLocalBounds() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the bounds including the outline drawn outside
+            ///
+            /// \return The bounds, the same as sf::RectangleShape has
+            ///
+            /////////////////////////////////////////////////
+            sf::FloatRect getGlobalBounds() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::Vector2f m_position;            //!< Position of the top left corner
+            sf::Vector2f m_size;                //!< Size without the outline
+            sf::IntRect m_textureRect;          //!< Part of the texture shown by the fill
+            const sf::Texture* m_texture;       //!< Texture of the fill
+            sf::Color m_fillColor;              //!< Color of the fill
+            sf::Color m_outlineColor;           //!< Color of the outline
+            float m_outlineThickness;           //!< Thickness of the outline, negative if it is drawn inside
     };
 
     /////////////////////////////////////////////////
-    /// \brief A gui element that allows to set a tick or unset it. The checkmark can be any string or symbol that the font allows
+    /// \brief Receives the primitives widgets are made of. Allows to draw the interface
+    /// on something other than sf::RenderTarget, e.g. to record it without OpenGL
     ///
     /////////////////////////////////////////////////
-    class CheckBox : public TextBasedWidget
+    class DrawSink
     {
         public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            CheckBox();
+            virtual ~DrawSink();
 
             /////////////////////////////////////////////////
-            /// \brief Default destructor
+            /// \brief Draws vertices, the texture and the shader are taken from the states
+            ///
+            /// \param vertices: pointer to the first vertex
+            /// \param count: number of vertices
+            /// \param type: how vertices are connected
+            /// \param states: transform, texture, shader and blending
             ///
             /////////////////////////////////////////////////
-            virtual ~CheckBox();
+            virtual void drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states) = 0;
 
             /////////////////////////////////////////////////
-            /// \brief Checks if the checkbox is checked with a check
+            /// \brief Draws a run of glyphs. Glyphs are kept as text, so they can be recorded without rasterizing them
             ///
-            /// \return 'true' if checked, 'false' if unchecked
+            /// \param text: the text to draw
+            /// \param states: transform and blending
             ///
             /////////////////////////////////////////////////
-            bool isChecked() const;
+            virtual void drawGlyphRun(const sf::Text& text, const sf::RenderStates& states) = 0;
 
             /////////////////////////////////////////////////
-            /// \brief Checks if the checkbox is checked with a check
+            /// \brief Sets the view. Widgets use views to clip their content
             ///
-            /// \return 'true' if checked, 'false' if unchecked
+            /// \param view: the new view
             ///
             /////////////////////////////////////////////////
-            void setChecked(const bool isChecked);
+            virtual void setView(const sf::View& view) = 0;
 
-        private:
             /////////////////////////////////////////////////
-            /// Member data
+            /// \brief Gets the current view
+            ///
+            /// \return The view
+            ///
             /////////////////////////////////////////////////
-            bool m_isChecked;   //!< Is the checkmark set?
+            virtual const sf::View& getView() const = 0;
 
             /////////////////////////////////////////////////
-            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            /// \brief Draws the rectangle as a quad for the fill and a strip for the outline. Invisible parts are skipped
             ///
-            /// \param event: event caught by the window
-            /// \param mousePosition: current mouse position in the world coordinates
+            /// \param rectangle: the rectangle to draw
+            /// \param states: transform and blending
             ///
             /////////////////////////////////////////////////
-            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+            void drawRectangle(const sf::RectangleShape& rectangle, const sf::RenderStates& states);
 
             /////////////////////////////////////////////////
-            /// \brief Draws the widget on the window. Inherited from sf::Drawable
+            /// \brief Draws the rectangle as a quad for the fill and a strip for the outline. Invisible parts are skipped
+            ///
+            /// \param rectangle: the rectangle to draw
+            /// \param states: transform and blending
             ///
             /////////////////////////////////////////////////
-            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
-    };
+            void drawRectangle(const PlainRectangle& rectangle, const sf::RenderStates& states);
 
-    /////////////////////////////////////////////////
-    /// \brief A gui element that allows to set a tick or unset it. The checkmark can be any string or symbol that the font allows
-    ///
-    /////////////////////////////////////////////////
-    class StaticText : public TextBasedWidget
-    {
-        public:
             /////////////////////////////////////////////////
-            /// \brief Default constructor to create an empty object
+            /// \brief Draws the sprite as a textured quad
+            ///
+            /// \param sprite: the sprite to draw
+            /// \param states: transform and blending
             ///
             /////////////////////////////////////////////////
-            StaticText();
+            void drawSprite(const sf::Sprite& sprite, const sf::RenderStates& states);
+
+            /////////////////////////////////////////////////
+            /// \brief Draws all vertices of the array
+            ///
+            /// \param vertices: the array to draw
+            /// \param states: transform, texture, shader and blending
+            ///
+            /////////////////////////////////////////////////
+            void drawVertices(const sf::VertexArray& vertices, const sf::RenderStates& states);
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Passes the primitives to a window or a texture
+    ///
+    /////////////////////////////////////////////////
+    class RenderTargetSink : public DrawSink
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Creates a sink drawing on the target
+            ///
+            /// \param target: the target to draw on, must live longer than the sink
+            ///
+            /////////////////////////////////////////////////
+            explicit RenderTargetSink(sf::RenderTarget& target);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~RenderTargetSink();
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the vertices on the target. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the text on the target. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawGlyphRun(const sf::Text& text, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the view of the target. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void setView(const sf::View& view) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the view of the target. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual const sf::View& getView() const override;
+
+            using DrawSink::drawVertices;
+
+        private:
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::RenderTarget& m_target;     //!< The target to draw on
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Joins consecutive small primitives of the same texture into one draw of another sink.
+    /// Fills and outlines of rectangles, sprites and other quads are moved by their transforms and collected
+    /// until the texture, the blending or the view changes, or anything else is drawn, so the order is kept
+    ///
+    /////////////////////////////////////////////////
+    class BatchingSink : public DrawSink
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief The most vertices of a primitive to be joined. Larger ones are passed as they are, copying them costs more than a draw
+            ///
+            /////////////////////////////////////////////////
+            static constexpr size_t MaxBatchedCount = 64;
+
+            /////////////////////////////////////////////////
+            /// \brief Creates a sink drawing through another one
+            ///
+            /// \param sink: the sink receiving the joined primitives, must live longer than this one
+            /// \param vertices: storage for the collected vertices, kept by the caller so its memory is reused between frames
+            ///
+            /////////////////////////////////////////////////
+            BatchingSink(DrawSink& sink, std::vector <sf::Vertex>& vertices);
+
+            /////////////////////////////////////////////////
+            /// \brief Draws what has been collected
+            ///
+            /////////////////////////////////////////////////
+            virtual ~BatchingSink();
+
+            /////////////////////////////////////////////////
+            /// \brief Collects the vertices if they can be joined, else draws them after the collected ones. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the text after the collected vertices. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawGlyphRun(const sf::Text& text, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the view after drawing the collected vertices. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void setView(const sf::View& view) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the view of the other sink. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual const sf::View& getView() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the collected vertices as one primitive
+            ///
+            /////////////////////////////////////////////////
+            void flush();
+
+            using DrawSink::drawVertices;
+
+        private:
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            DrawSink& m_sink;                       //!< The sink receiving the joined primitives
+            std::vector <sf::Vertex>& m_vertices;   //!< Collected triangles, already moved by their transforms
+            const sf::Texture* m_texture;           //!< Texture of the collected triangles
+            sf::BlendMode m_blendMode;              //!< Blending of the collected triangles
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Records the primitives as a list of commands instead of drawing them.
+    /// The list can be counted, hashed, compared with another one and replayed into any sink
+    ///
+    /////////////////////////////////////////////////
+    class DrawRecorder : public DrawSink
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Kinds of recorded commands
+            ///
+            /////////////////////////////////////////////////
+            enum class CommandType
+            {
+                Vertices,       //!< Vertices are drawn
+                GlyphRun,       //!< A run of glyphs is drawn
+                Clip,           //!< The view is changed
+                TextureBind     //!< The next primitives use another texture or glyph page
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief A recorded command
+            ///
+            /////////////////////////////////////////////////
+            struct Command
+            {
+                CommandType type;                   //!< Kind of the command
+                sf::PrimitiveType primitiveType;    //!< How vertices are connected
+                size_t first;                       //!< The first vertex, the glyph run or the view of the command
+                size_t count;                       //!< Number of vertices
+                sf::RenderStates states;            //!< States of the drawing, the transform of the text included
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Everything needed to draw a run of glyphs again
+            ///
+            /////////////////////////////////////////////////
+            struct GlyphRun
+            {
+                sf::String string;                  //!< Drawn characters
+                const sf::Font* font;               //!< Font of the glyphs
+                unsigned int characterSize;         //!< Size of the glyphs
+                sf::Uint32 style;                   //!< Style of the text
+                sf::Color fillColor;                //!< Color of the glyphs
+                sf::Color outlineColor;             //!< Color of the outline
+                float outlineThickness;             //!< Thickness of the outline
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Creates an empty recorder
+            ///
+            /// \param size: size of the imaginary target, used for the default view
+            ///
+            /////////////////////////////////////////////////
+            explicit DrawRecorder(const sf::Vector2u& size);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~DrawRecorder();
+
+            /////////////////////////////////////////////////
+            /// \brief Records the vertices, binding the texture if it has changed. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Records the run of glyphs, binding the glyph page if it has changed. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void drawGlyphRun(const sf::Text& text, const sf::RenderStates& states) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Records the change of the view. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual void setView(const sf::View& view) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the last recorded view. Inherited from DrawSink
+            ///
+            /////////////////////////////////////////////////
+            virtual const sf::View& getView() const override;
+
+            using DrawSink::drawVertices;
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all commands and restores the default view. Memory is kept for the next frame
+            ///
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the recorded commands
+            ///
+            /// \return The commands in the order they have been made
+            ///
+            /////////////////////////////////////////////////
+            const std::vector <Command>& getCommands() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the vertices of all commands
+            ///
+            /// \return The vertices
+            ///
+            /////////////////////////////////////////////////
+            const std::vector <sf::Vertex>& getVertices() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the recorded runs of glyphs
+            ///
+            /// \return The runs
+            ///
+            /////////////////////////////////////////////////
+            const std::vector <GlyphRun>& getGlyphRuns() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Counts the commands of the kind
+            ///
+            /// \param type: kind of commands
+            ///
+            /// \return Number of the commands, vertices and glyph runs are draw calls
+            ///
+            /////////////////////////////////////////////////
+            size_t getCommandCount(const CommandType type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of drawn vertices, glyphs not included
+            ///
+            /// \return Number of vertices
+            ///
+            /////////////////////////////////////////////////
+            size_t getVertexCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Calculates the hash of the commands. Textures and fonts are hashed by their sizes
+            /// instead of addresses, so the same interface gives the same hash in every run
+            ///
+            /// \return The hash
+            ///
+            /////////////////////////////////////////////////
+            sf::Uint64 getHash() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the first command that differs from the command of the other recorder
+            ///
+            /// \param other: the recorder to compare with
+            ///
+            /// \return Index of the command, the number of commands if the lists are the same
+            ///
+            /////////////////////////////////////////////////
+            size_t findFirstDifference(const DrawRecorder& other) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the commands to another sink, e.g. draws them on a window
+            ///
+            /// \param sink: the sink to send to
+            ///
+            /////////////////////////////////////////////////
+            void replay(DrawSink& sink) const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Adds the command hash to the hash
+            ///
+            /// \param index: index of the command
+            /// \param hash: hash of the previous commands
+            ///
+            /// \return The hash
+            ///
+            /////////////////////////////////////////////////
+            sf::Uint64 hashCommand(const size_t index, sf::Uint64 hash) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Records a bind if the texture or the glyph page differs from the current one
+            ///
+            /// \param texture: the texture or the font of the next primitive
+            /// \param page: size of characters for fonts, 0 for textures
+            ///
+            /////////////////////////////////////////////////
+            void bindTexture(const void* texture, const unsigned int page);
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::View m_defaultView;                 //!< The view the recording starts with
+            sf::View m_view;                        //!< The current view
+            std::vector <Command> m_commands;       //!< Recorded commands
+            std::vector <sf::Vertex> m_vertices;    //!< Vertices of all commands
+            std::vector <GlyphRun> m_glyphRuns;     //!< Runs of glyphs of all commands
+            std::vector <sf::View> m_views;         //!< Views set by the commands
+            const void* m_boundTexture;             //!< The texture or the font used by the last primitive
+            unsigned int m_boundPage;               //!< Size of characters if a font is bound
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Gives events and the mouse position to WidgetPool and EventLoop.
+    /// Allows to feed them with synthetic or recorded input instead of a window
+    ///
+    /////////////////////////////////////////////////
+    class InputSource
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~InputSource();
+
+            /////////////////////////////////////////////////
+            /// \brief Takes the next event if there is one
+            ///
+            /// \param event: the event to fill
+            ///
+            /// \return 'false' if there are no events now
+            ///
+            /////////////////////////////////////////////////
+            virtual bool pollEvent(sf::Event& event) = 0;
+
+            /////////////////////////////////////////////////
+            /// \brief Waits for the next event
+            ///
+            /// \param event: the event to fill
+            ///
+            /// \return 'false' if no events can come anymore
+            ///
+            /////////////////////////////////////////////////
+            virtual bool waitEvent(sf::Event& event) = 0;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the position of the mouse used for events without coordinates
+            ///
+            /// \return The position in pixels relative to the window
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Vector2i getMousePosition() const = 0;
+
+        protected:
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the data of the event in recordings: the fields used by the type,
+            /// 4 bytes for each number and 1 byte for key modifiers
+            ///
+            /// \param type: type of the event
+            ///
+            /// \return Size in bytes, 0 if the type has no data
+            ///
+            /////////////////////////////////////////////////
+            static size_t getEventDataSize(const sf::Event::EventType type);
+
+            /////////////////////////////////////////////////
+            /// \brief Appends the fields used by the type of the event in little-endian order,
+            /// so recordings do not depend on the platform and the layout of sf::Event
+            ///
+            /// \param data: where to append the fields
+            /// \param event: the event to write
+            ///
+            /////////////////////////////////////////////////
+            static void writeEventData(std::vector <char>& data, const sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// \brief Reads the fields used by the type of the event, which must be set already
+            ///
+            /// \param data: pointer to getEventDataSize() bytes written by writeEventData()
+            /// \param event: the event to fill
+            ///
+            /////////////////////////////////////////////////
+            static void readEventData(const char* data, sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// \brief Appends a number as 4 bytes in little-endian order
+            ///
+            /// \param data: where to append the number
+            /// \param value: the number
+            ///
+            /////////////////////////////////////////////////
+            static void writeInteger(std::vector <char>& data, const sf::Uint32 value);
+
+            /////////////////////////////////////////////////
+            /// \brief Reads a number written by writeInteger()
+            ///
+            /// \param data: pointer to 4 bytes
+            ///
+            /// \return The number
+            ///
+            /////////////////////////////////////////////////
+            static sf::Uint32 readInteger(const char* data);
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Takes events and the mouse position from a window
+    ///
+    /////////////////////////////////////////////////
+    class WindowInputSource : public InputSource
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Creates a source reading the window
+            ///
+            /// \param window: the window, must live longer than the source
+            ///
+            /////////////////////////////////////////////////
+            explicit WindowInputSource(sf::Window& window);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~WindowInputSource();
+
+            /////////////////////////////////////////////////
+            /// \brief Takes the next event of the window. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool pollEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Waits for an event of the window. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool waitEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the real mouse position relative to the window. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Vector2i getMousePosition() const override;
+
+        private:
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::Window& m_window;       //!< The window to read
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Passes events of another source through and writes them with their times to a compact binary file.
+    /// The ends of frames are kept, so a replay processes the same events together
+    ///
+    /////////////////////////////////////////////////
+    class InputRecorder : public InputSource
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Signature at the beginning of the file: "SGIR"
+            ///
+            /////////////////////////////////////////////////
+            static constexpr sf::Uint32 Magic = 0x52494753;
+
+            /////////////////////////////////////////////////
+            /// \brief Version of the format. Recordings of other versions are rejected
+            ///
+            /////////////////////////////////////////////////
+            static constexpr sf::Uint32 Version = 2;
+
+            /////////////////////////////////////////////////
+            /// \brief Type written instead of an event type when a frame has taken all events
+            ///
+            /////////////////////////////////////////////////
+            static constexpr sf::Uint8 FrameEnd = 0xFF;
+
+            /////////////////////////////////////////////////
+            /// \brief Starts recording. Time is counted from the creation
+            ///
+            /// \param source: the source of events, must live longer than the recorder
+            ///
+            /////////////////////////////////////////////////
+            explicit InputRecorder(InputSource& source);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~InputRecorder();
+
+            /////////////////////////////////////////////////
+            /// \brief Takes the next event of the source and records it. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool pollEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Waits for an event of the source and records it. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool waitEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the mouse position of the source. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Vector2i getMousePosition() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Writes the recording to the file
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the recording has been written, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool saveToFile(const std::string& fileName) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of recorded events
+            ///
+            /// \return Number of events
+            ///
+            /////////////////////////////////////////////////
+            size_t getEventCount() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Writes the time since the previous entry, the type and the data of the event
+            ///
+            /// \param event: the event to record
+            ///
+            /////////////////////////////////////////////////
+            void record(const sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// \brief Writes the time since the previous entry as 7-bit groups, small gaps take one byte
+            ///
+            /////////////////////////////////////////////////
+            void writeTime();
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            InputSource& m_source;          //!< The recorded source
+            std::vector <char> m_data;      //!< The whole recording
+            sf::Clock m_clock;              //!< Time since the recording has started
+            sf::Time m_lastTime;            //!< Time of the previous entry
+            size_t m_eventCount;            //!< Number of recorded events
+            bool m_isFrameOpen;             //!< Have events been taken since the last end of frame?
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Gives events of a file written by InputRecorder, at the recorded pace or as fast as they are taken
+    ///
+    /////////////////////////////////////////////////
+    class InputReplayer : public InputSource
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief How fast events are given
+            ///
+            /////////////////////////////////////////////////
+            enum class Speed
+            {
+                Recorded,   //!< An event is given when as much time has passed as in the recording
+                Maximum     //!< Events are given at once, only the ends of frames are kept
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Creates an empty replayer
+            ///
+            /// \param speed: how fast events are given
+            ///
+            /////////////////////////////////////////////////
+            explicit InputReplayer(const Speed speed = Speed::Recorded);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~InputReplayer();
+
+            /////////////////////////////////////////////////
+            /// \brief Loads the recording and starts the replay from the beginning
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'false' if the file cannot be read or is not a recording of this version
+            ///
+            /////////////////////////////////////////////////
+            bool loadFromFile(const std::string& fileName);
+
+            /////////////////////////////////////////////////
+            /// \brief Starts the replay from the beginning
+            ///
+            /////////////////////////////////////////////////
+            void restart();
+
+            /////////////////////////////////////////////////
+            /// \brief Sets how fast events are given
+            ///
+            /// \param speed: the new speed
+            ///
+            /////////////////////////////////////////////////
+            void setSpeed(const Speed speed);
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if all events have been given
+            ///
+            /// \return 'true' if the replay has ended
+            ///
+            /////////////////////////////////////////////////
+            bool isFinished() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of loaded events
+            ///
+            /// \return Number of events
+            ///
+            /////////////////////////////////////////////////
+            size_t getEventCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gives the next event if its time has come. Stops once at every end of frame. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool pollEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Sleeps until the time of the next event and gives it. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual bool waitEvent(sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the mouse position of the last given mouse event. Inherited from InputSource
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Vector2i getMousePosition() const override;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief A recorded event or the end of a frame
+            ///
+            /////////////////////////////////////////////////
+            struct Entry
+            {
+                sf::Time time;          //!< Time since the recording has started
+                bool isFrameEnd;        //!< Is this the end of a frame instead of an event?
+                sf::Event event;        //!< The event
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Gives the next entry and remembers the mouse position if it is a mouse event
+            ///
+            /// \param event: the event to fill
+            ///
+            /////////////////////////////////////////////////
+            void takeEvent(sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::vector <Entry> m_entries;          //!< Loaded events and ends of frames
+            size_t m_nextEntry;                     //!< The entry to give next
+            Speed m_speed;                          //!< How fast events are given
+            sf::Clock m_clock;                      //!< Time since the replay has started
+            sf::Vector2i m_initialMousePosition;    //!< Mouse position when the recording has started
+            sf::Vector2i m_mousePosition;           //!< Mouse position of the last given mouse event
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Counts durations in buckets growing by a ninth, so percentiles are found without keeping the samples.
+    /// A percentile is the upper border of its bucket, it is at most 9% larger than the real value
+    ///
+    /////////////////////////////////////////////////
+    class LatencyHistogram
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty histogram
+            ///
+            /////////////////////////////////////////////////
+            LatencyHistogram();
+
+            /////////////////////////////////////////////////
+            /// \brief Adds a sample
+            ///
+            /// \param latency: the duration, negative ones are counted as zero
+            ///
+            /////////////////////////////////////////////////
+            void add(const sf::Time latency);
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all samples
+            ///
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of samples
+            ///
+            /// \return Number of samples
+            ///
+            /////////////////////////////////////////////////
+            size_t getCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the duration the part of the samples does not exceed
+            ///
+            /// \param percentile: the part in percents, e.g. 99 for p99
+            ///
+            /// \return The duration, zero if there are no samples
+            ///
+            /////////////////////////////////////////////////
+            sf::Time getPercentile(const float percentile) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the largest sample
+            ///
+            /// \return The exact duration
+            ///
+            /////////////////////////////////////////////////
+            sf::Time getMaximum() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Buckets per doubling of the duration
+            ///
+            /////////////////////////////////////////////////
+            static constexpr size_t BucketsPerOctave = 8;
+
+            /////////////////////////////////////////////////
+            /// \brief Number of buckets, enough for durations up to several hours in microseconds
+            ///
+            /////////////////////////////////////////////////
+            static constexpr size_t BucketCount = BucketsPerOctave * 35;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::vector <size_t> m_buckets;     //!< Number of samples in each bucket
+            size_t m_count;                     //!< Number of samples
+            sf::Time m_maximum;                 //!< The largest sample
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Bytes used by widgets, by their types and by their components.
+    /// The component "object" is the widgets themselves, the others are what their members have allocated, estimated by capacities
+    ///
+    /////////////////////////////////////////////////
+    class MemoryReport
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty report
+            ///
+            /////////////////////////////////////////////////
+            MemoryReport();
+
+            /////////////////////////////////////////////////
+            /// \brief Counts a widget and adds its size as the component "object"
+            ///
+            /// \param type: type of the widget
+            /// \param size: size of the widget object in bytes
+            ///
+            /////////////////////////////////////////////////
+            void addWidget(const std::string& type, const size_t size);
+
+            /////////////////////////////////////////////////
+            /// \brief Adds bytes to the component of the type
+            ///
+            /// \param type: type of the widget
+            /// \param component: name of the component
+            /// \param size: number of bytes
+            ///
+            /////////////////////////////////////////////////
+            void addComponent(const std::string& type, const std::string& component, const size_t size);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of widgets of all types
+            ///
+            /// \return Number of widgets
+            ///
+            /////////////////////////////////////////////////
+            size_t getWidgetCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of widgets of the type
+            ///
+            /// \param type: type of the widgets
+            ///
+            /// \return Number of widgets
+            ///
+            /////////////////////////////////////////////////
+            size_t getWidgetCount(const std::string& type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets bytes used by all widgets
+            ///
+            /// \return Number of bytes
+            ///
+            /////////////////////////////////////////////////
+            size_t getByteCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets bytes used by widgets of the type
+            ///
+            /// \param type: type of the widgets
+            ///
+            /// \return Number of bytes
+            ///
+            /////////////////////////////////////////////////
+            size_t getByteCount(const std::string& type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets bytes used by the component of widgets of the type
+            ///
+            /// \param type: type of the widgets
+            /// \param component: name of the component
+            ///
+            /// \return Number of bytes
+            ///
+            /////////////////////////////////////////////////
+            size_t getByteCount(const std::string& type, const std::string& component) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the reported widget types
+            ///
+            /// \return Types in alphabetical order
+            ///
+            /////////////////////////////////////////////////
+            std::vector <std::string> getTypes() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the reported components of the type
+            ///
+            /// \param type: type of the widgets
+            ///
+            /// \return Components in alphabetical order
+            ///
+            /////////////////////////////////////////////////
+            std::vector <std::string> getComponents(const std::string& type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Writes the counts and the bytes of every type and component as a table
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the report has been written, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool saveToFile(const std::string& fileName) const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Usage of one widget type
+            ///
+            /////////////////////////////////////////////////
+            struct TypeUsage
+            {
+                size_t widgetCount;                                     //!< Number of widgets
+                std::map <std::string, size_t, std::less<>> components; //!< Bytes by components
+            };
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::map <std::string, TypeUsage, std::less<>> m_types;    //!< Usage by widget types
+    };
+
+    class Widget;
+
+    /////////////////////////////////////////////////
+    /// \brief Contains possible states of the widget
+    ///
+    /////////////////////////////////////////////////
+    enum class WidgetState
+    {
+        Idle,
+        Hovered,
+        Pressed,
+        Hidden
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Identifier of a widget that can be passed to other threads. Identifiers are never reused,
+    /// so updates of destroyed widgets are simply dropped
+    ///
+    /////////////////////////////////////////////////
+    using WidgetHandle = sf::Uint64;
+
+    /////////////////////////////////////////////////
+    /// \brief Types of events a widget handles, one bit for each sf::Event::EventType
+    ///
+    /////////////////////////////////////////////////
+    using EventMask = std::bitset <sf::Event::Count>;
+
+    /////////////////////////////////////////////////
+    /// \brief Properties of widgets that can be changed from other threads
+    ///
+    /////////////////////////////////////////////////
+    enum class WidgetProperty
+    {
+        String,
+        Checked,
+        Position,
+        Size,
+        Hidden
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A change of a widget posted from another thread
+    ///
+    /////////////////////////////////////////////////
+    struct WidgetUpdate
+    {
+        WidgetHandle widget;        //!< The widget to change
+        WidgetProperty property;    //!< What to change
+        sf::String string;          //!< New string
+        sf::Vector2f vector;        //!< New position or size
+        bool flag;                  //!< Is checked or is hidden
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A lock-free queue of updates. Any number of threads can push, only one thread can pop
+    ///
+    /////////////////////////////////////////////////
+    class WidgetUpdateQueue
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty queue
+            ///
+            /////////////////////////////////////////////////
+            WidgetUpdateQueue();
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because nodes are owned by the queue
+            ///
+            /////////////////////////////////////////////////
+            WidgetUpdateQueue(WidgetUpdateQueue const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because nodes are owned by the queue
+            ///
+            /////////////////////////////////////////////////
+            void operator=(WidgetUpdateQueue const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Destructor to delete the updates left
+            ///
+            /////////////////////////////////////////////////
+            virtual ~WidgetUpdateQueue();
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the update to the end. Can be called from any thread
+            ///
+            /// \param update: the update to add
+            ///
+            /////////////////////////////////////////////////
+            void push(WidgetUpdate&& update);
+
+            /////////////////////////////////////////////////
+            /// \brief Takes the first update. Must be called from one thread only
+            ///
+            /// \param update: where to move the update
+            ///
+            /// \return 'false' if the queue is empty or the next update is still being pushed, else 'true'
+            ///
+            /////////////////////////////////////////////////
+            bool pop(WidgetUpdate& update);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief An element of the linked list
+            ///
+            /////////////////////////////////////////////////
+            struct Node
+            {
+                std::atomic <Node*> next;
+                WidgetUpdate update;
+            };
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::atomic <Node*> m_head;     //!< The last pushed node, exchanged by producers
+            Node* m_tail;                   //!< The node before the first update, owned by the consumer
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Base of values that widgets can be bound to. Changes are delivered to widgets once per frame
+    /// by WidgetPool::applyBindings(), no matter how many times the value has been written
+    ///
+    /////////////////////////////////////////////////
+    class ObservableBase
+    {
+        friend class WidgetPool;
+        friend class Widget;
+
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /////////////////////////////////////////////////
+            ObservableBase();
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because widgets are bound through pointers
+            ///
+            /////////////////////////////////////////////////
+            ObservableBase(ObservableBase const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because widgets are bound through pointers
+            ///
+            /////////////////////////////////////////////////
+            void operator=(ObservableBase const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Destructor to unbind widgets
+            ///
+            /////////////////////////////////////////////////
+            virtual ~ObservableBase();
+
+        protected:
+            /////////////////////////////////////////////////
+            /// \brief Schedules notification of bound widgets on the next WidgetPool::applyBindings()
+            ///
+            /////////////////////////////////////////////////
+            void markChanged();
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief A widget bound to the value and the function applying the value to it
+            ///
+            /////////////////////////////////////////////////
+            struct Subscriber
+            {
+                Widget* widget;
+                std::function <void()> update;
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Applies the value to all bound widgets. Widgets bound during the notification get the value next time
+            ///
+            /////////////////////////////////////////////////
+            void notify();
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all bindings of the widget. Called by the widget on its destruction,
+            /// which may happen in a binding function, so the removal is delayed until the notification ends
+            ///
+            /// \param widget: the widget to unbind
+            ///
+            /////////////////////////////////////////////////
+            void removeSubscriber(const Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::vector <Subscriber> m_subscribers;     //!< Bound widgets, null if removed during the notification
+            bool m_isChanged;                           //!< Is the value waiting for notification?
+            bool m_isNotifying;                         //!< Are bound widgets being updated?
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A value that widgets can be bound to. Must be used on the thread drawing widgets only
+    ///
+    /////////////////////////////////////////////////
+    template <typename T>
+    class Observable : public ObservableBase
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /// \param value: the initial value
+            ///
+            /////////////////////////////////////////////////
+            Observable(const T& value = T()) : m_value(value)
+            {
+                //ctor
+            }
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the value. Bound widgets see only the last value written before the next frame
+            ///
+            /// \param value: new value
+            ///
+            /////////////////////////////////////////////////
+            void set(const T& value)
+            {
+                m_value = value;
+                markChanged();
+            }
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current value
+            ///
+            /// \return The value
+            ///
+            /////////////////////////////////////////////////
+            const T& get() const
+            {
+                return m_value;
+            }
+
+        private:
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            T m_value;  //!< The current value
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A singleton that contains all created widgets
+    ///
+    /////////////////////////////////////////////////
+    class WidgetPool : public sf::Drawable
+    {
+        friend class Widget;
+        friend class EventLoop;
+        friend class ObservableBase;
+
+        public:
+            /////////////////////////////////////////////////
+            /// \brief A destructor to clean up
+            ///
+            /////////////////////////////////////////////////
+            virtual ~WidgetPool();
+
+            /////////////////////////////////////////////////
+            /// \brief Prohibition of creation another instance. It is not acceptable by the singleton pattern
+            ///
+            /////////////////////////////////////////////////
+            WidgetPool(WidgetPool const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Prohibition of copying. It is not acceptable by the singleton pattern
+            ///
+            /////////////////////////////////////////////////
+            void operator=(WidgetPool const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets or creates an instance of the singleton
+            ///
+            /// \return Returns the instance
+            ///
+            /////////////////////////////////////////////////
+            static WidgetPool& getInstance();
+
+            /////////////////////////////////////////////////
+            /// \brief Binds widgets to the window. Multiple windows are not supported
+            ///
+            /////////////////////////////////////////////////
+            void initialize(const sf::RenderWindow* window);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets where the mouse position is taken for events without coordinates, e.g. a replayed recording
+            ///
+            /// \param source: the source, 'nullptr' to ask the real mouse. Must live while it is set
+            ///
+            /////////////////////////////////////////////////
+            void setInputSource(const InputSource* source);
+
+            /////////////////////////////////////////////////
+            /// \brief Processes user actions on widgets. Mouse events are processed at their own coordinates
+            ///
+            /////////////////////////////////////////////////
+            void processEvent(const sf::Event event);
+
+            /////////////////////////////////////////////////
+            /// \brief Processes all events of the frame at once. Consecutive mouse moves are replaced with the last one,
+            /// the order of other events is kept. Widgets are searched under the mouse once per position
+            ///
+            /// \param events: events in the order they have been polled
+            ///
+            /// \return Number of mouse moves skipped
+            ///
+            /////////////////////////////////////////////////
+            size_t processEvents(const std::vector <sf::Event>& events);
+
+            /////////////////////////////////////////////////
+            /// \brief Forces appearance of all widgets to be updated on the current frame. Must be used if any style is changed
+            ///
+            /////////////////////////////////////////////////
+            void forceThemeUpdate() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Lays out all widgets and writes the result to the file. Supposed to be made at the build time
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the snapshot has been written, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool saveLayoutSnapshot(const std::string& fileName) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Restores the layout of widgets saved by saveLayoutSnapshot(). Widgets must be created in the same order.
+            /// A widget is laid out as usual if its font, size, string or any other setting differs from the saved one
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return Number of widgets which layout has been restored
+            ///
+            /////////////////////////////////////////////////
+            size_t loadLayoutSnapshot(const std::string& fileName);
+
+            /////////////////////////////////////////////////
+            /// \brief Rasterizes glyphs declared in text settings of all themes used by widgets.
+            /// Supposed to be called at startup or on idle frames until it returns 'true'
+            ///
+            /// \param timeLimit: when to stop and continue on the next call, zero means no limit
+            ///
+            /// \return 'true' if all declared glyphs are ready, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool prewarmGlyphs(const sf::Time timeLimit = sf::Time::Zero) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Advances color transitions of widgets which themes have a transition duration.
+            /// Only the widgets being animated are updated
+            ///
+            /// \param elapsedTime: time since the previous call
+            ///
+            /////////////////////////////////////////////////
+            void updateAnimations(const sf::Time elapsedTime);
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if any transition is in progress. If not, the window does not need redrawing for animations
+            ///
+            /// \return 'true' if any widget is being animated, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool hasActiveAnimations() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if anything has changed since the widgets were drawn last time: state, text, size, theme,
+            /// a widget shown or hidden, or a transition in progress. Reset by drawing the pool
+            ///
+            /// \return 'true' if the window should be drawn again, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool needsRedraw() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Makes needsRedraw() return 'true' until the next drawing. Must be used if anything drawn besides widgets changes
+            ///
+            /////////////////////////////////////////////////
+            void requestRedraw();
+
+            /////////////////////////////////////////////////
+            /// \brief Draws all widgets into the sink instead of a window, e.g. into DrawRecorder to check them without OpenGL
+            ///
+            /// \param sink: the sink to draw into
+            /// \param states: states applied to all widgets
+            /// \param isFrameShown: does the sink draw the frame shown on the window? Only then needsRedraw() is reset
+            /// and the changes are measured by markFrameSubmitted(), so recording a frame does not hide changes from the window
+            ///
+            /////////////////////////////////////////////////
+            void render(DrawSink& sink, const sf::RenderStates& states = sf::RenderStates::Default, const bool isFrameShown = false) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Starts or stops measuring the time from events to the frames showing their effects.
+            /// An event is stamped when EventLoop takes it from the source, or when it is processed without the loop.
+            /// The widgets it invalidates, also through bindings applied on the same frame, are remembered,
+            /// and the latency is taken when the next drawn frame is submitted by markFrameSubmitted()
+            ///
+            /// \param isEnabled: should latencies be measured?
+            ///
+            /////////////////////////////////////////////////
+            void setLatencyTracking(const bool isEnabled);
+
+            /////////////////////////////////////////////////
+            /// \brief Tells that the drawn frame has been shown. Must be called after window.display() while latencies are measured
+            ///
+            /////////////////////////////////////////////////
+            void markFrameSubmitted();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets latencies of events of the type that have changed anything visible
+            ///
+            /// \param type: type of the events
+            ///
+            /// \return The histogram
+            ///
+            /////////////////////////////////////////////////
+            const LatencyHistogram& getEventLatency(const sf::Event::EventType type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets latencies of events that have changed the widget
+            ///
+            /// \param widget: handle of the widget
+            ///
+            /// \return 'nullptr' if no event has changed the widget or it has been destroyed, else the histogram
+            ///
+            /////////////////////////////////////////////////
+            const LatencyHistogram* getWidgetLatency(const WidgetHandle widget) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all measured latencies
+            ///
+            /////////////////////////////////////////////////
+            void clearLatencies();
+
+            /////////////////////////////////////////////////
+            /// \brief Writes p50, p95, p99 and the maximum latency of every event type and widget as a table
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the report has been written, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool saveLatencyReport(const std::string& fileName) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Measures the memory used by the widgets. Besides their own components, every widget has the component "pool":
+            /// its entries in the lists and the handle map of the handler
+            ///
+            /// \return The report by widget types and components
+            ///
+            /////////////////////////////////////////////////
+            MemoryReport getMemoryReport() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the cache of measured strings shared by all widgets
+            ///
+            /// \return The cache
+            ///
+            /////////////////////////////////////////////////
+            ShapedRunCache& getShapedRunCache();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the arena for temporary data of layouts. Its allocation count shows if layouts still use the heap
+            ///
+            /// \return The arena
+            ///
+            /////////////////////////////////////////////////
+            ScratchArena& getScratchArena();
+
+            /////////////////////////////////////////////////
+            /// \brief Posts a new string of a text-based widget. Can be called from any thread
+            ///
+            /// \param widget: handle of the widget
+            /// \param string: new string
+            ///
+            /////////////////////////////////////////////////
+            void postString(const WidgetHandle widget, const sf::String& string);
+
+            /////////////////////////////////////////////////
+            /// \brief Posts a new state of a check box. Can be called from any thread
+            ///
+            /// \param widget: handle of the check box
+            /// \param isChecked: new state of the checkmark
+            ///
+            /////////////////////////////////////////////////
+            void postChecked(const WidgetHandle widget, const bool isChecked);
+
+            /////////////////////////////////////////////////
+            /// \brief Posts a new position of a widget. Can be called from any thread
+            ///
+            /// \param widget: handle of the widget
+            /// \param position: new position
+            ///
+            /////////////////////////////////////////////////
+            void postPosition(const WidgetHandle widget, const sf::Vector2f& position);
+
+            /////////////////////////////////////////////////
+            /// \brief Posts a new size of a widget. Can be called from any thread
+            ///
+            /// \param widget: handle of the widget
+            /// \param size: new size
+            ///
+            /////////////////////////////////////////////////
+            void postSize(const WidgetHandle widget, const sf::Vector2f& size);
+
+            /////////////////////////////////////////////////
+            /// \brief Posts showing or hiding of a widget. Can be called from any thread
+            ///
+            /// \param widget: handle of the widget
+            /// \param isHidden: should the widget be hidden?
+            ///
+            /////////////////////////////////////////////////
+            void postHidden(const WidgetHandle widget, const bool isHidden);
+
+            /////////////////////////////////////////////////
+            /// \brief Applies updates posted from other threads. Only the last update of each property of a widget is applied.
+            /// Must be called on the thread drawing widgets, supposed to be called at the start of a frame
+            ///
+            /// \return Number of updates applied
+            ///
+            /////////////////////////////////////////////////
+            size_t applyPostedUpdates();
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if any update has been posted since the last applyPostedUpdates()
+            ///
+            /// \return 'true' if there are updates to apply, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool hasPostedUpdates() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Delivers changed observable values to bound widgets. Widgets are changed only if the value looks differently.
+            /// Supposed to be called once per frame before drawing
+            ///
+            /// \return Number of observables which widgets have been notified
+            ///
+            /////////////////////////////////////////////////
+            size_t applyBindings();
+
+            /////////////////////////////////////////////////
+            /// \brief Gives the focus to the widget. Keyboard events are passed only to the focused widget.
+            /// A widget is also focused when it is clicked
+            ///
+            /// \param widget: the widget to focus, 'nullptr' to remove the focus
+            ///
+            /////////////////////////////////////////////////
+            void setFocusedWidget(Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the widget receiving keyboard events
+            ///
+            /// \return 'nullptr' if nothing is focused, else the focused widget
+            ///
+            /////////////////////////////////////////////////
+            Widget* getFocusedWidget() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Moves the focus to the next focusable widget, as Tab does. Top-level widgets go in the order they are drawn,
+            /// each followed by its descendants
+            ///
+            /// \param isBackward: should the focus go to the previous widget instead, as Shift+Tab does?
+            ///
+            /////////////////////////////////////////////////
+            void focusNextWidget(const bool isBackward = false);
+
+            /////////////////////////////////////////////////
+            /// \brief Allows Tab and Shift+Tab to move the focus. Tab characters are not typed then. Enabled by default
+            ///
+            /// \param isEnabled: should Tab move the focus?
+            ///
+            /////////////////////////////////////////////////
+            void setTabNavigation(const bool isEnabled);
+
+            /////////////////////////////////////////////////
+            /// \brief Makes all mouse events go to the widget besides the hovered one, e.g. to drag something outside the widget.
+            /// A widget pressed by the left button captures the mouse until the button is released
+            ///
+            /// \param widget: the widget capturing the mouse, 'nullptr' to release it
+            ///
+            /////////////////////////////////////////////////
+            void setPointerCapture(Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the widget capturing the mouse
+            ///
+            /// \return 'nullptr' if the mouse is not captured, else the capturing widget
+            ///
+            /////////////////////////////////////////////////
+            Widget* getPointerCapture() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Constructs the object. Privateness allows to follow the singleton pattern
+            ///
+            /////////////////////////////////////////////////
+            WidgetPool();
+
+            /////////////////////////////////////////////////
+            /// \brief Finds a widget hovered by mouse
+            ///
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /// \return 'nullptr' if nothing is hovered, else the pointer to the hovered widget
+            ///
+            /////////////////////////////////////////////////
+            Widget* getActiveWidget(const sf::Vector2f& mousePosition) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the top widget under the mouse in the subtree. Subtrees not containing the point are skipped
+            ///
+            /// \param widget: root of the subtree
+            /// \param mousePosition: current mouse position in the coordinates of the widget
+            ///
+            /// \return 'nullptr' if nothing is hovered, else the pointer to the hovered widget
+            ///
+            /////////////////////////////////////////////////
+            Widget* findWidgetAt(Widget* widget, const sf::Vector2f& mousePosition) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the widget and its descendants. Hidden subtrees and subtrees outside the view are skipped
+            ///
+            /// \param widget: root of the subtree
+            /// \param sink: the sink to draw into
+            /// \param states: states with the transforms of the scrolled ancestors
+            /// \param viewBounds: the area seen through the view of the sink in the coordinates of the widget
+            ///
+            /////////////////////////////////////////////////
+            void drawSubtree(const Widget& widget, DrawSink& sink, const sf::RenderStates& states, const sf::FloatRect& viewBounds) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Converts the mouse position to the coordinates of the widget, which differ inside scrolled containers
+            ///
+            /// \param widget: the widget receiving an event
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /// \return The position for the widget, far away from everything if a container cuts it off
+            ///
+            /////////////////////////////////////////////////
+            sf::Vector2f getLocalPosition(const Widget& widget, const sf::Vector2f& mousePosition) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Lists the widget and its descendants, parents before children
+            ///
+            /// \param widget: root of the subtree
+            /// \param widgets: the list to append to
+            ///
+            /////////////////////////////////////////////////
+            void appendSubtree(Widget* widget, std::vector <Widget*>& widgets) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Passes keyboard events to the focused widget, mouse events to the active widget, the one active before
+            /// and the capturing one, and clicks to the focused widget too. Events a widget does not handle bubble up to its parents
+            ///
+            /// \param event: the event to pass
+            /// \param position: mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            void dispatchEvent(const sf::Event& event, const sf::Vector2f& position);
+
+            /////////////////////////////////////////////////
+            /// \brief Remembers the type and the arrival time of the event to be dispatched if latencies are measured
+            ///
+            /// \param event: the event to be dispatched
+            /// \param arrivalTime: when the event has been taken from its source, by the latency clock
+            ///
+            /////////////////////////////////////////////////
+            void stampEvent(const sf::Event& event, const sf::Time arrivalTime);
+
+            /////////////////////////////////////////////////
+            /// \brief Processes all events of the frame like the public overload, but the stamp of the last event is kept,
+            /// so widgets changed by bindings applied after the events are attributed to it. Used by EventLoop
+            ///
+            /// \param events: events in the order they have been polled
+            /// \param arrivalTimes: when each event has been taken from its source, 'nullptr' to stamp at dispatch
+            ///
+            /// \return Number of mouse moves skipped
+            ///
+            /////////////////////////////////////////////////
+            size_t processEvents(const std::vector <sf::Event>& events, const std::vector <sf::Time>* arrivalTimes);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the coordinates of a mouse event
+            ///
+            /// \param event: the event
+            /// \param position: the position in the world coordinates, not changed if the event has no coordinates
+            ///
+            /// \return 'true' if the event has coordinates
+            ///
+            /////////////////////////////////////////////////
+            bool getEventPosition(const sf::Event& event, sf::Vector2f& position) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the mouse position from the input source, or from the real mouse if there is no source
+            ///
+            /// \return The position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            sf::Vector2f getMousePosition() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Remembers that the event being dispatched has changed the widget. Called by Widget::invalidate()
+            ///
+            /// \param widget: the changed widget
+            ///
+            /////////////////////////////////////////////////
+            void trackInvalidation(const Widget& widget);
+
+            /////////////////////////////////////////////////
+            /// \brief An event waiting for the frame that shows its effect on the widget
+            ///
+            /////////////////////////////////////////////////
+            struct PendingLatency
+            {
+                sf::Uint64 eventNumber;         //!< Number of the event since the tracking has started
+                sf::Event::EventType type;      //!< Type of the event
+                sf::Time arrivalTime;           //!< When the event has been processed
+                WidgetHandle widget;            //!< The changed widget
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the widget to the pool
+            ///
+            /// \param widget: a widget to add
+            ///
+            /////////////////////////////////////////////////
+            void addWidget(Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// \brief Removes the widget from the pool. Called by the widget on its destruction
+            ///
+            /// \param widget: a widget to remove
+            ///
+            /////////////////////////////////////////////////
+            void removeWidget(Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the widget to the animated ones if it is not there yet
+            ///
+            /// \param widget: a widget which state has changed
+            ///
+            /////////////////////////////////////////////////
+            void startAnimation(Widget* widget);
+
+            /////////////////////////////////////////////////
+            /// \brief Puts the update to the queue and marks that there is something to apply
+            ///
+            /// \param update: the update to post
+            ///
+            /////////////////////////////////////////////////
+            void postUpdate(WidgetUpdate&& update);
+
+            /////////////////////////////////////////////////
+            /// \brief Draws all widgets on the window. Inherited from sf::Drawable
+            ///
+            /////////////////////////////////////////////////
+            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            const sf::RenderWindow* m_window;   //!< The window which widgets belong to
+            std::list <Widget*> m_widgets;      //!< The container for all created widgets
+            std::list <Widget*> m_topLevelWidgets;  //!< Widgets without parents in the order they are drawn
+            Widget* m_activeWidget;             //!< The widget that is hovered or clicked by mouse
+            Widget* m_lastHoveredWidget;        //!< The widget that was hovered on the previous mouse event
+            Widget* m_focusedWidget;            //!< The widget receiving keyboard events
+            Widget* m_pointerCapture;           //!< The widget receiving all mouse events
+            bool m_isTabNavigationEnabled;      //!< Does Tab move the focus?
+            const InputSource* m_inputSource;   //!< Where the mouse position is taken, 'nullptr' for the real mouse
+            bool m_isLatencyTracked;            //!< Are latencies measured?
+            bool m_isDispatching;               //!< Is an event or the bindings it has changed being processed now?
+            sf::Uint64 m_eventNumber;           //!< Number of the event being dispatched
+            sf::Time m_eventArrivalTime;        //!< When the event being dispatched has been taken from its source
+            sf::Event::EventType m_eventType;   //!< Type of the event being dispatched
+            sf::Clock m_latencyClock;           //!< Time the stamps are taken from
+            mutable std::vector <PendingLatency> m_pendingLatencies;            //!< Events whose effects have not been drawn yet
+            mutable std::vector <PendingLatency> m_drawnLatencies;              //!< Events whose effects wait for the frame submission
+            std::vector <LatencyHistogram> m_eventLatencies;                    //!< Latencies by event types
+            std::unordered_map <WidgetHandle, LatencyHistogram> m_widgetLatencies; //!< Latencies by living widgets
+            std::vector <Widget*> m_animatedWidgets;    //!< Widgets with transitions in progress
+            mutable bool m_needsRedraw;                 //!< Has anything changed since the last drawing?
+            mutable ShapedRunCache m_shapedRunCache;    //!< Measured strings of all widgets
+            mutable std::vector <sf::Vertex> m_batchedVertices; //!< Storage of the rectangles joined while rendering
+            ScratchArena m_scratchArena;                //!< Temporary data of layouts
+            std::unordered_map <WidgetHandle, Widget*> m_handles;   //!< Widgets by handles
+            WidgetHandle m_lastHandle;                              //!< Handle given to the last created widget
+            WidgetUpdateQueue m_postedUpdates;                      //!< Updates from other threads
+            std::atomic <bool> m_hasPostedUpdates;                  //!< Is there anything in the queue?
+            std::atomic <bool> m_isPostingUsed;                     //!< Has anything ever been posted? EventLoop cannot sleep in the window then
+            std::vector <WidgetUpdate> m_updateBatch;               //!< Updates being applied, kept to reuse the memory
+            std::unordered_map <sf::Uint64, size_t> m_lastUpdates;  //!< The last update of each property of each widget in the batch
+            std::vector <ObservableBase*> m_changedObservables;     //!< Observables waiting for applyBindings()
+            std::vector <ObservableBase*> m_notifiedObservables;    //!< Observables being notified, kept to reuse the memory
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Runs frames of the application only when they are needed. Sleeps while nothing changes,
+    /// wakes up on events, timers and transitions. Widgets of WidgetPool are processed automatically
+    ///
+    /////////////////////////////////////////////////
+    class EventLoop
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /// \param window: the window to take events from, must be the one WidgetPool is initialized with
+            ///
+            /////////////////////////////////////////////////
+            EventLoop(sf::RenderWindow& window);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~EventLoop();
+
+            /////////////////////////////////////////////////
+            /// \brief Takes events from the source instead of the window, e.g. from InputRecorder or InputReplayer.
+            /// WidgetPool takes the mouse position from the same source
+            ///
+            /// \param source: the source, 'nullptr' to read the window again. Must live while it is set
+            ///
+            /////////////////////////////////////////////////
+            void setInputSource(InputSource* source);
+
+            /////////////////////////////////////////////////
+            /// \brief Waits for the next frame. Blocks until an event comes or a timer is due, unless something is
+            /// waiting to be drawn. Then passes events to widgets, advances transitions and calls due timers
+            ///
+            /// \return 'true' if the window must be drawn, 'false' if nothing visible has changed
+            ///
+            /////////////////////////////////////////////////
+            bool waitFrame();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets events received by the last waitFrame(), they have already been processed by widgets
+            ///
+            /// \return Events in the order they have been polled
+            ///
+            /////////////////////////////////////////////////
+            const std::vector <sf::Event>& getEvents() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds a function to be called by waitFrame() after the interval
+            ///
+            /// \param interval: time until the call and between the calls
+            /// \param action: a function to call
+            /// \param isRepeated: should the function be called again after the interval?
+            ///
+            /// \return Identifier of the timer
+            ///
+            /////////////////////////////////////////////////
+            size_t addTimer(const sf::Time interval, const std::function <void()> action, const bool isRepeated = true);
+
+            /////////////////////////////////////////////////
+            /// \brief Stops the timer. Unknown identifiers are ignored
+            ///
+            /// \param timerId: identifier returned by addTimer()
+            ///
+            /////////////////////////////////////////////////
+            void removeTimer(const size_t timerId);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of frames that had to be drawn
+            ///
+            /// \return Number of frames waitFrame() returned 'true' for
+            ///
+            /////////////////////////////////////////////////
+            size_t getActiveFrameCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of frames that changed nothing visible, for example, the mouse moved over the background
+            ///
+            /// \return Number of frames waitFrame() returned 'false' for
+            ///
+            /////////////////////////////////////////////////
+            size_t getIdleFrameCount() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief A function called after an interval
+            ///
+            /////////////////////////////////////////////////
+            struct Timer
+            {
+                size_t id;                      //!< Identifier returned to the user
+                sf::Time interval;              //!< Time between the calls
+                sf::Time dueTime;               //!< Time of the next call since the loop has been created
+                std::function <void()> action;  //!< Function to call
+                bool isRepeated;                //!< Is the timer kept after the call?
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Takes all events from the window without waiting
+            ///
+            /// \return 'true' if any event has been received, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool pollEvents();
+
+            /////////////////////////////////////////////////
+            /// \brief Blocks until an event comes, the nearest timer is due, or the window is closed
+            ///
+            /////////////////////////////////////////////////
+            void waitEvents();
+
+            /////////////////////////////////////////////////
+            /// \brief Calls functions of due timers and removes the ones that are not repeated
+            ///
+            /////////////////////////////////////////////////
+            void runDueTimers();
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::RenderWindow& m_window;         //!< The window the loop runs for
+            WindowInputSource m_windowInput;    //!< Events of the window
+            InputSource* m_input;               //!< The source events are taken from, the window by default
+            std::vector <sf::Event> m_events;   //!< Events of the last frame
+            std::vector <sf::Time> m_arrivalTimes;  //!< When each event of the last frame has been taken, by the latency clock
+            std::vector <Timer> m_timers;       //!< Timers in the order they were added
+            size_t m_nextTimerId;               //!< Identifier for the next timer
+            sf::Clock m_clock;                  //!< Time since the loop has been created
+            sf::Time m_lastFrameTime;           //!< Time of the previous frame, transitions advance by the difference
+            size_t m_activeFrameCount;          //!< Frames that had to be drawn
+            size_t m_idleFrameCount;            //!< Frames that changed nothing visible
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Base class for all widgets
+    ///
+    /////////////////////////////////////////////////
+    class Widget : public sf::Drawable
+    {
+        friend class WidgetPool;
+        friend class ObservableBase;
+
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            Widget();
+
+            /////////////////////////////////////////////////
+            /// \brief All widgets are constructed using WidgetPool only through the default constructor
+            ///
+            /////////////////////////////////////////////////
+            Widget(Widget const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief All widgets are constructed using WidgetPool only through the default constructor
+            ///
+            /////////////////////////////////////////////////
+            void operator=(Widget const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~Widget() = 0;
+
+            /////////////////////////////////////////////////
+            /// \brief Changes position of the widget
+            ///
+            /// \param position: new position of the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void setPosition(const sf::Vector2f& position);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes size of the widget
+            ///
+            /// \param size: new size of the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void setSize(const sf::Vector2f& size);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes theme of the widget
+            ///
+            /// \param theme: new theme of the widget
+            ///
+            /////////////////////////////////////////////////
+            void setTheme(const Theme& theme);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes background texture rectangle
+            ///
+            /// \param rectangle: new rectangle for the texture
+            ///
+            /////////////////////////////////////////////////
+            void setBackgroundTextureRect(const sf::IntRect& rectangle);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the function to be called after the widget is released by the left mouse button
+            ///
+            /// \param doActionOnButtonRelease: a function to call
+            ///
+            /////////////////////////////////////////////////
+            void setAction(const sf::Event::EventType eventType, const std::function <void()> doAction);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current position of the widget
+            ///
+            /// \return Current position of the widget
+            ///
+            /////////////////////////////////////////////////
+            sf::Vector2f getPosition() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current size of the widget
+            ///
+            /// \return Current size of the widget
+            ///
+            /////////////////////////////////////////////////
+            sf::Vector2f getSize() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current theme of the widget
+            ///
+            /// \return Current theme of the widget
+            ///
+            /////////////////////////////////////////////////
+            const Theme& getTheme() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current texture rectangle of the widget
+            ///
+            /// \return Current texture rectangle of the widget
+            ///
+            /////////////////////////////////////////////////
+            sf::IntRect getBackgroundTextureRect() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the local bounds of the rectangle of the widget
+            ///
+            /// \return Current local bounds of the widget
+            /////////////////////////////////////////////////
+            sf::FloatRect getLocalBounds() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the global bounds of the rectangle of the widget
+            ///
+            /// \return Current global bounds of the widget
+            ///
+            /////////////////////////////////////////////////
+            sf::FloatRect getGlobalBounds() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Allows the widget to be drawn
+            ///
+            /////////////////////////////////////////////////
+            void show();
+
+            /////////////////////////////////////////////////
+            /// \brief Prohibits the widget to be drawn
+            ///
+            /////////////////////////////////////////////////
+            void hide();
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the widget is hidden
+            ///
+            /// \return 'true' if the widget is hidden, 'false' if it is shown
+            ///
+            /////////////////////////////////////////////////
+            bool isHidden() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the identifier of the widget to post updates from other threads
+            ///
+            /// \return Handle of the widget
+            ///
+            /////////////////////////////////////////////////
+            WidgetHandle getHandle() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Hides or shows the widget when the value changes
+            ///
+            /// \param isHidden: the value to follow, must outlive the widget or be destroyed before it
+            ///
+            /////////////////////////////////////////////////
+            void bindHidden(Observable <bool>& isHidden);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the types of events the widget handles. WidgetPool does not pass other events to it
+            ///
+            /// \return The mask of event types
+            ///
+            /////////////////////////////////////////////////
+            const EventMask& getEventMask() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the widget can be focused by Tab: it is shown and handles keyboard events
+            ///
+            /// \return 'true' if Tab stops at the widget
+            ///
+            /////////////////////////////////////////////////
+            bool isFocusable() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the widget receives keyboard events
+            ///
+            /// \return 'true' if the widget is focused
+            ///
+            /////////////////////////////////////////////////
+            bool isFocused() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the widget a child of this one. Children are drawn over the parent, hidden with it
+            /// and found by the mouse only inside the bounds of the parent's subtree. Positions stay in the world coordinates
+            ///
+            /// \param child: the widget to add, removed from its previous parent. Ignored if it is this widget or its ancestor
+            ///
+            /////////////////////////////////////////////////
+            void addChild(Widget& child);
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the child a top-level widget again, drawn over the other ones
+            ///
+            /// \param child: a child of this widget
+            ///
+            /////////////////////////////////////////////////
+            void removeChild(Widget& child);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the parent of the widget
+            ///
+            /// \return 'nullptr' if the widget is top-level, else the parent
+            ///
+            /////////////////////////////////////////////////
+            Widget* getParent() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the children of the widget in the order they are drawn
+            ///
+            /// \return The children
+            ///
+            /////////////////////////////////////////////////
+            const std::vector <Widget*>& getChildren() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the widget and all its ancestors are shown
+            ///
+            /// \return 'true' if the widget can be seen
+            ///
+            /////////////////////////////////////////////////
+            bool isVisible() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the global bounds of the widget and all its descendants, hidden ones included
+            ///
+            /// \return Bounds of the subtree
+            ///
+            /////////////////////////////////////////////////
+            sf::FloatRect getSubtreeBounds() const;
+
+        protected:
+            /////////////////////////////////////////////////
+            /// \brief Kinds of events that change the state differently
+            ///
+            /////////////////////////////////////////////////
+            enum InputKind
+            {
+                MouseLeft,
+                LeftButtonPressed,
+                LeftButtonReleased,
+                OtherButtonPressedOrReleased,
+                MouseMoved,
+                TextEntered,
+                OtherInput,
+                InputKindCount
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief What happens to the widget on an event
+            ///
+            /////////////////////////////////////////////////
+            struct StateTransition
+            {
+                WidgetState state;      //!< The next state, may be the same
+                bool callsAction;       //!< Should the action set for the event be called?
+                bool hasEffect;         //!< Should applyTransitionEffect() be called?
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Transitions by the kind of event, whether the mouse is inside the widget, and the current state (except hidden)
+            ///
+            /////////////////////////////////////////////////
+            using TransitionTable = StateTransition[InputKindCount][2][3];
+
+            /////////////////////////////////////////////////
+            /// \brief Animated part of DecorationSettings
+            ///
+            /////////////////////////////////////////////////
+            struct DecorationColors
+            {
+                sf::Color fillColor;
+                sf::Color textColor;
+                sf::Color outlineColor;
+                float outlineThickness;
+            };
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            mutable PlainRectangle m_rectangle;                                 //!< Rectangle that represents background and borders
+            const Theme* m_theme;                                               //!< Pointer to the theme using which the widget is stylized
+            WidgetState m_state;                                                //!< Current state of the widget
+            mutable bool m_contentNeedsUpdate;                                  //!< Does the theme need to be updated?
+            std::vector <std::pair <sf::Event::EventType, std::function <void()>>> m_doAction;  //!< Functions to be called on events. Widgets have few of them, so they are not kept in a map
+            std::list <Widget*>::iterator m_poolPosition;                       //!< Position of the widget in WidgetPool, allows to remove it in constant time
+            std::list <Widget*>::iterator m_topLevelPosition;                   //!< Position among top-level widgets of WidgetPool, valid while there is no parent
+            static const TransitionTable m_transitions;                         //!< Transitions of simple clickable widgets
+            DecorationColors m_animationStart;                                  //!< Colors the current transition has started from
+            float m_animationProgress;                                          //!< Progress of the transition from 0 to 1, 1 means no transition
+            WidgetHandle m_handle;                                              //!< Identifier given by WidgetPool
+            std::vector <ObservableBase*> m_bindings;                           //!< Observables the widget is bound to
+            EventMask m_eventMask;                                              //!< Event types the widget handles, types with actions are added
+            Widget* m_parent;                                                   //!< The widget containing this one, 'nullptr' if top-level
+            std::vector <Widget*> m_children;                                   //!< Contained widgets in the order they are drawn
+            mutable sf::FloatRect m_subtreeBounds;                              //!< Bounds of the widget and its descendants
+            mutable bool m_subtreeBoundsNeedUpdate;                             //!< Has anything in the subtree moved or resized since the calculation?
+
+            /////////////////////////////////////////////////
+            /// \brief Updates theme when the state changes
+            ///
+            /////////////////////////////////////////////////
+            virtual void refreshTheme() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Subscribes the widget to the observable and applies its current value
+            ///
+            /// \param observable: the value to follow
+            /// \param update: applies the value to the widget
+            ///
+            /////////////////////////////////////////////////
+            void bind(ObservableBase& observable, const std::function <void()> update);
+
+            /////////////////////////////////////////////////
+            /// \brief Tells WidgetPool that the widget looks differently now and the window must be drawn again
+            ///
+            /////////////////////////////////////////////////
+            void invalidate() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Marks bounds of the subtrees containing the widget to be calculated again
+            ///
+            /////////////////////////////////////////////////
+            void invalidateSubtreeBounds() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the transform applied to the children when they are drawn and found by the mouse
+            ///
+            /// \return Identity for simple widgets, scrolling containers move their children
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Transform getChildrenTransform() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the children are cut by the bounds of the widget. Then they are not included in the subtree bounds
+            ///
+            /// \return 'true' if the children are seen only inside the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual bool isClippingChildren() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Makes a view that cuts drawing by the bounds. It stays inside the current view, so nested clipping works
+            ///
+            /// \param sink: the sink to draw into, its current view is used
+            /// \param transform: the transform the content is drawn with
+            /// \param bounds: the area to draw in before the transform
+            /// \param view: the view to set, not changed if nothing can be seen
+            ///
+            /// \return 'false' if the area is entirely cut off
+            ///
+            /////////////////////////////////////////////////
+            static bool getClipView(const DrawSink& sink, const sf::Transform& transform, const sf::FloatRect& bounds, sf::View& view);
+
+            /////////////////////////////////////////////////
+            /// \brief Updates theme of the rectangle when the state changes
+            ///
+            /////////////////////////////////////////////////
+            void refreshRectangleTheme() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Updates only colors during the transition, the layout stays the same
+            ///
+            /////////////////////////////////////////////////
+            virtual void refreshColors() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets colors of the current state, mixed with the start colors if the transition is in progress
+            ///
+            /// \param decorationSettings: settings of the current state
+            ///
+            /// \return Colors to be shown
+            ///
+            /////////////////////////////////////////////////
+            DecorationColors getAnimatedColors(const DecorationSettings& decorationSettings) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets decoration settings of the theme for the current state
+            ///
+            /// \return 'nullptr' if the widget is hidden, else the settings
+            ///
+            /////////////////////////////////////////////////
+            const DecorationSettings* getCurrentDecorationSettings() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Changes state and calls refreshTheme() if the state differs from the current one
+            ///
+            /// \param state: new state of the widget
+            ///
+            /////////////////////////////////////////////////
+            void changeState(const WidgetState state);
+
+            /////////////////////////////////////////////////
+            /// \brief Calls the action set for the event if there is one
+            ///
+            /// \param eventType: type of the event
+            ///
+            /////////////////////////////////////////////////
+            void doAction(const sf::Event::EventType eventType);
+
+            /////////////////////////////////////////////////
+            /// \brief Called by WidgetPool when the widget gets or loses the focus. Simple widgets look the same
+            ///
+            /// \param isFocused: does the widget have the focus now?
+            ///
+            /////////////////////////////////////////////////
+            virtual void changeFocus(const bool isFocused);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the transitions of the widget. Widgets with special behavior have their own tables
+            ///
+            /// \return The table of transitions
+            ///
+            /////////////////////////////////////////////////
+            virtual const TransitionTable& getTransitionTable() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Does what a transition requires besides changing the state, e.g. toggles the checkmark
+            ///
+            /// \param event: the event causing the transition
+            ///
+            /////////////////////////////////////////////////
+            virtual void applyTransitionEffect(const sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the kind of the event for the transition table
+            ///
+            /// \param event: the event
+            ///
+            /// \return The kind of the event
+            ///
+            /////////////////////////////////////////////////
+            static InputKind getInputKind(const sf::Event& event);
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the rectangle (does not update theme) Used only inside draw() method
+            ///
+            /////////////////////////////////////////////////
+            void drawRectangle(DrawSink& sink, sf::RenderStates states) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Writes the calculated layout to the snapshot. Widgets without text have nothing to save
+            ///
+            /// \param snapshot: the snapshot being made
+            ///
+            /////////////////////////////////////////////////
+            virtual void saveLayout(LayoutSnapshot& snapshot) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Reads the layout from the snapshot instead of calculating it
+            ///
+            /// \param snapshot: the snapshot with the current record opened
+            ///
+            /// \return 'true' if the layout has been restored
+            ///
+            /////////////////////////////////////////////////
+            virtual bool restoreLayout(LayoutSnapshot& snapshot);
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the widget to the report with the type name and the size of its class
+            ///
+            /// \param report: the report being made
+            ///
+            /////////////////////////////////////////////////
+            void reportMemory(MemoryReport& report) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Every widget class reports its own name
+            ///
+            /// \return The name
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Every widget class reports its own size
+            ///
+            /// \return Size in bytes, without widgets the widget owns as members
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report
+            ///
+            /// \param report: the report being made
+            /// \param type: type the widget is reported as
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            ///
+            /// \param event: event caught by the window
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Forces appearance to be updated on the current frame. Should be used if the style is changed
+            ///
+            /////////////////////////////////////////////////
+            void forceThemeUpdate() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the widget on the window through RenderTargetSink. Inherited from sf::Drawable
+            ///
+            /////////////////////////////////////////////////
+            virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Children are drawn by WidgetPool
+            ///
+            /// \param sink: the sink to draw into
+            /// \param states: states with the transforms of the scrolled ancestors
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Widget that contains text
+    ///
+    /////////////////////////////////////////////////
+    class TextBasedWidget : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            TextBasedWidget();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~TextBasedWidget() = 0;
+
+            /////////////////////////////////////////////////
+            /// \brief Calculates the size of the widget based on the text. Updates splitting and theme before resizing
+            ///
+            /////////////////////////////////////////////////
+            void setSizeFitToText();
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the string inside the widget
+            ///
+            /// \param text: text to draw, non-printable characters are not affected
+            ///
+            /////////////////////////////////////////////////
+            void setString(const sf::String& text);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the string inside the widget, taking the storage of the given string if sf::String can be moved
+            ///
+            /// \param text: text to draw, non-printable characters are not affected
+            ///
+            /////////////////////////////////////////////////
+            void setString(sf::String&& text);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the string inside the widget from UTF-8. Characters are decoded right into the storage of the widget
+            ///
+            /// \param text: text to draw in UTF-8, non-printable characters are not affected
+            ///
+            /////////////////////////////////////////////////
+            void setUtf8String(const std::string_view text);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes padding (borders inside the widget)
+            ///
+            /// \param padding: new padding of the widget
+            ///
+            /////////////////////////////////////////////////
+            void setPadding(const sf::Vector2f& padding);
+
+            /////////////////////////////////////////////////
+            /// \brief Allows the widget to split text in several lines, or forces to keep all the string in one line
+            ///
+            /// \param isMultiline: should the text be drawn in multiple lines?
+            ///
+            /////////////////////////////////////////////////
+            void setMultilined(bool isMultiline);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes position of the widget
+            ///
+            /// \param position: new position of the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void setPosition(const sf::Vector2f& position) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the string kept inside the widget
+            ///
+            /// \return The string that is drawn on the widget. Valid until the string is changed
+            ///
+            /////////////////////////////////////////////////
+            const sf::String& getString() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current padding of the widget
+            ///
+            /// \return Current padding of the widget
+            ///
+            /////////////////////////////////////////////////
+            sf::Vector2f getPadding() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the flag allowing the text to be split to multiple lines
+            ///
+            /// \return 'true' if the text is allowed to be split to multiple lines, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool isMultiline() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the string when the value changes. The text is laid out again only if the string differs
+            ///
+            /// \param observable: the value to follow, must outlive the widget or be destroyed before it
+            /// \param format: converts the value to the string, numbers and strings are converted by default
+            ///
+            /////////////////////////////////////////////////
+            template <typename T>
+            void bindString(Observable <T>& observable, const std::function <sf::String(const T&)> format = formatValue <T>)
+            {
+                bind(observable, [this, &observable, format]()
+                {
+                    auto string = format(observable.get());
+
+                    if (string != m_string)
+                        setString(std::move(string));
+                });
+            }
+
+        protected:
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Converts the value to the string by default
+            ///
+            /// \param value: a number or anything sf::String can be constructed from
+            ///
+            /// \return The string
+            ///
+            /////////////////////////////////////////////////
+            template <typename T>
+            static sf::String formatValue(const T& value)
+            {
+                if constexpr (std::is_arithmetic_v <T>)
+                    return sf::String(std::to_string(value));
+                else
+                    return sf::String(value);
+            }
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            mutable std::vector <sf::Text> m_lines;     //!< Lines of the text to be drawn
+            sf::String m_string;                        //!< The whole text put in the widget
+            sf::Vector2f m_padding;                     //!< Padding for the content
+            bool m_isMultiline;                         //!< Is the text allowed to be split in multiple lines?
+            bool m_isTrimmable;                         //!< Should word separators be deleted from the ends and beginnings?
+
+            /////////////////////////////////////////////////
+            /// \brief Splits, stylizes and places the text if anything has changed
+            ///
+            /////////////////////////////////////////////////
+            void updateContent() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Converts 'm_string' to 'm_lines' by pushing to one or splitting to several lines
+            ///
+            /////////////////////////////////////////////////
+            void updateTextSplitting() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Calculates position of each line
+            ///
+            /////////////////////////////////////////////////
+            void placeText() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Updates theme when the state changes
+            ///
+            /////////////////////////////////////////////////
+            virtual void refreshTheme() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Updates theme of text when the state changes
+            ///
+            /////////////////////////////////////////////////
+            void refreshTextTheme() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Updates colors of the rectangle and the text during the transition
+            ///
+            /////////////////////////////////////////////////
+            virtual void refreshColors() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the text (does not update theme) Used only inside draw() method
+            ///
+            /////////////////////////////////////////////////
+            void drawText(DrawSink& sink, sf::RenderStates states) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Writes lines and their positions to the snapshot
+            ///
+            /// \param snapshot: the snapshot being made
+            ///
+            /////////////////////////////////////////////////
+            virtual void saveLayout(LayoutSnapshot& snapshot) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Reads lines and their positions if the snapshot was made for the same settings
+            ///
+            /// \param snapshot: the snapshot with the current record opened
+            ///
+            /// \return 'true' if the layout has been restored
+            ///
+            /////////////////////////////////////////////////
+            virtual bool restoreLayout(LayoutSnapshot& snapshot) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Hashes everything the layout depends on: the string, the font, sizes, alignment and the text style
+            ///
+            /// \return The hash
+            ///
+            /////////////////////////////////////////////////
+            sf::Uint64 getLayoutFingerprint() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets bounds of the text taking its scale into account
+            ///
+            /// \param text: the text to measure
+            ///
+            /// \return Scaled local bounds
+            ///
+            /////////////////////////////////////////////////
+            static sf::FloatRect getScaledBounds(const sf::Text& text);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds position of the first separator between words
+            ///
+            /// \param begin: position where the search starts from
+            ///
+            /////////////////////////////////////////////////
+            size_t findFirstWordSeparatorPosition(size_t begin) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Deletes all word separators from the beginning and the end of a part of the string.
+            /// A part made of separators only is not changed
+            ///
+            /// \param begin: index of the first character of the part, moved forward
+            /// \param end: index after the last character of the part, moved backward
+            ///
+            /////////////////////////////////////////////////
+            void trimRange(size_t& begin, size_t& end) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the right border of a character of a part of the string as if the part was drawn alone
+            ///
+            /// \param run: the measured string
+            /// \param begin: index of the first character of the part, the part must not contain '\n'
+            /// \param index: index of the character
+            ///
+            /// \return Position of the right border without the scale of the text settings
+            ///
+            /////////////////////////////////////////////////
+            float getCharacterRight(const ShapedRunCache::ShapedRun& run, const size_t begin, const size_t index) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Puts a part of the string to the line, reusing the line and its storage if it exists
+            ///
+            /// \param index: index of the line, at most the number of lines
+            /// \param begin: index of the first character of the part
+            /// \param end: index after the last character of the part
+            ///
+            /////////////////////////////////////////////////
+            void setLine(const size_t index, const size_t begin, const size_t end) const;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            static const sf::String m_wordSeparators;   //!< A string containing separators between words to split them
+            mutable sf::String m_lineString;            //!< Storage for a line being put to 'm_lines', kept between layouts
+            mutable ShapedRunCache::ShapedRun m_splittingRun;   //!< The measured string for splitting, kept between layouts
+            mutable DistanceFieldFont::VertexBatches m_distanceFieldVertices;  //!< Lines converted for the distance field font
+            mutable bool m_distanceFieldVerticesNeedUpdate;                     //!< Have the lines changed since the conversion?
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Clickable and labeled widget
+    ///
+    /////////////////////////////////////////////////
+    class PushButton : public TextBasedWidget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            PushButton();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~PushButton();
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A clickable widget that is represented by an icon
+    ///
+    /////////////////////////////////////////////////
+    class IconButton : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            IconButton();
+
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            virtual ~IconButton();
+
+            /////////////////////////////////////////////////
+            /// \brief Changes position of the widget
+            ///
+            /// \param position: new position of the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void setPosition(const sf::Vector2f& position) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Changes size of the widget
+            ///
+            /// \param size: new size of the widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void setSize(const sf::Vector2f& size) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Changes texture of the icon
+            ///
+            /// \param texture: new texture of the icon
+            ///
+            /////////////////////////////////////////////////
+            void setIconTexture(const sf::Texture& texture);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes texture rectangle of the icon
+            ///
+            /// \param texture: new texture rectangle of the icon
+            ///
+            /////////////////////////////////////////////////
+            void setIconTextureRect(const sf::IntRect& rectangle);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets texture of the icon
+            ///
+            /// \return Current texture of the icon
+            ///
+            /////////////////////////////////////////////////
+            const sf::Texture* getIconTexture() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets texture rectangle of the icon
+            ///
+            /// \return Current texture rectangle of the icon
+            ///
+            /////////////////////////////////////////////////
+            sf::IntRect getIconTextureRect() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// Member date
+            /////////////////////////////////////////////////
+            mutable sf::Sprite m_icon;                  //!< Icon to be drawn
+            mutable sf::Vector2u m_iconTextureSize;     //!< Size of the texture when the icon was updated, changes when a loading texture is ready
+            bool m_isIconTextureRectSet;                //!< Has the texture rectangle been given, or should the whole texture be drawn?
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the size of the icon
+            ///
+            /////////////////////////////////////////////////
+            void updateSpriteSize() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A rectangle grouping child widgets. Hiding the panel hides all its children at once
+    ///
+    /////////////////////////////////////////////////
+    class Panel : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            Panel();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~Panel();
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Draws the rectangle if the panel has a theme. Children are drawn by WidgetPool. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A panel that shows its children through its bounds and scrolls them by the mouse wheel.
+    /// Children are moved only when drawn, so their layout is not calculated again
+    ///
+    /////////////////////////////////////////////////
+    class ScrollPanel : public Panel
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            ScrollPanel();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~ScrollPanel();
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the content. Children keep their positions, they are only drawn moved by the offset
+            ///
+            /// \param offset: distance from the unscrolled content, limited so that the content does not leave the panel
+            ///
+            /////////////////////////////////////////////////
+            void setScrollOffset(const sf::Vector2f& offset);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the distance the content is scrolled by
+            ///
+            /// \return The offset
+            ///
+            /////////////////////////////////////////////////
+            const sf::Vector2f& getScrollOffset() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the distance scrolled by one step of the mouse wheel
+            ///
+            /// \param step: distance in pixels
+            ///
+            /////////////////////////////////////////////////
+            void setScrollStep(const float step);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the bounds of all children before scrolling
+            ///
+            /// \return Bounds of the content, the bounds of the panel if it has no children
+            ///
+            /////////////////////////////////////////////////
+            sf::FloatRect getContentBounds() const;
+
+        protected:
+            /////////////////////////////////////////////////
+            /// \brief Moves the children by the scroll offset
+            ///
+            /// \return The translation
+            ///
+            /////////////////////////////////////////////////
+            virtual sf::Transform getChildrenTransform() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief The children are seen only inside the panel
+            ///
+            /// \return 'true'
+            ///
+            /////////////////////////////////////////////////
+            virtual bool isClippingChildren() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the content by the mouse wheel
+            ///
+            /// \param event: event caught by the window
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            sf::Vector2f m_scrollOffset;        //!< Distance the content is scrolled by
+            float m_scrollStep;                 //!< Distance scrolled by one step of the mouse wheel
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A clickable widget that is represented by a box and shows the list of items when clicked. Can be used as a drop down menu
+    ///
+    /////////////////////////////////////////////////
+    class DropDownList : public TextBasedWidget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            DropDownList();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~DropDownList();
+
+            /////////////////////////////////////////////////
+            /// \brief Add new item to the list
+            ///
+            /// \param label: text to be shown on the new list item
+            /// \param doAction: function to be called after the item receives 'MouseButtonRelease'
+            ///
+            /////////////////////////////////////////////////
+            void addListItem(const sf::String& label, const std::function <void()> doAction);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the specified theme for all list items
+            ///
+            /// \param theme: a theme for items
+            ///
+            /////////////////////////////////////////////////
+            void setItemsTheme(const Theme& theme);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            Panel m_itemPanel;                  //!< Parent of the items, hidden while the list is closed
+            std::list <PushButton> m_items;     //!< List of items. May cause the program crash if some magic moves the item in the memory: WidgetPool will have an outdated pointer
+            const Theme* m_itemsTheme;          //!< A theme for all items to apply automatically
+            bool m_isOpened;                    //!< Are the items shown?
+
+            /////////////////////////////////////////////////
+            /// \brief Allows all items to be shown
+            ///
+            /////////////////////////////////////////////////
+            void showItems();
+
+            /////////////////////////////////////////////////
+            /// \brief Prohibites all items from being shown
+            ///
+            /////////////////////////////////////////////////
+            void hideItems();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the transitions of the widget
+            ///
+            /// \return The table of transitions
+            ///
+            /////////////////////////////////////////////////
+            virtual const TransitionTable& getTransitionTable() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Shows or hides the items
+            ///
+            /// \param event: the event causing the transition
+            ///
+            /////////////////////////////////////////////////
+            virtual void applyTransitionEffect(const sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Hides the items when the focus goes to another widget
+            ///
+            /// \param isFocused: does the widget have the focus now?
+            ///
+            /////////////////////////////////////////////////
+            virtual void changeFocus(const bool isFocused) override;
+
+            /////////////////////////////////////////////////
+            /// Transitions while the items are hidden and shown
+            /////////////////////////////////////////////////
+            static const TransitionTable m_closedTransitions;
+            static const TransitionTable m_openedTransitions;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A gui element that allows the user to input text. Does not allow to input multilined text, but can show it if it is too long
+    ///
+    /////////////////////////////////////////////////
+    class TextBox : public TextBasedWidget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            TextBox();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~TextBox();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the value showing how many symbols user can input
+            ///
+            /// \return Current maximum allowed length in characters
+            ///
+            /////////////////////////////////////////////////
+            size_t getMaxInputLength() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the value showing how many symbols user can input
+            ///
+            /// \param New maximum allowed length in characters
+            ///
+            /////////////////////////////////////////////////
+            void setMaxInputLength(const size_t maxInputLength = sf::String::InvalidPos);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            size_t m_maxInputLength;        //!< Maximum allowed length in characters. Initially set to the maximum size of sf::String
+            static const TransitionTable m_transitions;     //!< Transitions of all text boxes
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the transitions of the widget
+            ///
+            /// \return The table of transitions
+            ///
+            /////////////////////////////////////////////////
+            virtual const TransitionTable& getTransitionTable() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the text box pressed while it has the focus, so the text can be typed
+            ///
+            /// \param isFocused: does the widget have the focus now?
+            ///
+            /////////////////////////////////////////////////
+            virtual void changeFocus(const bool isFocused) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the entered character to the string
+            ///
+            /// \param event: the event causing the transition
+            ///
+            /////////////////////////////////////////////////
+            virtual void applyTransitionEffect(const sf::Event& event) override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A gui element that allows to set a tick or unset it. The checkmark can be any string or symbol that the font allows
+    ///
+    /////////////////////////////////////////////////
+    class CheckBox : public TextBasedWidget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            CheckBox();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~CheckBox();
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the checkbox is checked with a check
+            ///
+            /// \return 'true' if checked, 'false' if unchecked
+            ///
+            /////////////////////////////////////////////////
+            bool isChecked() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the checkbox is checked with a check
+            ///
+            /// \return 'true' if checked, 'false' if unchecked
+            ///
+            /////////////////////////////////////////////////
+            void setChecked(const bool isChecked);
+
+            /////////////////////////////////////////////////
+            /// \brief Checks or unchecks the checkbox when the value changes
+            ///
+            /// \param isChecked: the value to follow, must outlive the widget or be destroyed before it
+            ///
+            /////////////////////////////////////////////////
+            void bindChecked(Observable <bool>& isChecked);
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            bool m_isChecked;   //!< Is the checkmark set?
+            static const TransitionTable m_transitions;     //!< Transitions of all checkboxes
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the transitions of the widget
+            ///
+            /// \return The table of transitions
+            ///
+            /////////////////////////////////////////////////
+            virtual const TransitionTable& getTransitionTable() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Toggles the checkmark
+            ///
+            /// \param event: the event causing the transition
+            ///
+            /////////////////////////////////////////////////
+            virtual void applyTransitionEffect(const sf::Event& event) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A gui element that allows to set a tick or unset it. The checkmark can be any string or symbol that the font allows
+    ///
+    /////////////////////////////////////////////////
+    class StaticText : public TextBasedWidget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            StaticText();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~StaticText();
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            ///
+            /// \param event: event caught by the window
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A table which cells are requested from a callback when they become visible. Only visible rows are kept,
+    /// and scrolling moves them instead of laying them out again, so the number of rows does not matter
+    ///
+    /////////////////////////////////////////////////
+    class DataGrid : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Gets the string of a cell by its row and column
+            ///
+            /////////////////////////////////////////////////
+            using DataSource = std::function <sf::String(const size_t row, const size_t column)>;
+
+            /////////////////////////////////////////////////
+            /// \brief Returned by getRowAt() if there is no row under the point
+            ///
+            /////////////////////////////////////////////////
+            static constexpr size_t NoRow = static_cast <size_t>(-1);
+
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty object
+            ///
+            /////////////////////////////////////////////////
+            DataGrid();
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~DataGrid();
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the function giving strings of cells. It is called only for visible rows
+            ///
+            /// \param dataSource: the function to call
+            ///
+            /////////////////////////////////////////////////
+            void setDataSource(const DataSource dataSource);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the number of rows. Visible rows are kept if they still exist
+            ///
+            /// \param rowCount: new number of rows
+            ///
+            /////////////////////////////////////////////////
+            void setRowCount(const size_t rowCount);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the number of columns
+            ///
+            /// \param columnCount: new number of columns
+            ///
+            /////////////////////////////////////////////////
+            void setColumnCount(const size_t columnCount);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the title of the column. The header row is shown if any column has a title
+            ///
+            /// \param column: index of the column
+            /// \param header: the title
+            ///
+            /////////////////////////////////////////////////
+            void setColumnHeader(const size_t column, const sf::String& header);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets the width of the column. Text that does not fit is cut
+            ///
+            /// \param column: index of the column
+            /// \param width: new width, zero means that the width is measured by the header and the visible rows once
+            ///
+            /////////////////////////////////////////////////
+            void setColumnWidth(const size_t column, const float width);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the space between borders of cells and their text
+            ///
+            /// \param padding: new padding
+            ///
+            /////////////////////////////////////////////////
+            void setCellPadding(const sf::Vector2f& padding);
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the rows
+            ///
+            /// \param offset: distance from the top of the first row to the top of the visible area
+            ///
+            /////////////////////////////////////////////////
+            void setScrollOffset(const double offset);
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the rows to show the row at the top
+            ///
+            /// \param row: index of the row
+            ///
+            /////////////////////////////////////////////////
+            void scrollToRow(const size_t row);
+
+            /////////////////////////////////////////////////
+            /// \brief Requests strings of visible cells again. Must be used if the data has changed
+            ///
+            /////////////////////////////////////////////////
+            void refreshData();
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of rows
+            ///
+            /// \return Number of rows
+            ///
+            /////////////////////////////////////////////////
+            size_t getRowCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of columns
+            ///
+            /// \return Number of columns
+            ///
+            /////////////////////////////////////////////////
+            size_t getColumnCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the width of the column, measured if it has been set to zero
+            ///
+            /// \param column: index of the column
+            ///
+            /// \return Width of the column, zero if there is no such column
+            ///
+            /////////////////////////////////////////////////
+            float getColumnWidth(const size_t column) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the height of each row, defined by the font of the theme and the padding
+            ///
+            /// \return Height of a row, zero if there is no theme
+            ///
+            /////////////////////////////////////////////////
+            float getRowHeight() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current scroll offset
+            ///
+            /// \return Distance from the top of the first row to the top of the visible area
+            ///
+            /////////////////////////////////////////////////
+            double getScrollOffset() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the row under the point, for example, under the mouse
+            ///
+            /// \param point: the point in the world coordinates
+            ///
+            /// \return Index of the row, 'NoRow' if the point is outside the rows
+            ///
+            /////////////////////////////////////////////////
+            size_t getRowAt(const sf::Vector2f& point) const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Glyphs of one row relative to its top left corner
+            ///
+            /////////////////////////////////////////////////
+            struct Row
+            {
+                size_t index;               //!< Index of the row in the data
+                sf::VertexArray vertices;   //!< Glyphs of all cells
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the rows by the mouse wheel, then processes the event as usual
+            ///
+            /// \param event: event caught by the window
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the height of the header row
+            ///
+            /// \return Zero if no column has a title, else the height of a row
+            ///
+            /////////////////////////////////////////////////
+            float getHeaderHeight() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the largest scroll offset that shows the last row at the bottom
+            ///
+            /// \return The offset
+            ///
+            /////////////////////////////////////////////////
+            double getMaxScrollOffset() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Calculates the range of rows intersecting the visible area
+            ///
+            /// \param first: index of the first visible row
+            /// \param last: index after the last visible row
+            ///
+            /////////////////////////////////////////////////
+            void getVisibleRows(size_t& first, size_t& last) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Measures columns which width is zero
+            ///
+            /////////////////////////////////////////////////
+            void updateColumnWidths() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Drops rows that are not visible anymore and builds the ones that have become visible
+            ///
+            /////////////////////////////////////////////////
+            void updateRows() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Creates glyphs of the row
+            ///
+            /// \param index: index of the row in the data
+            ///
+            /// \return The row
+            ///
+            /////////////////////////////////////////////////
+            Row buildRow(const size_t index) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds glyphs of the cell, the ones that do not fit the column are skipped
+            ///
+            /// \param vertices: where to add the glyphs
+            /// \param string: text of the cell
+            /// \param left: left border of the cell in the row
+            /// \param width: width of the column
+            /// \param style: style of the text
+            ///
+            /////////////////////////////////////////////////
+            void appendCell(sf::VertexArray& vertices, const sf::String& string, const float left, const float width, const sf::Uint32 style) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            DataSource m_dataSource;                        //!< Gives strings of cells
+            size_t m_rowCount;                              //!< Number of rows in the data
+            std::vector <sf::String> m_headers;             //!< Titles of columns
+            std::vector <float> m_columnWidths;             //!< Widths set by the user, zero means measured
+            mutable std::vector <float> m_measuredWidths;   //!< Widths of columns in use
+            mutable bool m_columnWidthsNeedUpdate;          //!< Should zero widths be measured again?
+            sf::Vector2f m_cellPadding;                     //!< Space between borders of cells and text
+            mutable double m_scrollOffset;                  //!< Double keeps the precision for millions of rows
+            mutable std::deque <Row> m_rows;                //!< Built visible rows in the order of their indices
+            mutable sf::VertexArray m_headerVertices;       //!< Glyphs of the header row
+            mutable sf::Color m_textColor;                  //!< Color the glyphs have been built with
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A console showing the last lines of a log. Lines are kept in a ring buffer of fixed capacity:
+    /// appending wraps only the new line and forgets the oldest one when the buffer is full
+    ///
+    /////////////////////////////////////////////////
+    class LogConsole : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /// \param capacity: the maximum number of lines to keep
+            ///
+            /////////////////////////////////////////////////
+            LogConsole(const size_t capacity = 10000);
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor
+            ///
+            /////////////////////////////////////////////////
+            virtual ~LogConsole();
+
+            /////////////////////////////////////////////////
+            /// \brief Adds lines to the end. A string with line breaks is added as several lines
+            ///
+            /// \param line: the text to add
+            ///
+            /////////////////////////////////////////////////
+            void appendLine(const sf::String& line);
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all lines
+            ///
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Changes the maximum number of lines, the oldest ones are forgotten if there are more
+            ///
+            /// \param capacity: the maximum number of lines, at least one
+            ///
+            /////////////////////////////////////////////////
+            void setCapacity(const size_t capacity);
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the console show the newest lines when new lines are added. Otherwise the shown lines stay in place
+            ///
+            /// \param isAutoScrolling: should the console scroll to new lines?
+            ///
+            /////////////////////////////////////////////////
+            void setAutoScrolling(const bool isAutoScrolling);
+
+            /////////////////////////////////////////////////
+            /// \brief Changes padding (borders inside the widget)
+            ///
+            /// \param padding: new padding of the widget
+            ///
+            /////////////////////////////////////////////////
+            void setPadding(const sf::Vector2f& padding);
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the console
+            ///
+            /// \param offset: number of wrapped lines between the newest line and the bottom of the console
+            ///
+            /////////////////////////////////////////////////
+            void setScrollOffset(const size_t offset);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of lines kept
+            ///
+            /// \return Number of lines, before wrapping
+            ///
+            /////////////////////////////////////////////////
+            size_t getLineCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the maximum number of lines
+            ///
+            /// \return The capacity
+            ///
+            /////////////////////////////////////////////////
+            size_t getCapacity() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the line by its index
+            ///
+            /// \param index: index of the line, zero is the oldest one
+            ///
+            /// \return The line
+            ///
+            /////////////////////////////////////////////////
+            const sf::String& getLine(const size_t index) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Checks if the console scrolls to new lines
+            ///
+            /// \return 'true' if the console scrolls to new lines, else 'false'
+            ///
+            /////////////////////////////////////////////////
+            bool isAutoScrolling() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the current scroll offset
+            ///
+            /// \return Number of wrapped lines between the newest line and the bottom of the console
+            ///
+            /////////////////////////////////////////////////
+            size_t getScrollOffset() const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const override;
+
+            /////////////////////////////////////////////////
+            /// \brief A line and where it is wrapped
+            ///
+            /////////////////////////////////////////////////
+            struct Entry
+            {
+                sf::String line;                        //!< The whole line
+                std::vector <size_t> wrapPositions;     //!< Where each wrapped line starts, the first one is always zero
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Scrolls the console by the mouse wheel, then processes the event as usual
+            ///
+            /// \param event: event caught by the window
+            /// \param mousePosition: current mouse position in the world coordinates
+            ///
+            /////////////////////////////////////////////////
+            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the entry by its index from the oldest one
+            ///
+            /// \param index: index of the line
+            ///
+            /// \return The entry
+            ///
+            /////////////////////////////////////////////////
+            Entry& getEntry(const size_t index) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds where the line is wrapped by the current width
+            ///
+            /// \param entry: the entry to wrap
+            ///
+            /////////////////////////////////////////////////
+            void wrapEntry(Entry& entry) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the advance of the glyph of the current font.
+            /// A tab is four spaces wide, as in sf::Text
+            ///
+            /// \param codePoint: the character
+            ///
+            /// \return The advance
+            ///
+            /////////////////////////////////////////////////
+            float getAdvance(const sf::Uint32 codePoint) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of whole lines the console can show
+            ///
+            /// \return Number of lines, zero if there is no theme
+            ///
+            /////////////////////////////////////////////////
+            size_t getVisibleLineCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Creates glyphs of the visible lines
+            ///
+            /////////////////////////////////////////////////
+            void updateVertices() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            mutable std::vector <Entry> m_entries;      //!< Ring buffer, entries are reused when it is full
+            size_t m_firstEntry;                        //!< Index of the oldest entry in the buffer
+            size_t m_capacity;                          //!< The maximum number of entries
+            mutable size_t m_wrappedLineCount;          //!< Number of lines after wrapping
+            mutable float m_wrapWidth;                  //!< Width the entries have been wrapped by, negative if they must be wrapped again
+            mutable std::vector <float> m_advances;     //!< Advances of the first code points of the font, negative if unknown
+            mutable size_t m_scrollOffset;              //!< Wrapped lines between the newest one and the bottom
+            bool m_isAutoScrolling;                     //!< Should the console scroll to new lines?
+            sf::Vector2f m_padding;                     //!< Padding for the content
+            mutable sf::VertexArray m_vertices;         //!< Glyphs of the visible lines
+            mutable bool m_verticesNeedUpdate;          //!< Have lines or scrolling changed since the glyphs were made?
+            mutable sf::Color m_textColor;              //!< Color the glyphs have been made with
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief A chart of series of samples streamed in real time. Samples are kept in ring buffers,
+    /// and each pixel column shows the minimum and the maximum of the samples that fall into it
+    ///
+    /////////////////////////////////////////////////
+    class Plot : public Widget
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor
+            ///
+            /// \param capacity: the number of the latest samples of each series to show
+            ///
+            /////////////////////////////////////////////////
+            Plot(const size_t capacity = 4096);
 
             /////////////////////////////////////////////////
             /// \brief Default destructor
             ///
             /////////////////////////////////////////////////
-            virtual ~StaticText();
+            virtual ~Plot();
+
+            /////////////////////////////////////////////////
+            /// \brief Adds a new empty series
+            ///
+            /// \param color: color of the line
+            ///
+            /// \return Index of the series
+            ///
+            /////////////////////////////////////////////////
+            size_t addSeries(const sf::Color& color);
+
+            /////////////////////////////////////////////////
+            /// \brief Adds a sample to the end of the series, the oldest one is forgotten if there are too many
+            ///
+            /// \param series: index of the series
+            /// \param value: the sample
+            ///
+            /////////////////////////////////////////////////
+            void addSample(const size_t series, const float value);
+
+            /////////////////////////////////////////////////
+            /// \brief Removes all samples of all series
+            ///
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Sets values shown at the bottom and the top of the widget. Samples out of the range are clamped
+            ///
+            /// \param minimum: value at the bottom
+            /// \param maximum: value at the top
+            ///
+            /////////////////////////////////////////////////
+            void setRange(const float minimum, const float maximum);
+
+            /////////////////////////////////////////////////
+            /// \brief Sets color of the line of the series
+            ///
+            /// \param series: index of the series
+            /// \param color: new color
+            ///
+            /////////////////////////////////////////////////
+            void setSeriesColor(const size_t series, const sf::Color& color);
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of series
+            ///
+            /// \return Number of series
+            ///
+            /////////////////////////////////////////////////
+            size_t getSeriesCount() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of the latest samples kept for each series
+            ///
+            /// \return Capacity
+            ///
+            /////////////////////////////////////////////////
+            size_t getCapacity() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the number of samples added to the series since it was created or cleared
+            ///
+            /// \param series: index of the series
+            ///
+            /// \return Number of samples, zero if there is no such series
+            ///
+            /////////////////////////////////////////////////
+            sf::Uint64 getSampleCount(const size_t series) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the value shown at the bottom
+            ///
+            /// \return Minimum
+            ///
+            /////////////////////////////////////////////////
+            float getMinimum() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the value shown at the top
+            ///
+            /// \return Maximum
+            ///
+            /////////////////////////////////////////////////
+            float getMaximum() const;
 
         private:
             /////////////////////////////////////////////////
-            /// \brief Processes the event sent by the instance of WidgetPool. Changes styles and controls behavior
+            /// \brief Gets the name of the class in memory reports. Inherited from Widget
             ///
-            /// \param event: event caught by the window
-            /// \param mousePosition: current mouse position in the world coordinates
+            /////////////////////////////////////////////////
+            virtual const char* getTypeName() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Gets the size of the widget in memory reports. Inherited from Widget
             ///
             /////////////////////////////////////////////////
-            virtual void processEvent(const sf::Event event, const sf::Vector2f& mousePosition) override;
+            virtual size_t getObjectSize() const override;
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the memory allocated by the members to the report. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void reportComponents(MemoryReport& report, const std::string& type) const override;
+
+            static constexpr sf::Uint64 NoColumn = static_cast <sf::Uint64>(-1); //!< Index of an empty column
+
+            /////////////////////////////////////////////////
+            /// \brief Samples that fall into one column of pixels
+            ///
+            /////////////////////////////////////////////////
+            struct Column
+            {
+                sf::Uint64 index;   //!< Index of the column from the first sample, NoColumn if the column is empty
+                float first;        //!< The first sample
+                float last;         //!< The last sample
+                float minimum;      //!< The least sample
+                float maximum;      //!< The greatest sample
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Samples of a series and their lines
+            ///
+            /////////////////////////////////////////////////
+            struct Series
+            {
+                sf::Color color;                    //!< Color of the line
+                std::vector <float> samples;        //!< Ring buffer of the latest samples
+                sf::Uint64 sampleCount;             //!< Number of samples ever added
+                std::vector <Column> columns;       //!< Ring buffer of columns, a column takes the place of its index modulo size
+                std::vector <sf::Vertex> vertices;  //!< Four vertices for each column in the same places
+            };
+
+            /////////////////////////////////////////////////
+            /// \brief Adds the sample to its column and updates vertices of the column
+            ///
+            /// \param series: the series
+            /// \param sampleIndex: index of the sample from the first one
+            /// \param value: the sample
+            ///
+            /////////////////////////////////////////////////
+            void addToColumn(Series& series, const sf::Uint64 sampleIndex, const float value) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Splits the kept samples into columns again, used when the size or the range is changed
+            ///
+            /////////////////////////////////////////////////
+            void updateColumns() const;
+
+            /////////////////////////////////////////////////
+            /// \brief Converts a sample to the vertical coordinate inside the widget
+            ///
+            /// \param value: the sample
+            ///
+            /// \return Distance from the top
+            ///
+            /////////////////////////////////////////////////
+            float getY(const float value) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Sends the primitives of the widget to the sink. Inherited from Widget
+            ///
+            /////////////////////////////////////////////////
+            virtual void render(DrawSink& sink, sf::RenderStates states) const override;
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            mutable std::vector <Series> m_series;      //!< All series
+            size_t m_capacity;                          //!< The number of samples kept for each series
+            float m_minimum;                            //!< Value at the bottom
+            float m_maximum;                            //!< Value at the top
+            mutable size_t m_columnCount;               //!< Number of columns the series are split into
+            mutable float m_columnWidth;                //!< Width of a column, one pixel unless there are fewer samples than pixels
+            mutable sf::Uint64 m_samplesPerColumn;      //!< The number of samples decimated into one column
+            mutable sf::Vector2f m_columnsSize;         //!< Size of the widget the columns have been made for
+            mutable bool m_columnsNeedUpdate;           //!< Should the columns be made from samples again?
+    };
+
+    /////////////////////////////////////////////////
+    /// \brief Builds themes and widgets from a text description
+    ///
+    /// Each line describes one object: its type, its name and a list of properties.
+    /// Objects can refer only to the objects described above them:
+    ///
+    /// \code
+    /// # Comments start with '#'
+    /// TextSettings       text    font=arial characterSize=36 horizontalAlignment=Left
+    /// DecorationSettings idle    fillColor=#FFFFFF textColor=#000000 outlineThickness=1 outlineColor=#808080
+    /// DecorationSettings active  fillColor=#E5F3FF textColor=#000000 textStyle=Bold|Underlined
+    /// Theme              main    text=text idle=idle hover=active press=active
+    /// PushButton         ok      theme=main position=10,10 size=fit string="OK"
+    /// \endcode
+    ///
+    /// The description is parsed in one pass without copying names and values.
+    /// Widgets sized by 'size=fit' are laid out once after the whole description is read
+    ///
+    /////////////////////////////////////////////////
+    class UiLoader
+    {
+        public:
+            /////////////////////////////////////////////////
+            /// \brief Default constructor to create an empty loader
+            ///
+            /////////////////////////////////////////////////
+            UiLoader();
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because widgets and settings are used through pointers that become outdated after moving the object
+            ///
+            /////////////////////////////////////////////////
+            UiLoader(UiLoader const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Disabled because widgets and settings are used through pointers that become outdated after moving the object
+            ///
+            /////////////////////////////////////////////////
+            void operator=(UiLoader const&) = delete;
+
+            /////////////////////////////////////////////////
+            /// \brief Default destructor. Destroys all loaded widgets and settings
+            ///
+            /////////////////////////////////////////////////
+            virtual ~UiLoader();
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the font available for descriptions under the given name. The font must outlive the loader
+            ///
+            /// \param name: name used by the 'font' property
+            /// \param font: font to use
+            /// \param fontHash: hash of the font file for layout snapshots, zero if it is unknown
+            ///
+            /////////////////////////////////////////////////
+            void addFont(const std::string& name, const sf::Font& font, const sf::Uint64 fontHash = 0);
+
+            /////////////////////////////////////////////////
+            /// \brief Makes the texture available for descriptions under the given name. The texture must outlive the loader
+            ///
+            /// \param name: name used by the 'backgroundTexture' and 'iconTexture' properties
+            /// \param texture: texture to use
+            ///
+            /////////////////////////////////////////////////
+            void addTexture(const std::string& name, const sf::Texture& texture);
+
+            /////////////////////////////////////////////////
+            /// \brief Reads the description from the file. Everything loaded before is destroyed
+            ///
+            /// \param fileName: path to the file
+            ///
+            /// \return 'true' if the description has been loaded, else 'false'. Errors are written to sf::err()
+            ///
+            /////////////////////////////////////////////////
+            bool loadFromFile(const std::string& fileName);
+
+            /////////////////////////////////////////////////
+            /// \brief Reads the description from the memory. Everything loaded before is destroyed
+            ///
+            /// \param description: text of the description
+            ///
+            /// \return 'true' if the description has been loaded, else 'false'. Errors are written to sf::err()
+            ///
+            /////////////////////////////////////////////////
+            bool loadFromMemory(const std::string_view description);
+
+            /////////////////////////////////////////////////
+            /// \brief Destroys all loaded widgets and settings
+            ///
+            /////////////////////////////////////////////////
+            void clear();
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the loaded widget
+            ///
+            /// \param name: name of the widget in the description
+            ///
+            /// \return 'nullptr' if there is no such widget, else the pointer to the widget
+            ///
+            /////////////////////////////////////////////////
+            Widget* getWidget(const std::string_view name) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the loaded widget of the specified type
+            ///
+            /// \param name: name of the widget in the description
+            ///
+            /// \return 'nullptr' if there is no such widget or it has another type, else the pointer to the widget
+            ///
+            /////////////////////////////////////////////////
+            template <typename T>
+            T* getWidget(const std::string_view name) const
+            {
+                return dynamic_cast <T*>(getWidget(name));
+            }
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the loaded text settings. They can be changed, but WidgetPool::forceThemeUpdate() must be called then
+            ///
+            /// \param name: name of the settings in the description
+            ///
+            /// \return 'nullptr' if there are no such settings, else the pointer to them
+            ///
+            /////////////////////////////////////////////////
+            TextSettings* getTextSettings(const std::string_view name) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the loaded decoration settings. They can be changed, but WidgetPool::forceThemeUpdate() must be called then
+            ///
+            /// \param name: name of the settings in the description
+            ///
+            /// \return 'nullptr' if there are no such settings, else the pointer to them
+            ///
+            /////////////////////////////////////////////////
+            DecorationSettings* getDecorationSettings(const std::string_view name) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Finds the loaded theme
+            ///
+            /// \param name: name of the theme in the description
+            ///
+            /// \return 'nullptr' if there is no such theme, else the pointer to the theme
+            ///
+            /////////////////////////////////////////////////
+            const Theme* getTheme(const std::string_view name) const;
+
+        private:
+            /////////////////////////////////////////////////
+            /// \brief A property of the described object: 'key=value'
+            ///
+            /////////////////////////////////////////////////
+            struct Property
+            {
+                std::string_view key;
+                std::string_view value;
+            };
+
+            /////////////////////////////////////////////////
+            /// Member data
+            /////////////////////////////////////////////////
+            std::string m_source;                                                               //!< The description. All names refer to it
+            std::map <std::string, std::pair <const sf::Font*, sf::Uint64>, std::less<>> m_fonts; //!< Fonts available for descriptions with their hashes
+            std::map <std::string, const sf::Texture*, std::less<>> m_textures;                 //!< Textures available for descriptions
+            std::vector <std::unique_ptr <TextSettings>> m_textSettings;                        //!< Loaded text settings
+            std::vector <std::unique_ptr <DecorationSettings>> m_decorationSettings;            //!< Loaded decoration settings
+            std::vector <std::unique_ptr <Theme>> m_themes;                                     //!< Loaded themes
+            std::vector <std::unique_ptr <Widget>> m_widgets;                                   //!< Loaded widgets. Declared last to be destroyed before the themes
+            std::unordered_map <std::string_view, TextSettings*> m_textSettingsByName;          //!< Loaded text settings by names
+            std::unordered_map <std::string_view, DecorationSettings*> m_decorationsByName;     //!< Loaded decoration settings by names
+            std::unordered_map <std::string_view, const Theme*> m_themesByName;                 //!< Loaded themes by names
+            std::unordered_map <std::string_view, Widget*> m_widgetsByName;                     //!< Loaded widgets by names
+            size_t m_lineNumber;                                                                //!< The line being parsed, used in error messages
+
+            /////////////////////////////////////////////////
+            /// \brief Parses 'm_source' and creates all described objects
+            ///
+            /// \return 'true' on success, 'false' if the description is incorrect
+            ///
+            /////////////////////////////////////////////////
+            bool parse();
+
+            /////////////////////////////////////////////////
+            /// \brief Cuts the next word or 'key=value' pair from the line. Quoted values may contain spaces
+            ///
+            /// \param line: the rest of the line, the token is removed from it
+            /// \param token: the found token
+            ///
+            /// \return 'false' if there are no more tokens or a quote is not closed
+            ///
+            /////////////////////////////////////////////////
+            static bool nextToken(std::string_view& line, Property& token);
+
+            /////////////////////////////////////////////////
+            /// \brief Writes the error message with the current line number to sf::err()
+            ///
+            /// \param message: what is wrong
+            /// \param subject: the part of the description that caused the error
+            ///
+            /// \return Always 'false' to be returned by the caller
+            ///
+            /////////////////////////////////////////////////
+            bool reportError(const std::string_view message, const std::string_view subject) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Creates text settings
+            ///
+            /////////////////////////////////////////////////
+            bool createTextSettings(const std::string_view name, const std::vector <Property>& properties);
+
+            /////////////////////////////////////////////////
+            /// \brief Creates decoration settings
+            ///
+            /////////////////////////////////////////////////
+            bool createDecorationSettings(const std::string_view name, const std::vector <Property>& properties);
+
+            /////////////////////////////////////////////////
+            /// \brief Creates a theme
+            ///
+            /////////////////////////////////////////////////
+            bool createTheme(const std::string_view name, const std::vector <Property>& properties);
+
+            /////////////////////////////////////////////////
+            /// \brief Creates a widget of the specified type
+            ///
+            /// \param fitToText: set to 'true' if the widget must be sized by its text after loading
+            ///
+            /////////////////////////////////////////////////
+            bool createWidget(const std::string_view type, const std::string_view name, const std::vector <Property>& properties, bool& fitToText);
+
+            /////////////////////////////////////////////////
+            /// \brief Applies one property to the widget
+            ///
+            /// \param fitToText: set to 'true' if the widget must be sized by its text after loading
+            ///
+            /////////////////////////////////////////////////
+            bool applyProperty(Widget& widget, const Property& property, bool& fitToText) const;
+
+            /////////////////////////////////////////////////
+            /// \brief Helpers to convert values
+            ///
+            /// \return 'false' if the value has incorrect format
+            ///
+            /////////////////////////////////////////////////
+            static bool parseFloat(const std::string_view value, float& result);
+            static bool parseUnsigned(const std::string_view value, unsigned int& result);
+            static bool parseBool(const std::string_view value, bool& result);
+            static bool parseVector(const std::string_view value, sf::Vector2f& result);
+            static bool parseRect(const std::string_view value, sf::IntRect& result);
+            static bool parseColor(const std::string_view value, sf::Color& result);
+            static bool parseTextStyle(const std::string_view value, sf::Uint32& result);
+            static bool parseHorizontalAlignment(const std::string_view value, TextHorizontalAlignment& result);
+            static bool parseVerticalAlignment(const std::string_view value, TextVerticalAlignment& result);
+            static sf::String parseString(const std::string_view value);
     };
 }   // namespace SmallGui
 
@@ -1,5 +1,11 @@
 #include "SmallSfmlGui.hpp"
 
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <iterator>
+
 namespace SmallGui
 {
 
@@ -89,10 +95,14 @@ TextSettings::TextSettings(const sf::Font& font,
                            const TextHorizontalAlignment horizontalAlignment,
                            const TextVerticalAlignment verticalAlignment) :
     m_font(&font),
+    m_distanceFieldFont(nullptr),
+    m_fontHash(0),
     m_characterSize(characterSize),
     m_horizontalAlignment(horizontalAlignment),
     m_verticalAlignment(verticalAlignment),
-    m_fontMetrics(calculateFontMetrics())
+    m_fontMetrics(),
+    m_fontMetricsNeedUpdate(true),
+    m_prewarmedGlyphCount{0, 0}
 {
     //ctor
 }
@@ -124,19 +134,141 @@ TextVerticalAlignment TextSettings::getVerticalAlignment() const
 
 const FontMetrics& TextSettings::getFontMetrics() const
 {
+    if (m_fontMetricsNeedUpdate)
+    {
+        m_fontMetrics = calculateFontMetrics();
+        m_fontMetricsNeedUpdate = false;
+    }
+
     return m_fontMetrics;
 }
 
+void TextSettings::refreshFontMetrics() const
+{
+    m_fontMetricsNeedUpdate = true;
+
+    // Glyphs made before the font was loaded are empty
+    m_prewarmedGlyphCount[0] = 0;
+    m_prewarmedGlyphCount[1] = 0;
+}
+
+const DistanceFieldFont* TextSettings::getDistanceFieldFont() const
+{
+    return m_distanceFieldFont;
+}
+
+unsigned int TextSettings::getGlyphCharacterSize() const
+{
+    if (m_distanceFieldFont == nullptr)
+        return m_characterSize;
+
+    return m_distanceFieldFont->getBaseCharacterSize();
+}
+
+float TextSettings::getGlyphScale() const
+{
+    return static_cast <float>(m_characterSize) / getGlyphCharacterSize();
+}
+
 void TextSettings::setFont(const sf::Font& font)
 {
     m_font = &font;
-    m_fontMetrics = calculateFontMetrics();
+    m_distanceFieldFont = nullptr;
+    m_fontHash = 0;
+    m_fontMetricsNeedUpdate = true;
+    resetPrewarmedGlyphs();
+}
+
+void TextSettings::setDistanceFieldFont(const DistanceFieldFont& font)
+{
+    m_font = &(font.getFont());
+    m_distanceFieldFont = &font;
+    m_fontHash = 0;
+    m_fontMetricsNeedUpdate = true;
+    resetPrewarmedGlyphs();
+}
+
+void TextSettings::setFontHash(const sf::Uint64 hash)
+{
+    m_fontHash = hash;
+}
+
+sf::Uint64 TextSettings::getFontHash() const
+{
+    return m_fontHash;
+}
+
+void TextSettings::addGlyphs(const sf::String& characters)
+{
+    std::vector <sf::Uint32> newCharacters(characters.begin(), characters.end());
+    std::sort(newCharacters.begin(), newCharacters.end());
+    newCharacters.erase(std::unique(newCharacters.begin(), newCharacters.end()), newCharacters.end());
+
+    // Declared characters are skipped, so they are not made again. The new ones are appended, so glyphs that are ready stay at the beginning
+    std::vector <sf::Uint32> declaredCharacters(m_glyphRepertoire);
+    std::sort(declaredCharacters.begin(), declaredCharacters.end());
+
+    std::set_difference(newCharacters.begin(), newCharacters.end(), declaredCharacters.begin(), declaredCharacters.end(),
+                        std::back_inserter(m_glyphRepertoire));
+}
+
+void TextSettings::addGlyphRange(const sf::Uint32 first, const sf::Uint32 last)
+{
+    sf::String characters;
+
+    for (auto codePoint = first; codePoint <= last && codePoint >= first; codePoint++)
+        characters += codePoint;
+
+    addGlyphs(characters);
+}
+
+bool TextSettings::prewarmGlyphs(const bool isBold, const sf::Time timeLimit) const
+{
+    // Glyphs are made in portions to check the clock not too often
+    const size_t portionSize = 32;
+
+    sf::Clock clock;
+    auto& prewarmedCount = m_prewarmedGlyphCount[isBold ? 1 : 0];
+
+    while (prewarmedCount < m_glyphRepertoire.size())
+    {
+        const auto portionEnd = std::min(prewarmedCount + portionSize, m_glyphRepertoire.size());
+
+        if (m_distanceFieldFont != nullptr)
+        {
+            const sf::String portion(std::basic_string <sf::Uint32>(m_glyphRepertoire.begin() + prewarmedCount,
+                                                                    m_glyphRepertoire.begin() + portionEnd));
+            m_distanceFieldFont->loadGlyphs(portion, isBold);
+        }
+        else
+        {
+            for (auto i = prewarmedCount; i < portionEnd; i++)
+                m_font->getGlyph(m_glyphRepertoire[i], m_characterSize, isBold);
+        }
+
+        prewarmedCount = portionEnd;
+
+        if (timeLimit != sf::Time::Zero && clock.getElapsedTime() >= timeLimit)
+            break;
+    }
+
+    return prewarmedCount == m_glyphRepertoire.size();
+}
+
+void TextSettings::resetPrewarmedGlyphs()
+{
+    m_prewarmedGlyphCount[0] = 0;
+    m_prewarmedGlyphCount[1] = 0;
 }
 
 void TextSettings::setCharacterSize(const unsigned int characterSize)
 {
     m_characterSize = characterSize;
-    m_fontMetrics = calculateFontMetrics();
+    m_fontMetricsNeedUpdate = true;
+
+    // Glyphs of the distance field font do not depend on the size
+    if (m_distanceFieldFont == nullptr)
+        resetPrewarmedGlyphs();
 }
 
 void TextSettings::setHorizontalAlignment(const TextHorizontalAlignment horizontalAlignment)
@@ -149,13 +281,14 @@ void TextSettings::setVerticalAlignment(const TextVerticalAlignment verticalAlig
     m_verticalAlignment = verticalAlignment;
 }
 
-FontMetrics TextSettings::calculateFontMetrics()
+FontMetrics TextSettings::calculateFontMetrics() const
 {
     FontMetrics metrics;
 
     sf::Text temp;
     temp.setFont(*m_font);
-    temp.setCharacterSize(m_characterSize);
+    temp.setCharacterSize(getGlyphCharacterSize());
+    temp.setScale(getGlyphScale(), getGlyphScale());
 
     // Just some magic to apply vertical alignment correctly
     // (some fonts may have it a little incorrect)
@@ -163,13 +296,13 @@ FontMetrics TextSettings::calculateFontMetrics()
     // We calculate the highest line and the line which all letters stand on.
     // We use "A" as the standard
     temp.setString(L"A");
-    metrics.ascenderLine = temp.getLocalBounds().top;
-    metrics.baseLine = temp.getLocalBounds().height;
+    metrics.ascenderLine = temp.getLocalBounds().top * temp.getScale().y;
+    metrics.baseLine = temp.getLocalBounds().height * temp.getScale().y;
 
     // We calculate the lowest line of letters and, at last, maximum possible height
     // We use "j" as the standard
     temp.setString(L"j");
-    metrics.descenderLine = temp.getLocalBounds().height - metrics.baseLine;
+    metrics.descenderLine = temp.getLocalBounds().height * temp.getScale().y - metrics.baseLine;
     metrics.fullHeight = metrics.ascenderLine + metrics.baseLine + metrics.descenderLine;
 
     return metrics;
@@ -182,7 +315,8 @@ Theme::Theme(const TextSettings& textSettings,
     m_textSettings(textSettings),
     m_idleColorSettings(idleColorSettings),
     m_hoverColorSettings(hoverColorSettings),
-    m_pressColorSettings(pressColorSettings)
+    m_pressColorSettings(pressColorSettings),
+    m_transitionDuration(sf::Time::Zero)
 {
     //ctor
 }
@@ -212,1158 +346,7157 @@ const DecorationSettings& Theme::getPressedColorSettings() const
     return m_pressColorSettings;
 }
 
-WidgetPool::WidgetPool() :
-    m_window(nullptr),
-    m_activeWidget(nullptr),
-    m_lastHoveredWidget(nullptr),
-    m_lastClickedWidget(nullptr)
+sf::Time Theme::getTransitionDuration() const
 {
-    //ctor
+    return m_transitionDuration;
 }
 
-WidgetPool::~WidgetPool()
+void Theme::setTransitionDuration(const sf::Time duration)
 {
-    //dtor
+    m_transitionDuration = duration;
 }
 
-WidgetPool& WidgetPool::getInstance()
+bool Theme::prewarmGlyphs(const sf::Time timeLimit) const
 {
-    static WidgetPool instance;
-    return instance;
+    sf::Clock clock;
+    bool isStyleUsed[2] = { false, false };     // Regular and bold
+
+    for (const auto decorationSettings : { &m_idleColorSettings, &m_hoverColorSettings, &m_pressColorSettings })
+        isStyleUsed[(decorationSettings->getTextStyle() & sf::Text::Style::Bold) ? 1 : 0] = true;
+
+    for (const bool isBold : { false, true })
+    {
+        if (!isStyleUsed[isBold ? 1 : 0])
+            continue;
+
+        // Zero would mean no limit, so the rest of the time must be positive
+        const auto elapsedTime = clock.getElapsedTime();
+        if (timeLimit != sf::Time::Zero && elapsedTime >= timeLimit)
+            return false;
+
+        if (!m_textSettings.prewarmGlyphs(isBold, timeLimit == sf::Time::Zero ? timeLimit : timeLimit - elapsedTime))
+            return false;
+    }
+
+    return true;
 }
 
-void WidgetPool::initialize(const sf::RenderWindow* window)
+TextureAtlas::TextureAtlas(const unsigned int pageSize, const unsigned int spacing) :
+    m_pageSize(pageSize),
+    m_spacing(spacing)
 {
-    m_window = window;
+    //ctor
 }
 
-void WidgetPool::addWidget(Widget* widget)
+TextureAtlas::~TextureAtlas()
 {
-    m_widgets.push_back(widget);
+    //dtor
 }
 
-void WidgetPool::processEvent(const sf::Event event)
+const TextureAtlas::Region* TextureAtlas::add(const std::string& name, const sf::Image& image)
 {
-    const auto position = m_window->mapPixelToCoords((sf::Mouse::getPosition(*m_window)));
-    m_activeWidget = getActiveWidget(position);
+    const auto imageSize = image.getSize();
 
-    // Process events
-    if (m_activeWidget != nullptr)
-        m_activeWidget->processEvent(event, position);
+    if (m_regions.find(name) != m_regions.end())
+    {
+        sf::err() << "Failed to add image \"" << name << "\" to texture atlas (name is already taken)" << std::endl;
+        return nullptr;
+    }
 
-    if (m_lastClickedWidget != nullptr && m_lastClickedWidget != m_activeWidget)
-        m_lastClickedWidget->processEvent(event, position);
+    if (imageSize.x == 0 || imageSize.y == 0 || imageSize.x > m_pageSize || imageSize.y > m_pageSize)
+    {
+        sf::err() << "Failed to add image \"" << name << "\" to texture atlas (image is empty or larger than a page)" << std::endl;
+        return nullptr;
+    }
 
-    if (m_lastHoveredWidget != nullptr && m_lastHoveredWidget != m_activeWidget && m_lastHoveredWidget != m_lastClickedWidget)
-        m_lastHoveredWidget->processEvent(event, position);
+    // Spacing is not needed at the edges of the page
+    const auto width = std::min(imageSize.x + m_spacing, m_pageSize);
+    const auto height = std::min(imageSize.y + m_spacing, m_pageSize);
 
-    if (event.type == sf::Event::MouseButtonReleased)
-        m_lastClickedWidget = m_activeWidget;
+    size_t segmentIndex = 0;
+    auto page = std::find_if(m_pages.begin(), m_pages.end(), [&](const Page& page)
+    {
+        return findPlace(page, width, height, segmentIndex);
+    });
 
-    m_lastHoveredWidget = m_activeWidget;
-}
+    if (page == m_pages.end())
+    {
+        // The page is cleared to keep spacing transparent
+        sf::Image blankImage;
+        blankImage.create(m_pageSize, m_pageSize, sf::Color::Transparent);
 
-void WidgetPool::forceThemeUpdate() const
-{
-    for (const auto& widget : m_widgets)
-        widget->refreshTheme();
-}
+        page = m_pages.emplace(m_pages.end());
+        if (!page->texture.loadFromImage(blankImage))
+        {
+            m_pages.erase(page);
+            return nullptr;
+        }
 
-Widget* WidgetPool::getActiveWidget(const sf::Vector2f& mousePosition) const
-{
-    auto isSelected = [&mousePosition](Widget* w) { return !w->isHidden() && w->getGlobalBounds().contains(mousePosition); };
+        page->skyline.push_back({0, 0, m_pageSize});
+        segmentIndex = 0;
+    }
 
-    // Widgets can be drawn upon each other (it should not be made by the user intentionally)
-    // Anyway, the later we draw them, the bigger index they have
-    // We need to select the top widget
-    auto it = std::find_if(std::reverse_iterator(m_widgets.cend()), std::reverse_iterator(m_widgets.cbegin()), isSelected);
-    return it != std::reverse_iterator(m_widgets.cbegin()) ? *it : nullptr;
-}
+    const auto x = page->skyline[segmentIndex].x;
+    const auto y = getSkylineHeight(*page, segmentIndex, width);
 
-void WidgetPool::draw(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    for (const auto& widget : m_widgets)
-    {
-        if (!widget->isHidden())
-            target.draw(*widget);
-    }
-}
+    raiseSkyline(*page, segmentIndex, width, height);
+    page->texture.update(image, x, y);
 
-Widget::Widget() : m_theme(nullptr), m_state(WidgetState::Idle), m_contentNeedsUpdate(true)
-{
-    auto& ui = WidgetPool::getInstance();
-    ui.addWidget(this);
+    const Region region = {&(page->texture), sf::IntRect(x, y, imageSize.x, imageSize.y)};
+    return &(m_regions.emplace(name, region).first->second);
 }
 
-Widget::~Widget()
+const TextureAtlas::Region* TextureAtlas::addFromFile(const std::string& name, const std::string& fileName)
 {
-    // dtor
-}
+    sf::Image image;
+    if (!image.loadFromFile(fileName))
+        return nullptr;
 
-void Widget::setPosition(const sf::Vector2f& position)
-{
-    m_rectangle.setPosition(position);
-    m_contentNeedsUpdate = true;
+    return add(name, image);
 }
 
-void Widget::setSize(const sf::Vector2f& size)
+const TextureAtlas::Region* TextureAtlas::getRegion(std::string_view name) const
 {
-    m_rectangle.setSize(size);
-    m_contentNeedsUpdate = true;
+    const auto region = m_regions.find(name);
+    return region != m_regions.end() ? &(region->second) : nullptr;
 }
 
-void Widget::setTheme(const Theme& theme)
+size_t TextureAtlas::getPageCount() const
 {
-    m_theme = &theme;
-    m_contentNeedsUpdate = true;
+    return m_pages.size();
 }
 
-void Widget::setBackgroundTextureRect(const sf::IntRect& rectangle)
+bool TextureAtlas::findPlace(const Page& page, const unsigned int width, const unsigned int height, size_t& segmentIndex) const
 {
-    m_rectangle.setTextureRect(rectangle);
-}
+    auto bestHeight = m_pageSize;
 
-void Widget::setAction(const sf::Event::EventType eventType, const std::function <void()> doAction)
-{
-    m_doAction[eventType] = doAction;
+    for (size_t i = 0; i < page.skyline.size(); i++)
+    {
+        const auto skylineHeight = getSkylineHeight(page, i, width);
+
+        if (skylineHeight + height <= m_pageSize && skylineHeight < bestHeight)
+        {
+            bestHeight = skylineHeight;
+            segmentIndex = i;
+        }
+    }
+
+    return bestHeight < m_pageSize;
 }
 
-sf::Vector2f Widget::getPosition() const
+unsigned int TextureAtlas::getSkylineHeight(const Page& page, const size_t segmentIndex, const unsigned int width) const
 {
-    return m_rectangle.getPosition();
+    if (page.skyline[segmentIndex].x + width > m_pageSize)
+        return m_pageSize;
+
+    unsigned int height = 0;
+    auto remainingWidth = width;
+
+    // Segments cover the whole width of the page, so the index never goes out of range
+    for (auto i = segmentIndex; remainingWidth > 0; i++)
+    {
+        height = std::max(height, page.skyline[i].y);
+
+        if (page.skyline[i].width >= remainingWidth)
+            break;
+
+        remainingWidth -= page.skyline[i].width;
+    }
+
+    return height;
 }
 
-sf::Vector2f Widget::getSize() const
+void TextureAtlas::raiseSkyline(Page& page, const size_t segmentIndex, const unsigned int width, const unsigned int height)
 {
-    return m_rectangle.getSize();
+    auto& skyline = page.skyline;
+    const SkylineSegment raisedSegment = {skyline[segmentIndex].x, getSkylineHeight(page, segmentIndex, width) + height, width};
+
+    // Segments under the rectangle are removed, the last one may be cut
+    auto remainingWidth = width;
+    while (remainingWidth > 0)
+    {
+        auto& segment = skyline[segmentIndex];
+
+        if (segment.width > remainingWidth)
+        {
+            segment.x += remainingWidth;
+            segment.width -= remainingWidth;
+            break;
+        }
+
+        remainingWidth -= segment.width;
+        skyline.erase(skyline.begin() + segmentIndex);
+    }
+
+    skyline.insert(skyline.begin() + segmentIndex, raisedSegment);
+
+    // Neighbours of the same height are merged to keep the skyline short
+    for (size_t i = segmentIndex > 0 ? segmentIndex - 1 : 0; i + 1 < skyline.size() && i <= segmentIndex; )
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
 }
 
-const Theme& Widget::getTheme() const
+namespace
 {
-    return *m_theme;
-}
 
-sf::IntRect Widget::getBackgroundTextureRect() const
+/////////////////////////////////////////////////
+/// \brief Appends two triangles of a glyph placed at the pen position.
+/// Shared by every widget building its text from vertices
+///
+/// \param vertices: where to append the vertices, their primitive type must be triangles
+/// \param bounds: bounds of the glyph relative to the pen position
+/// \param textureRect: the glyph on its texture
+/// \param position: the pen position on the baseline
+/// \param color: color of the glyph
+/// \param italicShear: horizontal shift per unit of height, 0 for upright glyphs
+/// \param transform: transform applied to the corners
+///
+/////////////////////////////////////////////////
+void appendGlyphQuad(sf::VertexArray& vertices,
+                     const sf::FloatRect& bounds,
+                     const sf::IntRect& textureRect,
+                     const sf::Vector2f position,
+                     const sf::Color color,
+                     const float italicShear = 0.0f,
+                     const sf::Transform& transform = sf::Transform::Identity)
 {
-    return m_rectangle.getTextureRect();
+    const float left = position.x + bounds.left;
+    const float top = position.y + bounds.top;
+    const float right = left + bounds.width;
+    const float bottom = top + bounds.height;
+
+    // The shear is relative to the baseline
+    const float topShift = italicShear * bounds.top;
+    const float bottomShift = italicShear * (bounds.top + bounds.height);
+
+    const float u1 = static_cast <float>(textureRect.left);
+    const float v1 = static_cast <float>(textureRect.top);
+    const float u2 = static_cast <float>(textureRect.left + textureRect.width);
+    const float v2 = static_cast <float>(textureRect.top + textureRect.height);
+
+    const sf::Vertex corners[] =
+    {
+        sf::Vertex(transform.transformPoint(left - topShift, top), color, sf::Vector2f(u1, v1)),
+        sf::Vertex(transform.transformPoint(right - topShift, top), color, sf::Vector2f(u2, v1)),
+        sf::Vertex(transform.transformPoint(left - bottomShift, bottom), color, sf::Vector2f(u1, v2)),
+        sf::Vertex(transform.transformPoint(right - bottomShift, bottom), color, sf::Vector2f(u2, v2))
+    };
+
+    for (const auto index : { 0, 1, 2, 2, 1, 3 })
+        vertices.append(corners[index]);
 }
 
-sf::FloatRect Widget::getLocalBounds() const
-{
-    return m_rectangle.getLocalBounds();
 }
 
-sf::FloatRect Widget::getGlobalBounds() const
+DistanceFieldFont::DistanceFieldFont(const sf::Font& font, const unsigned int baseCharacterSize, const unsigned int spread) :
+    m_font(&font),
+    m_baseCharacterSize(baseCharacterSize),
+    m_spread(spread),
+    m_atlas(1024, 1),
+    m_isShaderLoaded(false)
 {
-    return m_rectangle.getGlobalBounds();
+    // The edge is where the distance is 0.5, it is smoothed over one pixel of the screen
+    const std::string fragmentShader =
+        "uniform sampler2D texture;"
+        "void main()"
+        "{"
+        "    float distance = texture2D(texture, gl_TexCoord[0].xy).a;"
+        "    float smoothing = fwidth(distance) * 0.5;"
+        "    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);"
+        "    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * alpha);"
+        "}";
+
+    if (sf::Shader::isAvailable() && m_shader.loadFromMemory(fragmentShader, sf::Shader::Fragment))
+    {
+        m_shader.setUniform("texture", sf::Shader::CurrentTexture);
+        m_isShaderLoaded = true;
+    }
 }
 
-void Widget::show()
+DistanceFieldFont::~DistanceFieldFont()
 {
-    m_state = WidgetState::Idle;
-    m_contentNeedsUpdate = true;
+    //dtor
 }
 
-void Widget::hide()
+const sf::Font& DistanceFieldFont::getFont() const
 {
-    m_state = WidgetState::Hidden;
+    return *m_font;
 }
 
-bool Widget::isHidden() const
+unsigned int DistanceFieldFont::getBaseCharacterSize() const
 {
-    return m_state == WidgetState::Hidden;
+    return m_baseCharacterSize;
 }
 
-void Widget::forceThemeUpdate() const
+const sf::Shader* DistanceFieldFont::getShader() const
 {
-    m_contentNeedsUpdate = true;
+    return m_isShaderLoaded ? &m_shader : nullptr;
 }
 
-void Widget::refreshTheme() const
+void DistanceFieldFont::appendText(const sf::Text& text, VertexBatches& batches) const
 {
-    if (m_theme == nullptr)
-        return;
+    const auto& string = text.getString();
+    const bool isBold = (text.getStyle() & sf::Text::Bold) != 0;
+    const float italicShear = (text.getStyle() & sf::Text::Italic) ? 0.209f : 0.0f;     // 12 degrees as in sf::Text
+    const auto transform = text.getTransform();
+    const auto color = text.getFillColor();
 
-    refreshRectangleTheme();
-}
+    loadGlyphs(string, isBold);
 
-void Widget::refreshRectangleTheme() const
-{
-    const DecorationSettings* decorationSettings = nullptr;
+    // Glyphs are placed the same way as sf::Text does
+    const float whitespaceWidth = m_font->getGlyph(L' ', m_baseCharacterSize, isBold).advance;
+    const float lineSpacing = m_font->getLineSpacing(m_baseCharacterSize);
 
-    switch (m_state)
+    float x = 0.0f;
+    float y = static_cast <float>(m_baseCharacterSize);
+    sf::Uint32 previousCodePoint = 0;
+
+    for (const auto codePoint : string)
     {
-        case WidgetState::Idle:
-            decorationSettings = &(m_theme->getIdleColorSettings());
-            break;
+        x += m_font->getKerning(previousCodePoint, codePoint, m_baseCharacterSize);
+        previousCodePoint = codePoint;
 
-        case WidgetState::Hovered:
-            decorationSettings = &(m_theme->getHoveredColorSettings());
-            break;
+        switch (codePoint)
+        {
+            case L' ':
+                x += whitespaceWidth;
+                continue;
+
+            case L'\t':
+                x += whitespaceWidth * 4;
+                continue;
+
+            case L'\n':
+                x = 0.0f;
+                y += lineSpacing;
+                continue;
+        }
 
-        case WidgetState::Pressed:
-            decorationSettings = &(m_theme->getPressedColorSettings());
-            break;
+        const auto key = codePoint | (static_cast <sf::Uint64>(isBold) << 32);
+        const auto& glyph = m_glyphs.at(key);
 
-        default:
-            return;
-    }
+        if (glyph.texture != nullptr)
+        {
+            auto& vertices = batches[glyph.texture];
+            vertices.setPrimitiveType(sf::Triangles);
 
-    m_rectangle.setFillColor(decorationSettings->getFillColor());
-    m_rectangle.setOutlineThickness(decorationSettings->getOutlineThickness());
-    m_rectangle.setOutlineColor(decorationSettings->getOutlineColor());
-    m_rectangle.setTexture(decorationSettings->getBackgroundTexture());
-}
+            appendGlyphQuad(vertices, glyph.bounds, glyph.textureRect, sf::Vector2f(x, y), color, italicShear, transform);
+        }
 
-void Widget::changeState(const WidgetState state)
-{
-    m_state = state;
-    refreshTheme();
+        x += glyph.advance;
+    }
 }
 
-void Widget::draw(sf::RenderTarget& target, sf::RenderStates states) const
+void DistanceFieldFont::loadGlyphs(const sf::String& string, const bool isBold) const
 {
-    drawRectangle(target, states);
-}
+    std::vector <sf::Uint32> missingCodePoints;
 
-void Widget::drawRectangle(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    target.draw(m_rectangle);
-}
+    for (const auto codePoint : string)
+    {
+        const auto key = codePoint | (static_cast <sf::Uint64>(isBold) << 32);
 
-void Widget::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
-{
-    if (m_state == WidgetState::Hidden)
-        return;
+        if (m_glyphs.find(key) == m_glyphs.end() &&
+            std::find(missingCodePoints.begin(), missingCodePoints.end(), codePoint) == missingCodePoints.end())
+            missingCodePoints.push_back(codePoint);
+    }
 
-    if (!m_rectangle.getGlobalBounds().contains(mousePosition))
-    {
-        changeState(WidgetState::Idle);
+    if (missingCodePoints.empty())
         return;
-    }
 
-    switch (event.type)
-    {
-        case sf::Event::MouseLeft:
-        {
-            changeState(WidgetState::Idle);
+    // All glyphs are rasterized first, so the texture of the font is copied only once
+    for (const auto codePoint : missingCodePoints)
+        m_font->getGlyph(codePoint, m_baseCharacterSize, isBold);
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+    const auto fontImage = m_font->getTexture(m_baseCharacterSize).copyToImage();
+    const auto spread = static_cast <float>(m_spread);
 
-            break;
-        }
+    for (const auto codePoint : missingCodePoints)
+    {
+        const auto key = codePoint | (static_cast <sf::Uint64>(isBold) << 32);
+        const auto& fontGlyph = m_font->getGlyph(codePoint, m_baseCharacterSize, isBold);
 
-        case sf::Event::MouseButtonPressed:
+        Glyph glyph = { fontGlyph.advance, fontGlyph.bounds, nullptr, sf::IntRect() };
+
+        if (fontGlyph.textureRect.width > 0 && fontGlyph.textureRect.height > 0)
         {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+            const auto region = m_atlas.add(std::to_string(key), makeDistanceField(fontImage, fontGlyph.textureRect, m_spread));
 
-            changeState(WidgetState::Pressed);
+            if (region != nullptr)
+            {
+                glyph.bounds = sf::FloatRect(fontGlyph.bounds.left - spread, fontGlyph.bounds.top - spread,
+                                             fontGlyph.bounds.width + 2 * spread, fontGlyph.bounds.height + 2 * spread);
+                glyph.texture = region->texture;
+                glyph.textureRect = region->textureRect;
+            }
+        }
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        m_glyphs.emplace(key, glyph);
+    }
+}
 
-            break;
-        }
+sf::Image DistanceFieldFont::makeDistanceField(const sf::Image& image, const sf::IntRect& area, const unsigned int spread)
+{
+    const int radius = static_cast <int>(spread);
+    const int width = area.width + 2 * radius;
+    const int height = area.height + 2 * radius;
 
-        case sf::Event::MouseButtonReleased:
-        {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+    std::vector <bool> isInside(width * height, false);
 
-            changeState(WidgetState::Hovered);
-
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+    for (int y = 0; y < area.height; y++)
+    {
+        for (int x = 0; x < area.width; x++)
+            isInside[(y + radius) * width + x + radius] = image.getPixel(area.left + x, area.top + y).a > 127;
+    }
 
-            break;
-        }
+    sf::Image field;
+    field.create(width, height, sf::Color::Transparent);
 
-        case sf::Event::MouseMoved:
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
         {
-            if (m_state == WidgetState::Idle)
-                changeState(WidgetState::Hovered);
-
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+            const bool isPixelInside = isInside[y * width + x];
+            float distance = static_cast <float>(radius);
 
-            break;
-        }
+            // The nearest pixel on the other side of the edge is searched around
+            for (int dy = std::max(-radius, -y); dy <= std::min(radius, height - 1 - y); dy++)
+            {
+                for (int dx = std::max(-radius, -x); dx <= std::min(radius, width - 1 - x); dx++)
+                {
+                    if (isInside[(y + dy) * width + x + dx] != isPixelInside)
+                        distance = std::min(distance, std::sqrt(static_cast <float>(dx * dx + dy * dy)) - 0.5f);
+                }
+            }
 
-        default:
-        {
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+            const auto signedDistance = isPixelInside ? distance : -distance;
+            const auto value = std::max(0.0f, std::min(1.0f, 0.5f + signedDistance / (2 * radius)));
 
-            break;
+            field.setPixel(x, y, sf::Color(255, 255, 255, static_cast <sf::Uint8>(value * 255)));
         }
     }
-}
 
-const sf::String TextBasedWidget::m_wordSeparators = L" \n\t";
+    return field;
+}
 
-TextBasedWidget::TextBasedWidget() : Widget(), m_padding(5.0f, 10.0f), m_isMultiline(false), m_isTrimmable(true)
+ShapedRunCache::ShapedRunCache(const size_t capacity) : m_capacity(capacity), m_hitCount(0), m_missCount(0)
 {
     //ctor
 }
 
-TextBasedWidget::~TextBasedWidget()
+ShapedRunCache::~ShapedRunCache()
 {
     //dtor
 }
 
-void TextBasedWidget::setSizeFitToText()
+const ShapedRunCache::ShapedRun& ShapedRunCache::getRun(const sf::String& string, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style)
 {
-    updateTextSplitting();
-    refreshTheme();
-
-    float width = m_padding.x * 2;
+    return getRun(string, 0, string.getSize(), font, characterSize, style);
+}
 
-    const auto longestLine = std::max_element(m_lines.cbegin(), m_lines.cend(), [](const sf::Text& a, const sf::Text& b)
+const ShapedRunCache::ShapedRun& ShapedRunCache::getRun(const sf::String& string, const size_t position, const size_t length,
+                                                        const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style)
+{
+    // The key keeps its storage, so only new runs allocate memory. Underlines do not change bounds
+    const auto begin = string.begin() + position;
+    m_lookupKey.string.assign(begin, begin + length);
+    m_lookupKey.font = &font;
+    m_lookupKey.characterSize = characterSize;
+    m_lookupKey.style = style & (sf::Text::Bold | sf::Text::Italic);
+
+    const auto& key = m_lookupKey;
+    const auto found = m_index.find(key);
+    if (found != m_index.end())
     {
-        return (a.getLocalBounds().left + a.getLocalBounds().width) < (b.getLocalBounds().left + b.getLocalBounds().width);
-    });
+        m_hitCount++;
+        m_runs.splice(m_runs.begin(), m_runs, found->second);
+        return found->second->second;
+    }
 
-    if (longestLine != m_lines.cend())
-        width += (longestLine->getLocalBounds().left + longestLine->getLocalBounds().width);
+    m_missCount++;
 
-    float height = m_padding.y * 2;
-    height += m_theme->getTextSettings().getFontMetrics().fullHeight * m_lines.size();
+    if (m_capacity == 0)
+    {
+        m_uncachedRun = shape(key);
+        return m_uncachedRun;
+    }
 
-    setSize({ width, height });
-    placeText();
+    if (m_runs.size() >= m_capacity)
+    {
+        m_index.erase(m_runs.back().first);
+        m_runs.pop_back();
+    }
 
-    m_contentNeedsUpdate = false;
+    auto run = shape(key);
+    m_runs.emplace_front(key, std::move(run));
+    m_index.emplace(m_runs.front().first, m_runs.begin());
+
+    return m_runs.front().second;
 }
 
-void TextBasedWidget::setString(const sf::String& text)
+void ShapedRunCache::clear()
 {
-    m_string = text;
-    m_contentNeedsUpdate = true;
+    m_index.clear();
+    m_runs.clear();
 }
 
-void TextBasedWidget::setPadding(const sf::Vector2f& padding)
+void ShapedRunCache::setCapacity(const size_t capacity)
 {
-    m_padding = padding;
-    m_contentNeedsUpdate = true;
+    m_capacity = capacity;
+
+    while (m_runs.size() > m_capacity)
+    {
+        m_index.erase(m_runs.back().first);
+        m_runs.pop_back();
+    }
 }
 
-void TextBasedWidget::setMultilined(bool isMultiline)
+size_t ShapedRunCache::getCapacity() const
 {
-    m_isMultiline = isMultiline;
-    m_contentNeedsUpdate = true;
+    return m_capacity;
 }
 
-void TextBasedWidget::setPosition(const sf::Vector2f& position)
+size_t ShapedRunCache::getSize() const
 {
-    m_rectangle.setPosition(position);
-    m_contentNeedsUpdate = true;
+    return m_runs.size();
 }
 
-void TextBasedWidget::refreshTheme() const
+size_t ShapedRunCache::getHitCount() const
 {
-    if (m_theme == nullptr)
-        return;
-
-    refreshRectangleTheme();
-    refreshTextTheme();
-
-    m_contentNeedsUpdate = true;
+    return m_hitCount;
 }
 
-void TextBasedWidget::refreshTextTheme() const
+size_t ShapedRunCache::getMissCount() const
 {
-    const auto& textSettings = m_theme->getTextSettings();
-    const DecorationSettings* decorationSettings = nullptr;
-
-    switch (m_state)
-    {
-        case WidgetState::Idle:
-            decorationSettings = &(m_theme->getIdleColorSettings());
-            break;
-
-        case WidgetState::Hovered:
-            decorationSettings = &(m_theme->getHoveredColorSettings());
-            break;
-
-        case WidgetState::Pressed:
-            decorationSettings = &(m_theme->getPressedColorSettings());
-            break;
-
-        default:
-            return;
-    }
+    return m_missCount;
+}
 
-    for (auto& line : m_lines)
-    {
-        line.setFont(textSettings.getFont());
-        line.setCharacterSize(textSettings.getCharacterSize());
-        line.setFillColor(decorationSettings->getTextColor());
-        line.setStyle(decorationSettings->getTextStyle());
-    }
+bool ShapedRunCache::Key::operator==(const Key& other) const
+{
+    return font == other.font && characterSize == other.characterSize && style == other.style && string == other.string;
 }
 
-sf::String TextBasedWidget::getString() const
+size_t ShapedRunCache::KeyHash::operator()(const Key& key) const
 {
-    return m_string;
+    auto hash = LayoutSnapshot::hash(key.string.data(), key.string.size() * sizeof(sf::Uint32));
+    hash = LayoutSnapshot::hash(&key.font, sizeof(key.font), hash);
+    hash = LayoutSnapshot::hash(&key.characterSize, sizeof(key.characterSize), hash);
+    hash = LayoutSnapshot::hash(&key.style, sizeof(key.style), hash);
+
+    return static_cast <size_t>(hash);
 }
 
-bool TextBasedWidget::isMultiline() const
+void ShapedRunCache::measure(const sf::String& string, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style, ShapedRun& run)
 {
-    return m_isMultiline;
+    const auto begin = string.getData();
+    shape(begin, begin + string.getSize(), font, characterSize, style, run);
 }
 
-size_t TextBasedWidget::findFirstWordSeparatorPosition(size_t begin) const
+ShapedRunCache::ShapedRun ShapedRunCache::shape(const Key& key)
 {
-    for (; begin < m_string.getSize(); begin++)
-    {
-        for (size_t i = 0; i < m_wordSeparators.getSize(); i++)
-        {
-            if (m_string[begin] == m_wordSeparators[i])
-                return begin;
-        }
-    }
+    ShapedRun run;
+    const auto begin = key.string.data();
+    shape(begin, begin + key.string.size(), *key.font, key.characterSize, key.style, run);
 
-    return sf::String::InvalidPos;
+    return run;
 }
 
-sf::String TextBasedWidget::trimLine(const sf::String& line) const
+void ShapedRunCache::shape(const sf::Uint32* begin, const sf::Uint32* end, const sf::Font& font, const unsigned int characterSize, const sf::Uint32 style, ShapedRun& run)
 {
-    auto result = line;
+    // Grows geometrically, so a run measured again after each typed character does not allocate every time
+    const auto length = static_cast <size_t>(end - begin);
+    run.positions.clear();
+    if (run.positions.capacity() < length)
+        run.positions.reserve(std::max(length, run.positions.capacity() * 2));
+    run.advance = 0.0f;
+    run.bounds = sf::FloatRect();
+
+    if (begin == end)
+        return;
 
-    // Trim the left
-    for (size_t trimLeft = 0; trimLeft < result.getSize(); trimLeft++)
+    // The same algorithm as in sf::Text, so the bounds are exactly the same
+    const auto size = characterSize;
+    const bool isBold = (style & sf::Text::Bold) != 0;
+    const auto italicShear = (style & sf::Text::Italic) ? 0.209f : 0.0f;
+    const auto whitespaceWidth = font.getGlyph(U' ', size, isBold).advance;
+    const auto lineSpacing = font.getLineSpacing(size);
+
+    float x = 0.0f;
+    float y = static_cast <float>(size);
+    float minX = static_cast <float>(size);
+    float minY = static_cast <float>(size);
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    sf::Uint32 previousCharacter = 0;
+
+    for (auto i = begin; i < end; i++)
     {
-        if (std::find(m_wordSeparators.begin(), m_wordSeparators.end(), result[trimLeft]) == m_wordSeparators.end())
+        const auto character = *i;
+
+        // sf::Text skips carriage returns entirely, even the kerning
+        if (character == U'\r')
         {
-            result = result.substring(trimLeft);
-            break;
+            run.positions.push_back(x);
+            continue;
         }
-    }
 
-    // Trim the right
-    for (size_t trimRightPlusOne = result.getSize(); trimRightPlusOne > 0; trimRightPlusOne--)
-    {
-        size_t trimRight = trimRightPlusOne - 1;
+        x += font.getKerning(previousCharacter, character, size);
+        previousCharacter = character;
+        run.positions.push_back(x);
 
-        if (std::find(m_wordSeparators.begin(), m_wordSeparators.end(), result[trimRight]) == m_wordSeparators.end())
+        if (character == U' ' || character == U'\n' || character == U'\t')
         {
-            result = result.substring(0, trimRight + 1);
-            break;
-        }
-    }
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
 
-    return result;
-}
+            if (character == U' ')
+                x += whitespaceWidth;
+            else if (character == U'\t')
+                x += whitespaceWidth * 4;
+            else
+            {
+                y += lineSpacing;
+                x = 0.0f;
+            }
 
-void TextBasedWidget::updateTextSplitting() const
-{
-    m_lines.clear();
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+            continue;
+        }
 
-    if (!m_isMultiline)
-    {
-        const auto line = (m_isTrimmable ? trimLine(m_string) : m_string);
+        const auto& glyph = font.getGlyph(character, size, isBold);
+        const auto left = glyph.bounds.left;
+        const auto top = glyph.bounds.top;
+        const auto right = glyph.bounds.left + glyph.bounds.width;
+        const auto bottom = glyph.bounds.top + glyph.bounds.height;
 
-        m_lines.emplace_back();
-        m_lines.back().setString(line);
+        minX = std::min(minX, x + left - italicShear * bottom);
+        maxX = std::max(maxX, x + right - italicShear * top);
+        minY = std::min(minY, y + top);
+        maxY = std::max(maxY, y + bottom);
 
-        return;
+        x += glyph.advance;
     }
 
-    const auto maxWidth = m_rectangle.getSize().x - 2 * m_padding.x;
+    run.advance = x;
+    run.bounds = sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
 
-    const auto& textSettings = m_theme->getTextSettings();
-    sf::Text textLine;
-    textLine.setFont(textSettings.getFont());
-    textLine.setCharacterSize(textSettings.getCharacterSize());
+ScratchArena::ScratchArena(const size_t blockSize) :
+    m_blockSize(std::max <size_t>(blockSize, 1)),
+    m_currentBlock(0),
+    m_offset(0),
+    m_allocationCount(0)
+{
+    //ctor
+}
 
-    std::vector <sf::String> words;
-    std::vector <sf::Uint32> separators;
+ScratchArena::~ScratchArena()
+{
+    //dtor
+}
 
-    for (size_t beginPosition = 0, endPosition = 0; beginPosition < m_string.getSize();)
+void ScratchArena::reset()
+{
+    // One block of the total size fits the same layout next time without jumping between blocks
+    if (m_blocks.size() > 1)
     {
-        sf::String word;
-        endPosition = findFirstWordSeparatorPosition(beginPosition);
-
-        if (endPosition == sf::String::InvalidPos)
-        {
-            word = m_string.substring(beginPosition);
-            endPosition = m_string.getSize();
-        }
-        else
-        {
-            word = m_string.substring(beginPosition, endPosition - beginPosition);
-            separators.push_back(m_string[endPosition]);
-        }
-
-        // Split very long words that do not fit the rectangle at all
-        textLine.setString(word);
+        const auto size = getReservedSize();
 
-        if (textLine.getLocalBounds().left + textLine.getLocalBounds().width > maxWidth)
-        {
-            word.clear();
-            textLine.setString(word);
+        m_blocks.clear();
+        m_blocks.push_back({ std::make_unique <unsigned char[]>(size), size });
+        m_allocationCount++;
+    }
 
-            for (; beginPosition < endPosition; beginPosition++)
-            {
-                word += m_string[beginPosition];
-                textLine.setString(word);
+    m_currentBlock = 0;
+    m_offset = 0;
+}
 
-                if (textLine.getLocalBounds().left + textLine.getLocalBounds().width > maxWidth)
-                {
-                    word.erase(word.getSize() - 1, 1);
-                    break;
-                }
-            }
+size_t ScratchArena::getAllocationCount() const
+{
+    return m_allocationCount;
+}
 
-            separators.push_back('\n');
-        }
-        else
-            beginPosition = endPosition + 1;
+size_t ScratchArena::getReservedSize() const
+{
+    size_t size = 0;
 
-        words.push_back(word);
-    }
+    for (const auto& block : m_blocks)
+        size += block.size;
 
-    sf::String line;
-    bool isLineReady = false;
+    return size;
+}
 
-    for (size_t i = 0; i < words.size();)
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment)
+{
+    for (;; m_currentBlock++, m_offset = 0)
     {
-        line += words[i];
-        textLine.setString(line);
-
-        if (textLine.getLocalBounds().left + textLine.getLocalBounds().width > maxWidth)
-        {
-            line = line.substring(0, line.getSize() - words[i].getSize());
-            isLineReady = true;
-        }
-        else if (i + 1 == words.size())
+        if (m_currentBlock == m_blocks.size())
         {
-            if (i < separators.size() && separators[i] != '\n')
-                line += sf::String(separators[i]);
-
-            isLineReady = true;
-            i++;
+            const auto size = std::max(m_blockSize, bytes + alignment);
+            m_blocks.push_back({ std::make_unique <unsigned char[]>(size), size });
+            m_allocationCount++;
         }
-        else
-        {
-            if (separators[i] == '\n')
-                isLineReady = true;
-            else
-                line += sf::String(separators[i]);
 
-            i++;
-        }
+        auto& block = m_blocks[m_currentBlock];
+        const auto address = reinterpret_cast <std::uintptr_t>(block.data.get());
+        const auto alignedOffset = ((address + m_offset + alignment - 1) & ~(alignment - 1)) - address;
 
-        if (isLineReady)
+        if (alignedOffset + bytes <= block.size)
         {
-            if (m_isTrimmable)
-                line = trimLine(line);
-
-            m_lines.emplace_back();
-            m_lines.back().setString(line);
-
-            line.clear();
-            isLineReady = false;
+            m_offset = alignedOffset + bytes;
+            return block.data.get() + alignedOffset;
         }
     }
 }
 
-void TextBasedWidget::placeText() const
+void ScratchArena::do_deallocate(void* pointer, size_t bytes, size_t alignment)
 {
-    const auto position = m_rectangle.getPosition();
-    const auto size = m_rectangle.getSize();
+    // Memory is freed by resetting
+    static_cast <void>(pointer);
+    static_cast <void>(bytes);
+    static_cast <void>(alignment);
+}
 
-    const auto& textSettings = m_theme->getTextSettings();
-    const auto horizontalAlignment = textSettings.getHorizontalAlignment();
-    const auto verticalAlignment = textSettings.getVerticalAlignment();
-    const auto& metrics = textSettings.getFontMetrics();
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
 
-    sf::Vector2f textPosition;
+ResourceLoader::ResourceLoader(const unsigned int workerCount) : m_pendingCount(0), m_isStopping(false)
+{
+    for (unsigned int i = 0; i < std::max(workerCount, 1u); i++)
+        m_workers.emplace_back(&ResourceLoader::runWorker, this);
+}
 
-    for (size_t i = 0; i < m_lines.size(); i++)
+ResourceLoader::~ResourceLoader()
+{
     {
-        switch (horizontalAlignment)
-        {
-            case TextHorizontalAlignment::Left:
-                textPosition.x = position.x + m_padding.x;
-                break;
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_isStopping = true;
+        m_jobs.clear();
+    }
 
-            case TextHorizontalAlignment::Center:
-                textPosition.x = position.x + (size.x - m_lines[i].getLocalBounds().width) / 2.0f - m_lines[i].getLocalBounds().left;
-                break;
+    m_jobAdded.notify_all();
 
-            case TextHorizontalAlignment::Right:
-                textPosition.x = position.x + size.x - m_padding.x - m_lines[i].getLocalBounds().left - m_lines[i].getLocalBounds().width;
-                break;
-        }
+    for (auto& worker : m_workers)
+        worker.join();
+}
 
-        switch (verticalAlignment)
-        {
-            case TextVerticalAlignment::Top:
-                textPosition.y = position.y + m_padding.y + i * metrics.fullHeight;
-                break;
+const sf::Font& ResourceLoader::loadFont(const std::string& fileName)
+{
+    const auto found = m_fonts.find(fileName);
+    if (found != m_fonts.end())
+        return found->second.font;
 
-            case TextVerticalAlignment::Center:
-                textPosition.y = position.y + (size.y - m_lines.size() * metrics.fullHeight - metrics.ascenderLine + metrics.descenderLine) / 2.0f + i * metrics.fullHeight;
-                break;
+    auto& entry = m_fonts[fileName];
+    m_pendingCount++;
 
-            case TextVerticalAlignment::Bottom:
-                textPosition.y = position.y + size.y - m_padding.y - (m_lines.size() - i) * metrics.fullHeight - metrics.ascenderLine + metrics.descenderLine;
-                break;
-        }
+    addJob([this, &entry, fileName]()
+    {
+        std::ifstream fin(fileName, std::ios::binary);
+        std::vector <char> data((std::istreambuf_iterator <char>(fin)), std::istreambuf_iterator <char>());
+        const bool isRead = fin.is_open() && !data.empty();
+        const auto hash = LayoutSnapshot::hash(data.data(), data.size());
+
+        // sf::Font is not thread-safe, so it is created on the main thread from the data
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_finishers.push_back([&entry, fileName, isRead, hash, data = std::move(data)]() mutable
+        {
+            if (!isRead)
+            {
+                sf::err() << "Failed to load font \"" << fileName << "\" (failed to read the file)" << std::endl;
+                return;
+            }
 
-        // If coordinates are not integer, the text gets blurred
-        textPosition.x = std::round(textPosition.x);
-        textPosition.y = std::round(textPosition.y);
-        m_lines[i].setPosition(textPosition);
-    }
+            entry.data = std::move(data);
+            entry.hash = hash;
+            entry.font.loadFromMemory(entry.data.data(), entry.data.size());
+        });
+    });
+
+    return entry.font;
 }
 
-void TextBasedWidget::drawText(sf::RenderTarget& target, sf::RenderStates states) const
+const sf::Texture& ResourceLoader::loadTexture(const std::string& fileName)
 {
-    // Clip text
-    auto bounds = m_rectangle.getGlobalBounds();
-    bounds.left += m_padding.x;
-    bounds.top += m_padding.y;
-    bounds.width -= m_padding.x * 2;
-    bounds.height -= m_padding.y * 2;
+    const auto found = m_textures.find(fileName);
+    if (found != m_textures.end())
+        return found->second;
 
-    const auto size = target.mapPixelToCoords(static_cast <sf::Vector2i>(target.getSize()));
-    sf::View view(bounds);
-    view.setViewport(sf::FloatRect(bounds.left / size.x, bounds.top / size.y,
-                                   bounds.width / size.x, bounds.height / size.y));
+    auto& texture = m_textures[fileName];
+    m_pendingCount++;
 
-    const auto oldView = target.getView();
-    target.setView(view);
+    addJob([this, &texture, fileName]()
+    {
+        sf::Image image;
+        const bool isDecoded = image.loadFromFile(fileName);
 
-    for (const auto& line : m_lines)
-        target.draw(line);
+        // Textures are OpenGL resources, so the image is uploaded on the main thread
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_finishers.push_back([&texture, isDecoded, image = std::move(image)]()
+        {
+            if (isDecoded)
+                texture.loadFromImage(image);
+        });
+    });
 
-    target.setView(oldView);
+    return texture;
 }
 
-void TextBasedWidget::draw(sf::RenderTarget& target, sf::RenderStates states) const
+size_t ResourceLoader::update()
 {
-    if (m_state == WidgetState::Hidden)
-        return;
+    std::vector <std::function <void()>> finishers;
 
-    if (m_contentNeedsUpdate)
     {
-        updateTextSplitting();
-        refreshTheme();
-        placeText();
-        m_contentNeedsUpdate = false;
+        std::lock_guard <std::mutex> lock(m_mutex);
+        finishers.swap(m_finishers);
     }
 
-    drawRectangle(target, states);
-    drawText(target, states);
-}
+    for (const auto& finish : finishers)
+        finish();
 
-PushButton::PushButton() : TextBasedWidget()
-{
-    //ctor
+    m_pendingCount -= finishers.size();
+
+    // Text is laid out once more with the real fonts
+    if (!finishers.empty())
+        WidgetPool::getInstance().forceThemeUpdate();
+
+    return finishers.size();
 }
 
-PushButton::~PushButton()
+size_t ResourceLoader::getPendingCount() const
 {
-    //dtor
+    return m_pendingCount;
 }
 
-IconButton::IconButton() : Widget()
+sf::Uint64 ResourceLoader::getFontHash(const std::string& fileName) const
 {
-    //ctor
+    const auto found = m_fonts.find(fileName);
+    return (found != m_fonts.end() ? found->second.hash : 0);
 }
 
-IconButton::~IconButton()
+void ResourceLoader::runWorker()
 {
-    //dtor
-}
+    while (true)
+    {
+        std::function <void()> job;
 
-void IconButton::setPosition(const sf::Vector2f& position)
-{
-    m_rectangle.setPosition(position);
-    m_icon.setPosition(position);
-    m_contentNeedsUpdate = true;
-}
+        {
+            std::unique_lock <std::mutex> lock(m_mutex);
+            m_jobAdded.wait(lock, [this]() { return m_isStopping || !m_jobs.empty(); });
 
-void IconButton::setSize(const sf::Vector2f& size)
-{
-    m_rectangle.setSize(size);
+            if (m_isStopping)
+                return;
 
-    // Icon resize is delayed because we cannot ensure that the programmer use methods in the right order
-    m_contentNeedsUpdate = true;
-}
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
 
-void IconButton::setIconTexture(const sf::Texture& texture)
-{
-    m_icon.setTexture(texture);
-    m_contentNeedsUpdate = true;
+        job();
+    }
 }
 
-void IconButton::setIconTextureRect(const sf::IntRect& rectangle)
+void ResourceLoader::addJob(std::function <void()> job)
 {
-    m_icon.setTextureRect(rectangle);
-    m_contentNeedsUpdate = true;
+    {
+        std::lock_guard <std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+
+    m_jobAdded.notify_one();
 }
 
-const sf::Texture* IconButton::getIconTexture() const
+LayoutSnapshot::LayoutSnapshot() : m_recordBegin(0), m_readPosition(0), m_recordEnd(0)
 {
-    return m_icon.getTexture();
+    clear();
 }
 
-sf::IntRect IconButton::getIconTextureRect() const
+LayoutSnapshot::~LayoutSnapshot()
 {
-    return m_icon.getTextureRect();
+    //dtor
 }
 
-void IconButton::updateSpriteSize() const
+bool LayoutSnapshot::loadFromFile(const std::string& fileName)
 {
-    const auto bounds = m_icon.getLocalBounds();
-    const auto size = m_rectangle.getSize();
-
-    sf::Vector2f factor;
+    std::ifstream fin(fileName, std::ios::binary);
+    if (!fin)
+    {
+        sf::err() << "Failed to open layout snapshot \"" << fileName << "\"" << std::endl;
+        return false;
+    }
 
-    factor.x = size.x / (bounds.width + bounds.left);
-    factor.y = size.y / (bounds.height + bounds.top);
+    // The snapshot is read at once, records are parsed right from the memory
+    fin.seekg(0, std::ios::end);
+    m_data.resize(static_cast <size_t>(fin.tellg()));
+    fin.seekg(0, std::ios::beg);
+    fin.read(m_data.data(), m_data.size());
 
-    m_icon.setScale(factor);
-}
+    m_readPosition = 0;
+    m_recordEnd = m_data.size();
 
-void IconButton::draw(sf::RenderTarget& target, sf::RenderStates states) const
-{
-    if (m_state == WidgetState::Hidden)
-        return;
+    sf::Uint32 magic = 0;
+    sf::Uint32 version = 0;
 
-    if (m_contentNeedsUpdate)
+    // Also fails on the files made on machines with another byte order
+    if (!read(magic) || magic != Magic || !read(version) || version != Version)
     {
-        refreshTheme();
-        updateSpriteSize();
+        sf::err() << "Failed to load layout snapshot \"" << fileName << "\" (incompatible format or version)" << std::endl;
+        clear();
+        return false;
     }
 
-    target.draw(m_rectangle);
-    target.draw(m_icon);
+    return true;
 }
 
-DropDownList::DropDownList() : TextBasedWidget(), m_isOpened(false)
+bool LayoutSnapshot::saveToFile(const std::string& fileName) const
 {
-    //ctor
-}
+    std::ofstream fout(fileName, std::ios::binary);
+    if (!fout.write(m_data.data(), m_data.size()))
+    {
+        sf::err() << "Failed to save layout snapshot \"" << fileName << "\"" << std::endl;
+        return false;
+    }
 
-DropDownList::~DropDownList()
-{
-    //dtor
+    return true;
 }
 
-void DropDownList::addListItem(const sf::String& label, const std::function <void()> doAction)
+void LayoutSnapshot::clear()
 {
-    const auto x = getPosition().x;
-    const auto y = (m_items.empty() ?
-                    getGlobalBounds().top + getGlobalBounds().height :
-                    m_items.back().getGlobalBounds().top + m_items.back().getGlobalBounds().height);
+    m_data.clear();
+    write(Magic);
+    write(Version);
 
-    m_items.emplace_back();
+    m_readPosition = m_data.size();
+    m_recordEnd = m_data.size();
+}
 
-    m_items.back().setString(label);
-    m_items.back().setAction(sf::Event::MouseButtonReleased, doAction);
-    m_items.back().setTheme(*m_itemsTheme);
-    m_items.back().setPadding(m_padding);
-    m_items.back().setPosition({x, y});
-    m_items.back().setSizeFitToText();
+void LayoutSnapshot::writeString(const sf::String& string)
+{
+    const auto bytes = reinterpret_cast <const char*>(string.getData());
 
-    const auto longestItem = max_element(m_items.cbegin(), m_items.cend(), [](const PushButton& a, const PushButton& b)
-    {
-        return a.getSize().x < b.getSize().x;
-    });
+    write(static_cast <sf::Uint32>(string.getSize()));
+    m_data.insert(m_data.end(), bytes, bytes + string.getSize() * sizeof(sf::Uint32));
+}
 
-    const auto width = longestItem->getSize().x;
-    const auto height = longestItem->getSize().y;
+bool LayoutSnapshot::readString(sf::String& string)
+{
+    sf::Uint32 length = 0;
+    if (!read(length) || m_readPosition + length * sizeof(sf::Uint32) > m_recordEnd)
+        return false;
 
-    for (auto& item : m_items)
-        item.setSize({width, height});
+    // Data may be unaligned, so it is copied instead of reinterpreting
+    std::basic_string <sf::Uint32> characters(length, 0);
+    std::memcpy(&characters[0], m_data.data() + m_readPosition, length * sizeof(sf::Uint32));
+    m_readPosition += length * sizeof(sf::Uint32);
 
-    m_items.back().hide();
+    string = characters;
+    return true;
 }
 
-void DropDownList::showItems()
+void LayoutSnapshot::beginRecord()
 {
-    for (auto& item : m_items)
-        item.show();
-    m_isOpened = true;
+    m_recordBegin = m_data.size();
+    write(sf::Uint32(0));
 }
 
-void DropDownList::hideItems()
+void LayoutSnapshot::endRecord()
 {
-    for (auto& item : m_items)
-        item.hide();
-    m_isOpened = false;
+    const auto size = static_cast <sf::Uint32>(m_data.size() - m_recordBegin - sizeof(sf::Uint32));
+    std::memcpy(m_data.data() + m_recordBegin, &size, sizeof(size));
 }
 
-void DropDownList::setItemsTheme(const Theme& theme)
+bool LayoutSnapshot::openRecord()
 {
-    m_itemsTheme = &theme;
-    for (auto& item : m_items)
-        item.setTheme(theme);
+    sf::Uint32 size = 0;
+    if (!read(size) || m_readPosition + size > m_data.size())
+        return false;
+
+    m_recordEnd = m_readPosition + size;
+    return true;
 }
 
-void DropDownList::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+void LayoutSnapshot::closeRecord()
 {
-    if (m_state == WidgetState::Hidden)
-        return;
+    m_readPosition = m_recordEnd;
+    m_recordEnd = m_data.size();
+}
 
-    const auto isMouseInside = m_rectangle.getGlobalBounds().contains(mousePosition);
+sf::Uint64 LayoutSnapshot::hash(const void* data, const size_t size, sf::Uint64 hash)
+{
+    const auto bytes = static_cast <const unsigned char*>(data);
 
-    switch (event.type)
+    for (size_t i = 0; i < size; i++)
     {
-        case sf::Event::MouseLeft:
-        {
-            if (m_state != WidgetState::Pressed)
-                changeState(WidgetState::Idle);
-
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
 
-            break;
-        }
+    return hash;
+}
 
-        case sf::Event::MouseButtonPressed:
-        {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+sf::Uint64 LayoutSnapshot::hashFile(const std::string& fileName)
+{
+    std::ifstream fin(fileName, std::ios::binary);
+    if (!fin)
+    {
+        sf::err() << "Failed to hash file \"" << fileName << "\"" << std::endl;
+        return 0;
+    }
 
-            if (isMouseInside && m_state != WidgetState::Pressed)
-                changeState(WidgetState::Pressed);
+    // Fonts may be large, so the file is hashed in parts
+    char buffer[4096];
+    auto hashValue = hash(nullptr, 0);
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+    while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0)
+        hashValue = hash(buffer, static_cast <size_t>(fin.gcount()), hashValue);
 
-            break;
-        }
+    return hashValue;
+}
 
-        case sf::Event::MouseButtonReleased:
-        {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+PlainRectangle::PlainRectangle() :
+    m_texture(nullptr),
+    m_fillColor(sf::Color::White),
+    m_outlineColor(sf::Color::White),
+    m_outlineThickness(0.0f)
+{
+    //ctor
+}
 
-            if (isMouseInside)
-            {
-                if (m_state == WidgetState::Pressed)
-                {
-                    if (m_isOpened)
-                    {
-                        changeState(WidgetState::Hovered);
-                        hideItems();
-                    }
-                    else
-                        showItems();
-                }
-            }
-            else
-            {
-                changeState(WidgetState::Idle);
-                if (m_isOpened)
-                    hideItems();
-            }
+void PlainRectangle::setPosition(const sf::Vector2f& position)
+{
+    m_position = position;
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void PlainRectangle::setSize(const sf::Vector2f& size)
+{
+    m_size = size;
+}
 
-            break;
-        }
+void PlainRectangle::setTexture(const sf::Texture* texture)
+{
+    // The same as sf::RectangleShape does, so a texture set without a rectangle is shown entirely
+    if (texture != nullptr && m_texture == nullptr && m_textureRect == sf::IntRect())
+        m_textureRect = sf::IntRect(sf::Vector2i(0, 0), static_cast <sf::Vector2i>(texture->getSize()));
 
-        case sf::Event::MouseMoved:
-        {
-            if (m_state == WidgetState::Hovered)
-            {
-                if (!isMouseInside)
-                    changeState(WidgetState::Idle);
-            }
-            else if (m_state == WidgetState::Idle)
-            {
-                if (isMouseInside)
-                    changeState(WidgetState::Hovered);
-            }
-            else if (m_state == WidgetState::Pressed)
-            {
-                if (!isMouseInside && !m_isOpened)
-                    changeState(WidgetState::Idle);
-            }
+    m_texture = texture;
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void PlainRectangle::setTextureRect(const sf::IntRect& rectangle)
+{
+    m_textureRect = rectangle;
+}
 
-            break;
-        }
+void PlainRectangle::setFillColor(const sf::Color& color)
+{
+    m_fillColor = color;
+}
 
-        default:
-        {
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void PlainRectangle::setOutlineColor(const sf::Color& color)
+{
+    m_outlineColor = color;
+}
 
-            break;
-        }
-    }
+void PlainRectangle::setOutlineThickness(const float thickness)
+{
+    m_outlineThickness = thickness;
 }
 
-TextBox::TextBox() : TextBasedWidget(), m_maxInputLength(sf::String::InvalidPos)
+const sf::Vector2f& PlainRectangle::getPosition() const
 {
-    m_isTrimmable = false;
+    return m_position;
 }
 
-TextBox::~TextBox()
+const sf::Vector2f& PlainRectangle::getSize() const
 {
-    //dtor
+    return m_size;
 }
 
-size_t TextBox::getMaxInputLength() const
+const sf::Texture* PlainRectangle::getTexture() const
 {
-    return m_maxInputLength;
+    return m_texture;
 }
 
-void TextBox::setMaxInputLength(const size_t maxInputLength)
+const sf::IntRect& PlainRectangle::getTextureRect() const
 {
-    m_maxInputLength = maxInputLength;
+    return m_textureRect;
 }
 
-void TextBox::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+const sf::Color& PlainRectangle::getFillColor() const
 {
-    if (m_state == WidgetState::Hidden)
-        return;
+    return m_fillColor;
+}
 
-    const auto isMouseInside = m_rectangle.getGlobalBounds().contains(mousePosition);
+const sf::Color& PlainRectangle::getOutlineColor() const
+{
+    return m_outlineColor;
+}
 
-    switch (event.type)
-    {
-        case sf::Event::MouseLeft:
-        {
-            if (m_state != WidgetState::Pressed)
-                changeState(WidgetState::Idle);
+float PlainRectangle::getOutlineThickness() const
+{
+    return m_outlineThickness;
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+sf::FloatRect PlainRectangle::getLocalBounds() const
+{
+    // An outline drawn inside does not change the bounds
+    const auto outline = std::max(0.0f, m_outlineThickness);
+    return sf::FloatRect(-outline, -outline, m_size.x + 2.0f * outline, m_size.y + 2.0f * outline);
+}
 
-            break;
-        }
+sf::FloatRect PlainRectangle::getGlobalBounds() const
+{
+    auto bounds = getLocalBounds();
+    bounds.left += m_position.x;
+    bounds.top += m_position.y;
+    return bounds;
+}
 
-        case sf::Event::MouseButtonPressed:
-        {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+DrawSink::~DrawSink()
+{
+    //dtor
+}
 
-            if (isMouseInside && m_state != WidgetState::Pressed)
-                changeState(WidgetState::Pressed);
+void DrawSink::drawRectangle(const sf::RectangleShape& rectangle, const sf::RenderStates& states)
+{
+    // The shape may be rotated or scaled, so its whole transform is applied to a rectangle at the origin
+    PlainRectangle plainRectangle;
+    plainRectangle.setSize(rectangle.getSize());
+    plainRectangle.setTextureRect(rectangle.getTextureRect());
+    plainRectangle.setTexture(rectangle.getTexture());
+    plainRectangle.setFillColor(rectangle.getFillColor());
+    plainRectangle.setOutlineColor(rectangle.getOutlineColor());
+    plainRectangle.setOutlineThickness(rectangle.getOutlineThickness());
+
+    auto shapeStates = states;
+    shapeStates.transform *= rectangle.getTransform();
+    drawRectangle(plainRectangle, shapeStates);
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void DrawSink::drawRectangle(const PlainRectangle& rectangle, const sf::RenderStates& states)
+{
+    const auto size = rectangle.getSize();
+    auto shapeStates = states;
+    shapeStates.transform.translate(rectangle.getPosition());
 
-            break;
-        }
+    // Transparent parts are not drawn at all, so borderless and invisible backgrounds cost no draw calls
+    const auto& fillColor = rectangle.getFillColor();
 
-        case sf::Event::MouseButtonReleased:
+    if (fillColor.a > 0)
+    {
+        const auto textureRect = static_cast <sf::FloatRect>(rectangle.getTextureRect());
+        const sf::Vertex vertices[] =
         {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
-
-            if (!isMouseInside)
-                changeState(WidgetState::Idle);
+            sf::Vertex({0.0f, 0.0f}, fillColor, {textureRect.left, textureRect.top}),
+            sf::Vertex({size.x, 0.0f}, fillColor, {textureRect.left + textureRect.width, textureRect.top}),
+            sf::Vertex({0.0f, size.y}, fillColor, {textureRect.left, textureRect.top + textureRect.height}),
+            sf::Vertex({size.x, size.y}, fillColor, {textureRect.left + textureRect.width, textureRect.top + textureRect.height})
+        };
+
+        auto fillStates = shapeStates;
+        fillStates.texture = rectangle.getTexture();
+        drawVertices(vertices, 4, sf::TriangleStrip, fillStates);
+    }
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+    const auto thickness = rectangle.getOutlineThickness();
+    const auto& outlineColor = rectangle.getOutlineColor();
 
-            break;
-        }
+    if (thickness != 0.0f && outlineColor.a > 0)
+    {
+        // Each corner is joined with the same corner moved outwards, the first pair is repeated to close the strip
+        const sf::Vector2f corners[] = { {0.0f, 0.0f}, {size.x, 0.0f}, {size.x, size.y}, {0.0f, size.y} };
+        const sf::Vector2f directions[] = { {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f} };
+        sf::Vertex vertices[10];
 
-        case sf::Event::MouseMoved:
+        for (size_t i = 0; i < 5; i++)
         {
-            if (m_state == WidgetState::Hovered)
-            {
-                if (!isMouseInside)
-                    changeState(WidgetState::Idle);
-            }
-            else if (m_state == WidgetState::Idle)
-            {
-                if (isMouseInside)
-                    changeState(WidgetState::Hovered);
-            }
+            vertices[i * 2] = sf::Vertex(corners[i % 4], outlineColor);
+            vertices[i * 2 + 1] = sf::Vertex(corners[i % 4] + directions[i % 4] * thickness, outlineColor);
+        }
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        auto outlineStates = shapeStates;
+        outlineStates.texture = nullptr;
+        drawVertices(vertices, 10, sf::TriangleStrip, outlineStates);
+    }
+}
 
-            break;
-        }
+void DrawSink::drawSprite(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+    if (sprite.getTexture() == nullptr)
+        return;
 
-        case sf::Event::TextEntered:
-        {
-            if (m_state != WidgetState::Pressed)
-                break;
+    const auto textureRect = static_cast <sf::FloatRect>(sprite.getTextureRect());
+    const auto width = std::abs(textureRect.width);
+    const auto height = std::abs(textureRect.height);
+    const auto& color = sprite.getColor();
 
-            // Process backspace
-            if (event.text.unicode == '\b')
-            {
-                if (!m_string.isEmpty())
-                    m_string.erase(m_string.getSize() - 1);
-            }
-            else if (m_string.getSize() < m_maxInputLength)
-            {
-                if (event.text.unicode != '\r')
-                    m_string += event.text.unicode;
-                else
-                    m_string += '\n';
-            }
+    const sf::Vertex vertices[] =
+    {
+        sf::Vertex({0.0f, 0.0f}, color, {textureRect.left, textureRect.top}),
+        sf::Vertex({width, 0.0f}, color, {textureRect.left + textureRect.width, textureRect.top}),
+        sf::Vertex({0.0f, height}, color, {textureRect.left, textureRect.top + textureRect.height}),
+        sf::Vertex({width, height}, color, {textureRect.left + textureRect.width, textureRect.top + textureRect.height})
+    };
+
+    auto spriteStates = states;
+    spriteStates.transform *= sprite.getTransform();
+    spriteStates.texture = sprite.getTexture();
+    drawVertices(vertices, 4, sf::TriangleStrip, spriteStates);
+}
 
-            m_contentNeedsUpdate = true;
+void DrawSink::drawVertices(const sf::VertexArray& vertices, const sf::RenderStates& states)
+{
+    if (vertices.getVertexCount() > 0)
+        drawVertices(&vertices[0], vertices.getVertexCount(), vertices.getPrimitiveType(), states);
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+RenderTargetSink::RenderTargetSink(sf::RenderTarget& target) : m_target(target)
+{
+    //ctor
+}
 
-            break;
-        }
+RenderTargetSink::~RenderTargetSink()
+{
+    //dtor
+}
 
-        default:
-        {
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void RenderTargetSink::drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states)
+{
+    m_target.draw(vertices, count, type, states);
+}
 
-            break;
-        }
-    }
+void RenderTargetSink::drawGlyphRun(const sf::Text& text, const sf::RenderStates& states)
+{
+    m_target.draw(text, states);
 }
 
-CheckBox::CheckBox() : TextBasedWidget(), m_isChecked(false)
+void RenderTargetSink::setView(const sf::View& view)
 {
-    // Set the default checkmark
-    m_string = L"X";
+    m_target.setView(view);
 }
 
-CheckBox::~CheckBox()
+const sf::View& RenderTargetSink::getView() const
 {
-    //dtor
+    return m_target.getView();
 }
 
-bool CheckBox::isChecked() const
+BatchingSink::BatchingSink(DrawSink& sink, std::vector <sf::Vertex>& vertices) :
+    m_sink(sink),
+    m_vertices(vertices),
+    m_texture(nullptr)
 {
-    return m_isChecked;
+    m_vertices.clear();
 }
 
-void CheckBox::setChecked(const bool isChecked)
+BatchingSink::~BatchingSink()
 {
-    m_isChecked = isChecked;
+    flush();
 }
 
-void CheckBox::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+void BatchingSink::drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states)
 {
-    if (m_state == WidgetState::Hidden)
-        return;
+    // Shaders may depend on the transform, and large arrays are cheaper to draw than to copy
+    const bool isJoinable = (type == sf::Triangles || type == sf::TriangleStrip || type == sf::TriangleFan) &&
+                            states.shader == nullptr && count >= 3 && count <= MaxBatchedCount;
 
-    if (!m_rectangle.getGlobalBounds().contains(mousePosition))
+    if (!isJoinable)
     {
-        changeState(WidgetState::Idle);
+        flush();
+        m_sink.drawVertices(vertices, count, type, states);
         return;
     }
 
-    switch (event.type)
+    if (!m_vertices.empty() && (states.texture != m_texture || !(states.blendMode == m_blendMode)))
+        flush();
+
+    m_texture = states.texture;
+    m_blendMode = states.blendMode;
+
+    const auto append = [this, vertices, &states](const size_t index)
     {
-        case sf::Event::MouseLeft:
+        auto vertex = vertices[index];
+        vertex.position = states.transform.transformPoint(vertex.position);
+        m_vertices.push_back(vertex);
+    };
+
+    // Everything is turned into separate triangles, so primitives can follow each other
+    switch (type)
+    {
+        case sf::TriangleStrip:
+            for (size_t i = 2; i < count; i++)
+            {
+                append(i - 2);
+                append(i - 1);
+                append(i);
+            }
+            break;
+
+        case sf::TriangleFan:
+            for (size_t i = 2; i < count; i++)
+            {
+                append(0);
+                append(i - 1);
+                append(i);
+            }
+            break;
+
+        default:
+            for (size_t i = 0; i < count - count % 3; i++)
+                append(i);
+            break;
+    }
+}
+
+void BatchingSink::drawGlyphRun(const sf::Text& text, const sf::RenderStates& states)
+{
+    flush();
+    m_sink.drawGlyphRun(text, states);
+}
+
+void BatchingSink::setView(const sf::View& view)
+{
+    flush();
+    m_sink.setView(view);
+}
+
+const sf::View& BatchingSink::getView() const
+{
+    return m_sink.getView();
+}
+
+void BatchingSink::flush()
+{
+    if (m_vertices.empty())
+        return;
+
+    const sf::RenderStates states(m_blendMode, sf::Transform::Identity, m_texture, nullptr);
+    m_sink.drawVertices(m_vertices.data(), m_vertices.size(), sf::Triangles, states);
+
+    m_vertices.clear();
+}
+
+DrawRecorder::DrawRecorder(const sf::Vector2u& size) :
+    m_defaultView(sf::FloatRect(0.0f, 0.0f, static_cast <float>(size.x), static_cast <float>(size.y))),
+    m_view(m_defaultView),
+    m_boundTexture(nullptr),
+    m_boundPage(0)
+{
+    //ctor
+}
+
+DrawRecorder::~DrawRecorder()
+{
+    //dtor
+}
+
+void DrawRecorder::drawVertices(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type, const sf::RenderStates& states)
+{
+    if (count == 0)
+        return;
+
+    bindTexture(states.texture, 0);
+
+    m_commands.push_back({CommandType::Vertices, type, m_vertices.size(), count, states});
+    m_vertices.insert(m_vertices.end(), vertices, vertices + count);
+}
+
+void DrawRecorder::drawGlyphRun(const sf::Text& text, const sf::RenderStates& states)
+{
+    if (text.getFont() == nullptr || text.getString().isEmpty())
+        return;
+
+    // Glyphs of one size are kept on the same page of the font texture
+    bindTexture(text.getFont(), text.getCharacterSize());
+
+    auto runStates = states;
+    runStates.transform *= text.getTransform();
+
+    m_commands.push_back({CommandType::GlyphRun, sf::Triangles, m_glyphRuns.size(), 0, runStates});
+    m_glyphRuns.push_back({text.getString(), text.getFont(), text.getCharacterSize(), text.getStyle(),
+                           text.getFillColor(), text.getOutlineColor(), text.getOutlineThickness()});
+}
+
+void DrawRecorder::setView(const sf::View& view)
+{
+    m_view = view;
+
+    m_commands.push_back({CommandType::Clip, sf::Points, m_views.size(), 0, sf::RenderStates::Default});
+    m_views.push_back(view);
+}
+
+const sf::View& DrawRecorder::getView() const
+{
+    return m_view;
+}
+
+void DrawRecorder::clear()
+{
+    m_commands.clear();
+    m_vertices.clear();
+    m_glyphRuns.clear();
+    m_views.clear();
+    m_view = m_defaultView;
+    m_boundTexture = nullptr;
+    m_boundPage = 0;
+}
+
+const std::vector <DrawRecorder::Command>& DrawRecorder::getCommands() const
+{
+    return m_commands;
+}
+
+const std::vector <sf::Vertex>& DrawRecorder::getVertices() const
+{
+    return m_vertices;
+}
+
+const std::vector <DrawRecorder::GlyphRun>& DrawRecorder::getGlyphRuns() const
+{
+    return m_glyphRuns;
+}
+
+size_t DrawRecorder::getCommandCount(const CommandType type) const
+{
+    return static_cast <size_t>(std::count_if(m_commands.begin(), m_commands.end(), [type](const Command& command)
+    {
+        return command.type == type;
+    }));
+}
+
+size_t DrawRecorder::getVertexCount() const
+{
+    return m_vertices.size();
+}
+
+sf::Uint64 DrawRecorder::getHash() const
+{
+    sf::Uint64 hash = LayoutSnapshot::hash(nullptr, 0);
+
+    for (size_t i = 0; i < m_commands.size(); i++)
+        hash = hashCommand(i, hash);
+
+    return hash;
+}
+
+size_t DrawRecorder::findFirstDifference(const DrawRecorder& other) const
+{
+    const auto count = std::min(m_commands.size(), other.m_commands.size());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (hashCommand(i, LayoutSnapshot::hash(nullptr, 0)) != other.hashCommand(i, LayoutSnapshot::hash(nullptr, 0)))
+            return i;
+    }
+
+    return count;
+}
+
+void DrawRecorder::replay(DrawSink& sink) const
+{
+    for (const auto& command : m_commands)
+    {
+        switch (command.type)
         {
-            if (m_state != WidgetState::Pressed)
-                changeState(WidgetState::Idle);
+            case CommandType::Vertices:
+                sink.drawVertices(&m_vertices[command.first], command.count, command.primitiveType, command.states);
+                break;
+
+            case CommandType::GlyphRun:
+            {
+                // The transform of the text is already in the states
+                const auto& run = m_glyphRuns[command.first];
+
+                sf::Text text;
+                text.setString(run.string);
+                text.setFont(*run.font);
+                text.setCharacterSize(run.characterSize);
+                text.setStyle(run.style);
+                text.setFillColor(run.fillColor);
+                text.setOutlineColor(run.outlineColor);
+                text.setOutlineThickness(run.outlineThickness);
+
+                sink.drawGlyphRun(text, command.states);
+                break;
+            }
+
+            case CommandType::Clip:
+                sink.setView(m_views[command.first]);
+                break;
+
+            case CommandType::TextureBind:
+                // Sinks bind textures by themselves
+                break;
+        }
+    }
+}
+
+sf::Uint64 DrawRecorder::hashCommand(const size_t index, sf::Uint64 hash) const
+{
+    const auto& command = m_commands[index];
+    const auto type = static_cast <sf::Uint32>(command.type);
+    hash = LayoutSnapshot::hash(&type, sizeof(type), hash);
+
+    // Addresses differ between runs, so textures are identified by their sizes
+    const auto hashStates = [&hash](const sf::RenderStates& states)
+    {
+        hash = LayoutSnapshot::hash(states.transform.getMatrix(), sizeof(float) * 16, hash);
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        const auto textureSize = (states.texture != nullptr ? states.texture->getSize() : sf::Vector2u());
+        const sf::Uint32 hasShader = (states.shader != nullptr);
+        hash = LayoutSnapshot::hash(&textureSize, sizeof(textureSize), hash);
+        hash = LayoutSnapshot::hash(&hasShader, sizeof(hasShader), hash);
+    };
 
+    switch (command.type)
+    {
+        case CommandType::Vertices:
+        {
+            const auto primitiveType = static_cast <sf::Uint32>(command.primitiveType);
+            hash = LayoutSnapshot::hash(&primitiveType, sizeof(primitiveType), hash);
+
+            for (size_t i = command.first; i < command.first + command.count; i++)
+            {
+                const auto& vertex = m_vertices[i];
+                const auto color = vertex.color.toInteger();
+                hash = LayoutSnapshot::hash(&vertex.position, sizeof(vertex.position), hash);
+                hash = LayoutSnapshot::hash(&color, sizeof(color), hash);
+                hash = LayoutSnapshot::hash(&vertex.texCoords, sizeof(vertex.texCoords), hash);
+            }
+
+            hashStates(command.states);
             break;
         }
 
-        case sf::Event::MouseButtonPressed:
+        case CommandType::GlyphRun:
         {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+            const auto& run = m_glyphRuns[command.first];
+            const sf::Uint32 values[] = {run.characterSize, run.style, run.fillColor.toInteger(), run.outlineColor.toInteger()};
+            hash = LayoutSnapshot::hash(run.string.getData(), run.string.getSize() * sizeof(sf::Uint32), hash);
+            hash = LayoutSnapshot::hash(values, sizeof(values), hash);
+            hash = LayoutSnapshot::hash(&run.outlineThickness, sizeof(run.outlineThickness), hash);
 
-            if (m_state != WidgetState::Pressed)
-                changeState(WidgetState::Pressed);
+            hashStates(command.states);
+            break;
+        }
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        case CommandType::Clip:
+        {
+            const auto& view = m_views[command.first];
+            const auto& viewport = view.getViewport();
+            const float values[] = {view.getCenter().x, view.getCenter().y, view.getSize().x, view.getSize().y,
+                                    viewport.left, viewport.top, viewport.width, viewport.height};
+            hash = LayoutSnapshot::hash(values, sizeof(values), hash);
+            break;
+        }
 
+        case CommandType::TextureBind:
+        {
+            const auto page = static_cast <sf::Uint32>(command.first);
+            hash = LayoutSnapshot::hash(&page, sizeof(page), hash);
+            hashStates(command.states);
             break;
         }
+    }
+
+    return hash;
+}
+
+void DrawRecorder::bindTexture(const void* texture, const unsigned int page)
+{
+    if (texture == m_boundTexture && page == m_boundPage)
+        return;
+
+    m_boundTexture = texture;
+    m_boundPage = page;
+
+    // Fonts are not asked for their textures: creating a page would need OpenGL
+    sf::RenderStates states;
+    states.texture = (page == 0 ? static_cast <const sf::Texture*>(texture) : nullptr);
+
+    m_commands.push_back({CommandType::TextureBind, sf::Points, page, 0, states});
+}
+
+InputSource::~InputSource()
+{
+    //dtor
+}
+
+size_t InputSource::getEventDataSize(const sf::Event::EventType type)
+{
+    switch (type)
+    {
+        case sf::Event::TextEntered:
+        case sf::Event::JoystickConnected:
+        case sf::Event::JoystickDisconnected:
+            return 4;
 
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            return 5;
+
+        case sf::Event::Resized:
+        case sf::Event::MouseMoved:
+        case sf::Event::JoystickButtonPressed:
+        case sf::Event::JoystickButtonReleased:
+            return 8;
+
+        case sf::Event::MouseWheelMoved:
+        case sf::Event::MouseButtonPressed:
         case sf::Event::MouseButtonReleased:
-        {
-            if (event.mouseButton.button != sf::Mouse::Left)
-                break;
+        case sf::Event::JoystickMoved:
+        case sf::Event::TouchBegan:
+        case sf::Event::TouchMoved:
+        case sf::Event::TouchEnded:
+            return 12;
 
-            if (m_state == WidgetState::Pressed)
-                m_isChecked = !m_isChecked;
+        case sf::Event::MouseWheelScrolled:
+        case sf::Event::SensorChanged:
+            return 16;
 
-            changeState(WidgetState::Hovered);
+        default:
+            return 0;
+    }
+}
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+void InputSource::writeEventData(std::vector <char>& data, const sf::Event& event)
+{
+    // Floats are written by their bits
+    const auto floatBits = [](const float value)
+    {
+        sf::Uint32 bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    };
 
+    switch (event.type)
+    {
+        case sf::Event::Resized:
+            writeInteger(data, event.size.width);
+            writeInteger(data, event.size.height);
+            break;
+
+        case sf::Event::TextEntered:
+            writeInteger(data, event.text.unicode);
+            break;
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            writeInteger(data, static_cast <sf::Uint32>(event.key.code));
+            data.push_back(static_cast <char>((event.key.alt ? 1 : 0) | (event.key.control ? 2 : 0) | (event.key.shift ? 4 : 0) | (event.key.system ? 8 : 0)));
+            break;
+
+        case sf::Event::MouseWheelMoved:
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheel.delta));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheel.x));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheel.y));
+            break;
+
+        case sf::Event::MouseWheelScrolled:
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheelScroll.wheel));
+            writeInteger(data, floatBits(event.mouseWheelScroll.delta));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheelScroll.x));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseWheelScroll.y));
+            break;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseButton.button));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseButton.x));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseButton.y));
             break;
-        }
 
         case sf::Event::MouseMoved:
-        {
-            if (m_state == WidgetState::Hovered)
-                break;
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseMove.x));
+            writeInteger(data, static_cast <sf::Uint32>(event.mouseMove.y));
+            break;
 
-            if (m_state == WidgetState::Pressed)
-                break;
+        case sf::Event::JoystickButtonPressed:
+        case sf::Event::JoystickButtonReleased:
+            writeInteger(data, event.joystickButton.joystickId);
+            writeInteger(data, event.joystickButton.button);
+            break;
 
-            changeState(WidgetState::Hovered);
+        case sf::Event::JoystickMoved:
+            writeInteger(data, event.joystickMove.joystickId);
+            writeInteger(data, static_cast <sf::Uint32>(event.joystickMove.axis));
+            writeInteger(data, floatBits(event.joystickMove.position));
+            break;
 
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+        case sf::Event::JoystickConnected:
+        case sf::Event::JoystickDisconnected:
+            writeInteger(data, event.joystickConnect.joystickId);
+            break;
 
+        case sf::Event::TouchBegan:
+        case sf::Event::TouchMoved:
+        case sf::Event::TouchEnded:
+            writeInteger(data, event.touch.finger);
+            writeInteger(data, static_cast <sf::Uint32>(event.touch.x));
+            writeInteger(data, static_cast <sf::Uint32>(event.touch.y));
+            break;
+
+        case sf::Event::SensorChanged:
+            writeInteger(data, static_cast <sf::Uint32>(event.sensor.type));
+            writeInteger(data, floatBits(event.sensor.x));
+            writeInteger(data, floatBits(event.sensor.y));
+            writeInteger(data, floatBits(event.sensor.z));
             break;
-        }
 
         default:
+            break;
+    }
+}
+
+void InputSource::readEventData(const char* data, sf::Event& event)
+{
+    const auto readSigned = [&data]()
+    {
+        const auto value = static_cast <int>(static_cast <sf::Int32>(readInteger(data)));
+        data += 4;
+        return value;
+    };
+
+    const auto readUnsigned = [&data]()
+    {
+        const auto value = readInteger(data);
+        data += 4;
+        return value;
+    };
+
+    const auto readFloat = [&data]()
+    {
+        const auto bits = readInteger(data);
+        data += 4;
+
+        float value = 0.0f;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    };
+
+    switch (event.type)
+    {
+        case sf::Event::Resized:
+            event.size.width = readUnsigned();
+            event.size.height = readUnsigned();
+            break;
+
+        case sf::Event::TextEntered:
+            event.text.unicode = readUnsigned();
+            break;
+
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
         {
-            if (m_doAction.find(event.type) != m_doAction.cend() && m_doAction[event.type] != nullptr)
-                m_doAction[event.type]();
+            event.key.code = static_cast <sf::Keyboard::Key>(readSigned());
 
+            const auto modifiers = static_cast <sf::Uint8>(*data);
+            event.key.alt = (modifiers & 1) != 0;
+            event.key.control = (modifiers & 2) != 0;
+            event.key.shift = (modifiers & 4) != 0;
+            event.key.system = (modifiers & 8) != 0;
             break;
         }
+
+        case sf::Event::MouseWheelMoved:
+            event.mouseWheel.delta = readSigned();
+            event.mouseWheel.x = readSigned();
+            event.mouseWheel.y = readSigned();
+            break;
+
+        case sf::Event::MouseWheelScrolled:
+            event.mouseWheelScroll.wheel = static_cast <sf::Mouse::Wheel>(readSigned());
+            event.mouseWheelScroll.delta = readFloat();
+            event.mouseWheelScroll.x = readSigned();
+            event.mouseWheelScroll.y = readSigned();
+            break;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            event.mouseButton.button = static_cast <sf::Mouse::Button>(readSigned());
+            event.mouseButton.x = readSigned();
+            event.mouseButton.y = readSigned();
+            break;
+
+        case sf::Event::MouseMoved:
+            event.mouseMove.x = readSigned();
+            event.mouseMove.y = readSigned();
+            break;
+
+        case sf::Event::JoystickButtonPressed:
+        case sf::Event::JoystickButtonReleased:
+            event.joystickButton.joystickId = readUnsigned();
+            event.joystickButton.button = readUnsigned();
+            break;
+
+        case sf::Event::JoystickMoved:
+            event.joystickMove.joystickId = readUnsigned();
+            event.joystickMove.axis = static_cast <sf::Joystick::Axis>(readSigned());
+            event.joystickMove.position = readFloat();
+            break;
+
+        case sf::Event::JoystickConnected:
+        case sf::Event::JoystickDisconnected:
+            event.joystickConnect.joystickId = readUnsigned();
+            break;
+
+        case sf::Event::TouchBegan:
+        case sf::Event::TouchMoved:
+        case sf::Event::TouchEnded:
+            event.touch.finger = readUnsigned();
+            event.touch.x = readSigned();
+            event.touch.y = readSigned();
+            break;
+
+        case sf::Event::SensorChanged:
+            event.sensor.type = static_cast <sf::Sensor::Type>(readSigned());
+            event.sensor.x = readFloat();
+            event.sensor.y = readFloat();
+            event.sensor.z = readFloat();
+            break;
+
+        default:
+            break;
     }
 }
 
-void CheckBox::draw(sf::RenderTarget& target, sf::RenderStates states) const
+void InputSource::writeInteger(std::vector <char>& data, const sf::Uint32 value)
 {
-    if (m_state == WidgetState::Hidden)
-        return;
+    for (unsigned int shift = 0; shift < 32; shift += 8)
+        data.push_back(static_cast <char>((value >> shift) & 0xFF));
+}
 
-    if (m_contentNeedsUpdate)
-    {
-        updateTextSplitting();
-        refreshTheme();
-        placeText();
-        m_contentNeedsUpdate = false;
-    }
+sf::Uint32 InputSource::readInteger(const char* data)
+{
+    sf::Uint32 value = 0;
 
-    drawRectangle(target, states);
+    for (unsigned int i = 0; i < 4; i++)
+        value |= static_cast <sf::Uint32>(static_cast <unsigned char>(data[i])) << (8 * i);
 
-    if (m_isChecked)
-        drawText(target, states);
+    return value;
 }
 
-StaticText::StaticText() : TextBasedWidget()
+WindowInputSource::WindowInputSource(sf::Window& window) : m_window(window)
 {
     //ctor
 }
 
-StaticText::~StaticText()
+WindowInputSource::~WindowInputSource()
 {
     //dtor
 }
 
-void StaticText::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+bool WindowInputSource::pollEvent(sf::Event& event)
 {
-    // Static text does nothing
-    return;
+    return m_window.pollEvent(event);
+}
+
+bool WindowInputSource::waitEvent(sf::Event& event)
+{
+    return m_window.waitEvent(event);
+}
+
+sf::Vector2i WindowInputSource::getMousePosition() const
+{
+    return sf::Mouse::getPosition(m_window);
+}
+
+InputRecorder::InputRecorder(InputSource& source) :
+    m_source(source),
+    m_lastTime(sf::Time::Zero),
+    m_eventCount(0),
+    m_isFrameOpen(false)
+{
+    // Events without coordinates are processed at the mouse position the recording starts with
+    const auto mousePosition = source.getMousePosition();
+
+    writeInteger(m_data, Magic);
+    writeInteger(m_data, Version);
+    writeInteger(m_data, static_cast <sf::Uint32>(mousePosition.x));
+    writeInteger(m_data, static_cast <sf::Uint32>(mousePosition.y));
+}
+
+InputRecorder::~InputRecorder()
+{
+    //dtor
+}
+
+bool InputRecorder::pollEvent(sf::Event& event)
+{
+    if (!m_source.pollEvent(event))
+    {
+        // The frame has taken all events: the replay stops here too
+        if (m_isFrameOpen)
+        {
+            writeTime();
+            m_data.push_back(static_cast <char>(FrameEnd));
+            m_isFrameOpen = false;
+        }
+
+        return false;
+    }
+
+    record(event);
+    return true;
+}
+
+bool InputRecorder::waitEvent(sf::Event& event)
+{
+    if (!m_source.waitEvent(event))
+        return false;
+
+    record(event);
+    return true;
+}
+
+sf::Vector2i InputRecorder::getMousePosition() const
+{
+    return m_source.getMousePosition();
+}
+
+bool InputRecorder::saveToFile(const std::string& fileName) const
+{
+    std::ofstream fout(fileName, std::ios::binary);
+    if (!fout.write(m_data.data(), m_data.size()))
+    {
+        sf::err() << "Failed to save input recording \"" << fileName << "\"" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+size_t InputRecorder::getEventCount() const
+{
+    return m_eventCount;
+}
+
+void InputRecorder::record(const sf::Event& event)
+{
+    writeTime();
+    m_data.push_back(static_cast <char>(event.type));
+    writeEventData(m_data, event);
+
+    m_eventCount++;
+    m_isFrameOpen = true;
+}
+
+void InputRecorder::writeTime()
+{
+    const auto time = m_clock.getElapsedTime();
+    auto gap = static_cast <sf::Uint64>(std::max <sf::Int64>(0, (time - m_lastTime).asMicroseconds()));
+    m_lastTime = time;
+
+    // The high bit tells that more groups follow
+    while (gap >= 0x80)
+    {
+        m_data.push_back(static_cast <char>((gap & 0x7F) | 0x80));
+        gap >>= 7;
+    }
+
+    m_data.push_back(static_cast <char>(gap));
+}
+
+InputReplayer::InputReplayer(const Speed speed) :
+    m_nextEntry(0),
+    m_speed(speed)
+{
+    //ctor
+}
+
+InputReplayer::~InputReplayer()
+{
+    //dtor
+}
+
+bool InputReplayer::loadFromFile(const std::string& fileName)
+{
+    std::ifstream fin(fileName, std::ios::binary);
+    const std::vector <char> data((std::istreambuf_iterator <char>(fin)), std::istreambuf_iterator <char>());
+
+    // Signature, version and the mouse position
+    const size_t headerSize = 16;
+    if (data.size() < headerSize)
+    {
+        sf::err() << "Failed to load input recording \"" << fileName << "\"" << std::endl;
+        return false;
+    }
+
+    if (readInteger(data.data()) != InputRecorder::Magic || readInteger(data.data() + 4) != InputRecorder::Version)
+    {
+        sf::err() << "Input recording \"" << fileName << "\" has another format" << std::endl;
+        return false;
+    }
+
+    std::vector <Entry> entries;
+    sf::Int64 time = 0;
+    size_t position = headerSize;
+
+    while (position < data.size())
+    {
+        // Time since the previous entry in 7-bit groups
+        sf::Uint64 gap = 0;
+        unsigned int shift = 0;
+
+        while (position < data.size() && (data[position] & 0x80) != 0 && shift < 64)
+        {
+            gap |= static_cast <sf::Uint64>(data[position++] & 0x7F) << shift;
+            shift += 7;
+        }
+
+        if (position >= data.size())
+            break;
+
+        gap |= static_cast <sf::Uint64>(static_cast <unsigned char>(data[position++])) << shift;
+        time += static_cast <sf::Int64>(gap);
+
+        if (position >= data.size())
+            break;
+
+        Entry entry;
+        entry.time = sf::microseconds(time);
+        entry.isFrameEnd = (static_cast <sf::Uint8>(data[position]) == InputRecorder::FrameEnd);
+        std::memset(&entry.event, 0, sizeof(entry.event));
+
+        if (!entry.isFrameEnd)
+        {
+            entry.event.type = static_cast <sf::Event::EventType>(static_cast <sf::Uint8>(data[position]));
+
+            const auto size = getEventDataSize(entry.event.type);
+            if (entry.event.type >= sf::Event::Count || position + 1 + size > data.size())
+                break;
+
+            readEventData(data.data() + position + 1, entry.event);
+            position += size;
+        }
+
+        position++;
+        entries.push_back(entry);
+    }
+
+    if (position < data.size())
+        sf::err() << "Input recording \"" << fileName << "\" is damaged, " << entries.size() << " entries are loaded" << std::endl;
+
+    m_entries.swap(entries);
+    m_initialMousePosition = sf::Vector2i(static_cast <sf::Int32>(readInteger(data.data() + 8)), static_cast <sf::Int32>(readInteger(data.data() + 12)));
+    restart();
+
+    return true;
+}
+
+void InputReplayer::restart()
+{
+    m_nextEntry = 0;
+    m_mousePosition = m_initialMousePosition;
+    m_clock.restart();
+}
+
+void InputReplayer::setSpeed(const Speed speed)
+{
+    m_speed = speed;
+}
+
+bool InputReplayer::isFinished() const
+{
+    return m_nextEntry >= m_entries.size();
+}
+
+size_t InputReplayer::getEventCount() const
+{
+    return static_cast <size_t>(std::count_if(m_entries.begin(), m_entries.end(), [](const Entry& entry)
+    {
+        return !entry.isFrameEnd;
+    }));
+}
+
+bool InputReplayer::pollEvent(sf::Event& event)
+{
+    if (isFinished())
+        return false;
+
+    // The end of a frame is given once, as if the queue were empty
+    if (m_entries[m_nextEntry].isFrameEnd)
+    {
+        m_nextEntry++;
+        return false;
+    }
+
+    if (m_speed == Speed::Recorded && m_entries[m_nextEntry].time > m_clock.getElapsedTime())
+        return false;
+
+    takeEvent(event);
+    return true;
+}
+
+bool InputReplayer::waitEvent(sf::Event& event)
+{
+    while (!isFinished() && m_entries[m_nextEntry].isFrameEnd)
+        m_nextEntry++;
+
+    if (isFinished())
+        return false;
+
+    if (m_speed == Speed::Recorded)
+        sf::sleep(m_entries[m_nextEntry].time - m_clock.getElapsedTime());
+
+    takeEvent(event);
+    return true;
+}
+
+sf::Vector2i InputReplayer::getMousePosition() const
+{
+    return m_mousePosition;
+}
+
+void InputReplayer::takeEvent(sf::Event& event)
+{
+    event = m_entries[m_nextEntry++].event;
+
+    switch (event.type)
+    {
+        case sf::Event::MouseMoved:
+            m_mousePosition = sf::Vector2i(event.mouseMove.x, event.mouseMove.y);
+            break;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            m_mousePosition = sf::Vector2i(event.mouseButton.x, event.mouseButton.y);
+            break;
+
+        case sf::Event::MouseWheelScrolled:
+            m_mousePosition = sf::Vector2i(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+            break;
+
+        default:
+            break;
+    }
+}
+
+LatencyHistogram::LatencyHistogram() :
+    m_buckets(BucketCount + 1, 0),
+    m_count(0)
+{
+    //ctor
+}
+
+void LatencyHistogram::add(const sf::Time latency)
+{
+    // Durations under a microsecond go to the first bucket, the next ones start at a microsecond
+    const auto microseconds = latency.asMicroseconds();
+    size_t bucket = 0;
+
+    if (microseconds >= 1)
+        bucket = std::min(BucketCount, 1 + static_cast <size_t>(std::log2(static_cast <double>(microseconds)) * BucketsPerOctave));
+
+    m_buckets[bucket]++;
+    m_count++;
+    m_maximum = std::max(m_maximum, latency);
+}
+
+void LatencyHistogram::clear()
+{
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_maximum = sf::Time::Zero;
+}
+
+size_t LatencyHistogram::getCount() const
+{
+    return m_count;
+}
+
+sf::Time LatencyHistogram::getPercentile(const float percentile) const
+{
+    if (m_count == 0)
+        return sf::Time::Zero;
+
+    const auto rank = std::max <size_t>(1, static_cast <size_t>(std::ceil(m_count * std::min(100.0f, std::max(0.0f, percentile)) / 100.0)));
+    size_t counted = 0;
+
+    for (size_t i = 0; i < m_buckets.size(); i++)
+    {
+        counted += m_buckets[i];
+        if (counted < rank || i == BucketCount)
+            continue;
+
+        // The border is never beyond the largest sample, so p100 is exact
+        const auto border = sf::microseconds(static_cast <sf::Int64>(std::ceil(std::exp2(static_cast <double>(i) / BucketsPerOctave))));
+        return std::min(border, m_maximum);
+    }
+
+    return m_maximum;
+}
+
+sf::Time LatencyHistogram::getMaximum() const
+{
+    return m_maximum;
+}
+
+MemoryReport::MemoryReport()
+{
+    //ctor
+}
+
+void MemoryReport::addWidget(const std::string& type, const size_t size)
+{
+    auto& usage = m_types[type];
+    usage.widgetCount++;
+    usage.components["object"] += size;
+}
+
+void MemoryReport::addComponent(const std::string& type, const std::string& component, const size_t size)
+{
+    m_types[type].components[component] += size;
+}
+
+size_t MemoryReport::getWidgetCount() const
+{
+    size_t count = 0;
+    for (const auto& usage : m_types)
+        count += usage.second.widgetCount;
+    return count;
+}
+
+size_t MemoryReport::getWidgetCount(const std::string& type) const
+{
+    const auto usage = m_types.find(type);
+    return (usage != m_types.end() ? usage->second.widgetCount : 0);
+}
+
+size_t MemoryReport::getByteCount() const
+{
+    size_t size = 0;
+    for (const auto& usage : m_types)
+        size += getByteCount(usage.first);
+    return size;
+}
+
+size_t MemoryReport::getByteCount(const std::string& type) const
+{
+    const auto usage = m_types.find(type);
+    if (usage == m_types.end())
+        return 0;
+
+    size_t size = 0;
+    for (const auto& component : usage->second.components)
+        size += component.second;
+    return size;
+}
+
+size_t MemoryReport::getByteCount(const std::string& type, const std::string& component) const
+{
+    const auto usage = m_types.find(type);
+    if (usage == m_types.end())
+        return 0;
+
+    const auto size = usage->second.components.find(component);
+    return (size != usage->second.components.end() ? size->second : 0);
+}
+
+std::vector <std::string> MemoryReport::getTypes() const
+{
+    std::vector <std::string> types;
+    for (const auto& usage : m_types)
+        types.push_back(usage.first);
+    return types;
+}
+
+std::vector <std::string> MemoryReport::getComponents(const std::string& type) const
+{
+    std::vector <std::string> components;
+    const auto usage = m_types.find(type);
+
+    if (usage != m_types.end())
+    {
+        for (const auto& component : usage->second.components)
+            components.push_back(component.first);
+    }
+
+    return components;
+}
+
+bool MemoryReport::saveToFile(const std::string& fileName) const
+{
+    std::ofstream fout(fileName);
+    if (!fout)
+    {
+        sf::err() << "Failed to save memory report \"" << fileName << "\"" << std::endl;
+        return false;
+    }
+
+    fout << "# Memory used by widgets, bytes\n";
+    fout << "type\tcomponent\twidgets\tbytes\tper widget\n";
+
+    for (const auto& usage : m_types)
+    {
+        const auto count = usage.second.widgetCount;
+        const auto writeRow = [&fout, &usage, count](const std::string& component, const size_t size)
+        {
+            fout << usage.first << '\t' << component << '\t' << count << '\t' << size << '\t' << (count > 0 ? size / count : 0) << '\n';
+        };
+
+        for (const auto& component : usage.second.components)
+            writeRow(component.first, component.second);
+
+        writeRow("total", getByteCount(usage.first));
+    }
+
+    fout << "all\ttotal\t" << getWidgetCount() << '\t' << getByteCount() << '\n';
+    return static_cast <bool>(fout);
+}
+
+WidgetUpdateQueue::WidgetUpdateQueue() : m_head(new Node()), m_tail(nullptr)
+{
+    m_tail = m_head.load();
+    m_tail->next.store(nullptr);
+}
+
+WidgetUpdateQueue::~WidgetUpdateQueue()
+{
+    while (m_tail != nullptr)
+    {
+        const auto next = m_tail->next.load();
+        delete m_tail;
+        m_tail = next;
+    }
+}
+
+void WidgetUpdateQueue::push(WidgetUpdate&& update)
+{
+    auto node = new Node();
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->update = std::move(update);
+
+    // Producers only swap the head, then link the previous one to the new node
+    const auto previous = m_head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+bool WidgetUpdateQueue::pop(WidgetUpdate& update)
+{
+    const auto next = m_tail->next.load(std::memory_order_acquire);
+    if (next == nullptr)
+        return false;
+
+    // The node with the update becomes the new empty tail
+    update = std::move(next->update);
+    delete m_tail;
+    m_tail = next;
+
+    return true;
+}
+
+ObservableBase::ObservableBase() : m_isChanged(false), m_isNotifying(false)
+{
+    //ctor
+}
+
+ObservableBase::~ObservableBase()
+{
+    for (const auto& subscriber : m_subscribers)
+    {
+        auto& bindings = subscriber.widget->m_bindings;
+        bindings.erase(std::remove(bindings.begin(), bindings.end(), this), bindings.end());
+    }
+
+    if (m_isChanged)
+    {
+        auto& changedObservables = WidgetPool::getInstance().m_changedObservables;
+        changedObservables.erase(std::remove(changedObservables.begin(), changedObservables.end(), this), changedObservables.end());
+    }
+}
+
+void ObservableBase::markChanged()
+{
+    if (m_isChanged)
+        return;
+
+    m_isChanged = true;
+    WidgetPool::getInstance().m_changedObservables.push_back(this);
+}
+
+void ObservableBase::notify()
+{
+    m_isChanged = false;
+    m_isNotifying = true;
+
+    // Binding functions may destroy and bind widgets, so the subscribers are only marked as removed until the loop ends,
+    // and the function is called from a copy, as binding may move the vector
+    const auto subscriberCount = m_subscribers.size();
+    for (size_t i = 0; i < subscriberCount; i++)
+    {
+        if (m_subscribers[i].widget == nullptr)
+            continue;
+
+        const auto update = m_subscribers[i].update;
+        update();
+    }
+
+    m_isNotifying = false;
+    removeSubscriber(nullptr);
+}
+
+void ObservableBase::removeSubscriber(const Widget* widget)
+{
+    if (m_isNotifying)
+    {
+        for (auto& subscriber : m_subscribers)
+        {
+            if (subscriber.widget == widget)
+                subscriber.widget = nullptr;
+        }
+
+        return;
+    }
+
+    const auto isRemoved = [widget](const Subscriber& subscriber) { return subscriber.widget == widget; };
+    m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(), isRemoved), m_subscribers.end());
+}
+
+WidgetPool::WidgetPool() :
+    m_window(nullptr),
+    m_activeWidget(nullptr),
+    m_lastHoveredWidget(nullptr),
+    m_focusedWidget(nullptr),
+    m_pointerCapture(nullptr),
+    m_isTabNavigationEnabled(true),
+    m_inputSource(nullptr),
+    m_isLatencyTracked(false),
+    m_isDispatching(false),
+    m_eventNumber(0),
+    m_eventType(sf::Event::Count),
+    m_eventLatencies(sf::Event::Count),
+    m_needsRedraw(true),
+    m_lastHandle(0),
+    m_hasPostedUpdates(false),
+    m_isPostingUsed(false)
+{
+    //ctor
+}
+
+WidgetPool::~WidgetPool()
+{
+    //dtor
+}
+
+WidgetPool& WidgetPool::getInstance()
+{
+    static WidgetPool instance;
+    return instance;
+}
+
+void WidgetPool::initialize(const sf::RenderWindow* window)
+{
+    m_window = window;
+}
+
+void WidgetPool::addWidget(Widget* widget)
+{
+    widget->m_poolPosition = m_widgets.insert(m_widgets.end(), widget);
+    widget->m_topLevelPosition = m_topLevelWidgets.insert(m_topLevelWidgets.end(), widget);
+    widget->m_handle = ++m_lastHandle;
+    m_handles[widget->m_handle] = widget;
+    m_needsRedraw = true;
+}
+
+void WidgetPool::removeWidget(Widget* widget)
+{
+    m_widgets.erase(widget->m_poolPosition);
+    m_handles.erase(widget->m_handle);
+    m_widgetLatencies.erase(widget->m_handle);
+
+    if (widget->m_parent == nullptr)
+        m_topLevelWidgets.erase(widget->m_topLevelPosition);
+    m_needsRedraw = true;
+
+    if (m_activeWidget == widget)
+        m_activeWidget = nullptr;
+
+    if (m_lastHoveredWidget == widget)
+        m_lastHoveredWidget = nullptr;
+
+    if (m_focusedWidget == widget)
+        m_focusedWidget = nullptr;
+
+    if (m_pointerCapture == widget)
+        m_pointerCapture = nullptr;
+
+    const auto animatedWidget = std::find(m_animatedWidgets.begin(), m_animatedWidgets.end(), widget);
+    if (animatedWidget != m_animatedWidgets.end())
+        m_animatedWidgets.erase(animatedWidget);
+}
+
+void WidgetPool::startAnimation(Widget* widget)
+{
+    if (std::find(m_animatedWidgets.begin(), m_animatedWidgets.end(), widget) == m_animatedWidgets.end())
+        m_animatedWidgets.push_back(widget);
+}
+
+void WidgetPool::updateAnimations(const sf::Time elapsedTime)
+{
+    for (size_t i = 0; i < m_animatedWidgets.size();)
+    {
+        auto widget = m_animatedWidgets[i];
+        const auto duration = (widget->m_theme != nullptr ? widget->m_theme->getTransitionDuration() : sf::Time::Zero);
+
+        if (duration > sf::Time::Zero && !widget->isHidden())
+            widget->m_animationProgress = std::min(1.0f, widget->m_animationProgress + elapsedTime / duration);
+        else
+            widget->m_animationProgress = 1.0f;
+
+        widget->refreshColors();
+        m_needsRedraw = true;
+
+        // Finished widgets are replaced with the last one, the order does not matter
+        if (widget->m_animationProgress >= 1.0f)
+        {
+            m_animatedWidgets[i] = m_animatedWidgets.back();
+            m_animatedWidgets.pop_back();
+        }
+        else
+            i++;
+    }
+}
+
+bool WidgetPool::hasActiveAnimations() const
+{
+    return !m_animatedWidgets.empty();
+}
+
+bool WidgetPool::needsRedraw() const
+{
+    return m_needsRedraw || hasActiveAnimations();
+}
+
+void WidgetPool::requestRedraw()
+{
+    m_needsRedraw = true;
+}
+
+ShapedRunCache& WidgetPool::getShapedRunCache()
+{
+    return m_shapedRunCache;
+}
+
+ScratchArena& WidgetPool::getScratchArena()
+{
+    return m_scratchArena;
+}
+
+void WidgetPool::postString(const WidgetHandle widget, const sf::String& string)
+{
+    postUpdate({ widget, WidgetProperty::String, string, sf::Vector2f(), false });
+}
+
+void WidgetPool::postChecked(const WidgetHandle widget, const bool isChecked)
+{
+    postUpdate({ widget, WidgetProperty::Checked, sf::String(), sf::Vector2f(), isChecked });
+}
+
+void WidgetPool::postPosition(const WidgetHandle widget, const sf::Vector2f& position)
+{
+    postUpdate({ widget, WidgetProperty::Position, sf::String(), position, false });
+}
+
+void WidgetPool::postSize(const WidgetHandle widget, const sf::Vector2f& size)
+{
+    postUpdate({ widget, WidgetProperty::Size, sf::String(), size, false });
+}
+
+void WidgetPool::postHidden(const WidgetHandle widget, const bool isHidden)
+{
+    postUpdate({ widget, WidgetProperty::Hidden, sf::String(), sf::Vector2f(), isHidden });
+}
+
+void WidgetPool::postUpdate(WidgetUpdate&& update)
+{
+    m_postedUpdates.push(std::move(update));
+
+    // Set after the push, so the flag cannot be cleared before the update is visible
+    m_isPostingUsed.store(true, std::memory_order_relaxed);
+    m_hasPostedUpdates.store(true, std::memory_order_release);
+}
+
+size_t WidgetPool::applyPostedUpdates()
+{
+    if (!m_hasPostedUpdates.exchange(false, std::memory_order_acquire))
+        return 0;
+
+    const auto getKey = [](const WidgetUpdate& update)
+    {
+        return (update.widget << 3) | static_cast <sf::Uint64>(update.property);
+    };
+
+    m_updateBatch.clear();
+    m_lastUpdates.clear();
+
+    // A later update of the same property replaces the earlier one in its place, so the batch stays small
+    WidgetUpdate update;
+    while (m_postedUpdates.pop(update))
+    {
+        const auto inserted = m_lastUpdates.emplace(getKey(update), m_updateBatch.size());
+
+        if (inserted.second)
+            m_updateBatch.push_back(std::move(update));
+        else
+            m_updateBatch[inserted.first->second] = std::move(update);
+    }
+
+    size_t appliedCount = 0;
+
+    for (auto& batchUpdate : m_updateBatch)
+    {
+        const auto found = m_handles.find(batchUpdate.widget);
+        if (found == m_handles.end())
+            continue;
+
+        auto widget = found->second;
+
+        switch (batchUpdate.property)
+        {
+            case WidgetProperty::String:
+                if (auto textBasedWidget = dynamic_cast <TextBasedWidget*>(widget))
+                    textBasedWidget->setString(std::move(batchUpdate.string));
+                break;
+
+            case WidgetProperty::Checked:
+                if (auto checkBox = dynamic_cast <CheckBox*>(widget))
+                    checkBox->setChecked(batchUpdate.flag);
+                break;
+
+            case WidgetProperty::Position:
+                widget->setPosition(batchUpdate.vector);
+                break;
+
+            case WidgetProperty::Size:
+                widget->setSize(batchUpdate.vector);
+                break;
+
+            case WidgetProperty::Hidden:
+                if (batchUpdate.flag)
+                    widget->hide();
+                else
+                    widget->show();
+                break;
+        }
+
+        appliedCount++;
+    }
+
+    return appliedCount;
+}
+
+bool WidgetPool::hasPostedUpdates() const
+{
+    return m_hasPostedUpdates.load(std::memory_order_acquire);
+}
+
+size_t WidgetPool::applyBindings()
+{
+    // Widgets may change other observables while being notified, those are delivered on the next call
+    m_notifiedObservables.clear();
+    m_notifiedObservables.swap(m_changedObservables);
+
+    for (const auto observable : m_notifiedObservables)
+        observable->notify();
+
+    return m_notifiedObservables.size();
+}
+
+void WidgetPool::setInputSource(const InputSource* source)
+{
+    m_inputSource = source;
+}
+
+void WidgetPool::processEvent(const sf::Event event)
+{
+    // The real mouse may have moved since the event, so it is asked only if the event has no coordinates
+    sf::Vector2f position;
+    if (!getEventPosition(event, position))
+        position = getMousePosition();
+
+    m_activeWidget = getActiveWidget(position);
+
+    stampEvent(event, m_latencyClock.getElapsedTime());
+    dispatchEvent(event, position);
+    m_isDispatching = false;
+}
+
+size_t WidgetPool::processEvents(const std::vector <sf::Event>& events)
+{
+    const auto skippedCount = processEvents(events, nullptr);
+    m_isDispatching = false;
+
+    return skippedCount;
+}
+
+size_t WidgetPool::processEvents(const std::vector <sf::Event>& events, const std::vector <sf::Time>* arrivalTimes)
+{
+    size_t skippedCount = 0;
+    size_t firstSkippedMove = events.size();
+    bool isActiveWidgetFound = false;
+
+    // Events not related to the mouse use the last known position
+    auto position = getMousePosition();
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const auto& event = events[i];
+        auto eventPosition = position;
+
+        // Only the last of consecutive moves matters
+        if (event.type == sf::Event::MouseMoved && i + 1 < events.size() && events[i + 1].type == sf::Event::MouseMoved)
+        {
+            firstSkippedMove = std::min(firstSkippedMove, i);
+            skippedCount++;
+            continue;
+        }
+
+        getEventPosition(event, eventPosition);
+
+        if (eventPosition != position || !isActiveWidgetFound)
+        {
+            position = eventPosition;
+            m_activeWidget = getActiveWidget(position);
+            isActiveWidgetFound = true;
+        }
+
+        // The user has been waiting since the first of the replaced moves
+        const auto arrivalIndex = std::min(firstSkippedMove, i);
+        firstSkippedMove = events.size();
+
+        stampEvent(event, arrivalTimes != nullptr ? (*arrivalTimes)[arrivalIndex] : m_latencyClock.getElapsedTime());
+        dispatchEvent(event, position);
+
+        // Actions may show, hide or move widgets
+        if (event.type != sf::Event::MouseMoved)
+            isActiveWidgetFound = false;
+    }
+
+    return skippedCount;
+}
+
+void WidgetPool::stampEvent(const sf::Event& event, const sf::Time arrivalTime)
+{
+    if (!m_isLatencyTracked)
+        return;
+
+    m_isDispatching = true;
+    m_eventNumber++;
+    m_eventType = event.type;
+    m_eventArrivalTime = arrivalTime;
+}
+
+void WidgetPool::trackInvalidation(const Widget& widget)
+{
+    if (!m_isDispatching)
+        return;
+
+    // A widget changed several times by the same event waits for one frame only
+    for (auto i = m_pendingLatencies.rbegin(); i != m_pendingLatencies.rend() && i->eventNumber == m_eventNumber; ++i)
+    {
+        if (i->widget == widget.m_handle)
+            return;
+    }
+
+    m_pendingLatencies.push_back({m_eventNumber, m_eventType, m_eventArrivalTime, widget.m_handle});
+}
+
+void WidgetPool::setLatencyTracking(const bool isEnabled)
+{
+    m_isLatencyTracked = isEnabled;
+
+    if (!isEnabled)
+    {
+        m_pendingLatencies.clear();
+        m_drawnLatencies.clear();
+    }
+}
+
+void WidgetPool::markFrameSubmitted()
+{
+    const auto now = m_latencyClock.getElapsedTime();
+
+    // Entries of the same event are adjacent, the event is counted once by its type
+    for (size_t i = 0; i < m_drawnLatencies.size(); i++)
+    {
+        const auto& entry = m_drawnLatencies[i];
+        const auto latency = now - entry.arrivalTime;
+
+        if (i == 0 || m_drawnLatencies[i - 1].eventNumber != entry.eventNumber)
+            m_eventLatencies[entry.type].add(latency);
+
+        // The widget may have been destroyed since it was changed
+        if (m_handles.find(entry.widget) != m_handles.end())
+            m_widgetLatencies[entry.widget].add(latency);
+    }
+
+    m_drawnLatencies.clear();
+}
+
+const LatencyHistogram& WidgetPool::getEventLatency(const sf::Event::EventType type) const
+{
+    return m_eventLatencies[std::min(static_cast <size_t>(type), m_eventLatencies.size() - 1)];
+}
+
+const LatencyHistogram* WidgetPool::getWidgetLatency(const WidgetHandle widget) const
+{
+    const auto histogram = m_widgetLatencies.find(widget);
+    return (histogram != m_widgetLatencies.end() ? &histogram->second : nullptr);
+}
+
+void WidgetPool::clearLatencies()
+{
+    for (auto& histogram : m_eventLatencies)
+        histogram.clear();
+
+    m_widgetLatencies.clear();
+    m_pendingLatencies.clear();
+    m_drawnLatencies.clear();
+}
+
+bool WidgetPool::saveLatencyReport(const std::string& fileName) const
+{
+    static const char* const eventNames[] =
+    {
+        "Closed", "Resized", "LostFocus", "GainedFocus", "TextEntered", "KeyPressed", "KeyReleased",
+        "MouseWheelMoved", "MouseWheelScrolled", "MouseButtonPressed", "MouseButtonReleased", "MouseMoved",
+        "MouseEntered", "MouseLeft", "JoystickButtonPressed", "JoystickButtonReleased", "JoystickMoved",
+        "JoystickConnected", "JoystickDisconnected", "TouchBegan", "TouchMoved", "TouchEnded", "SensorChanged"
+    };
+
+    std::ofstream fout(fileName);
+    if (!fout)
+    {
+        sf::err() << "Failed to save latency report \"" << fileName << "\"" << std::endl;
+        return false;
+    }
+
+    const auto writeRow = [&fout](const std::string& name, const LatencyHistogram& histogram)
+    {
+        fout << name << '\t' << histogram.getCount()
+             << '\t' << histogram.getPercentile(50.0f).asMicroseconds()
+             << '\t' << histogram.getPercentile(95.0f).asMicroseconds()
+             << '\t' << histogram.getPercentile(99.0f).asMicroseconds()
+             << '\t' << histogram.getMaximum().asMicroseconds() << '\n';
+    };
+
+    fout << "# Time from taking an event to submitting the frame that shows it, microseconds\n";
+    fout << "source\tcount\tp50\tp95\tp99\tmax\n";
+
+    for (size_t i = 0; i < m_eventLatencies.size(); i++)
+    {
+        if (m_eventLatencies[i].getCount() == 0)
+            continue;
+
+        const auto name = (i < sizeof(eventNames) / sizeof(eventNames[0]) ? std::string(eventNames[i]) : "Event" + std::to_string(i));
+        writeRow("event " + name, m_eventLatencies[i]);
+    }
+
+    // Widgets are sorted by handles, so reports of the same interface can be compared
+    std::vector <WidgetHandle> handles;
+    for (const auto& histogram : m_widgetLatencies)
+        handles.push_back(histogram.first);
+    std::sort(handles.begin(), handles.end());
+
+    for (const auto handle : handles)
+        writeRow("widget " + std::to_string(handle), m_widgetLatencies.at(handle));
+
+    return static_cast <bool>(fout);
+}
+
+MemoryReport WidgetPool::getMemoryReport() const
+{
+    MemoryReport report;
+
+    for (const auto widget : m_widgets)
+        widget->reportMemory(report);
+
+    return report;
+}
+
+void WidgetPool::dispatchEvent(const sf::Event& event, const sf::Vector2f& position)
+{
+    // Tab moves the focus, so the character typed by the same key is skipped
+    if (m_isTabNavigationEnabled)
+    {
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Tab)
+        {
+            focusNextWidget(event.key.shift);
+            return;
+        }
+
+        if (event.type == sf::Event::TextEntered && event.text.unicode == '\t')
+            return;
+    }
+
+    bool isKeyboardEvent = false;
+    bool isMouseEvent = false;
+    bool isClick = false;
+
+    switch (event.type)
+    {
+        case sf::Event::TextEntered:
+        case sf::Event::KeyPressed:
+        case sf::Event::KeyReleased:
+            isKeyboardEvent = true;
+            break;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+        case sf::Event::MouseLeft:
+            isClick = true;
+            isMouseEvent = true;
+            break;
+
+        case sf::Event::MouseMoved:
+        case sf::Event::MouseWheelScrolled:
+            isMouseEvent = true;
+            break;
+
+        default:
+            break;
+    }
+
+    // The focused widget sees clicks outside it to lose the pressed state or close itself
+    Widget* receivers[4] = {};
+
+    if (isKeyboardEvent)
+        receivers[0] = m_focusedWidget;
+    else if (isMouseEvent)
+    {
+        receivers[0] = m_activeWidget;
+        receivers[1] = m_pointerCapture;
+        receivers[2] = m_lastHoveredWidget;
+        receivers[3] = (isClick ? m_focusedWidget : nullptr);
+    }
+    else
+    {
+        receivers[0] = m_activeWidget;
+        receivers[1] = m_focusedWidget;
+    }
+
+    // Events bubble up to the first ancestor that handles them
+    for (auto& receiver : receivers)
+    {
+        while (receiver != nullptr && !receiver->m_eventMask[event.type])
+            receiver = receiver->m_parent;
+    }
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        const auto receiver = receivers[i];
+
+        if (receiver == nullptr || !receiver->isVisible() || std::find(receivers, receivers + i, receiver) != receivers + i)
+            continue;
+
+        receiver->processEvent(event, getLocalPosition(*receiver, position));
+    }
+
+    if (!isMouseEvent)
+        return;
+
+    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left)
+        m_pointerCapture = m_activeWidget;
+
+    if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left)
+    {
+        m_pointerCapture = nullptr;
+        setFocusedWidget(m_activeWidget);
+    }
+
+    m_lastHoveredWidget = m_activeWidget;
+}
+
+bool WidgetPool::getEventPosition(const sf::Event& event, sf::Vector2f& position) const
+{
+    switch (event.type)
+    {
+        case sf::Event::MouseMoved:
+            position = m_window->mapPixelToCoords({ event.mouseMove.x, event.mouseMove.y });
+            return true;
+
+        case sf::Event::MouseButtonPressed:
+        case sf::Event::MouseButtonReleased:
+            position = m_window->mapPixelToCoords({ event.mouseButton.x, event.mouseButton.y });
+            return true;
+
+        case sf::Event::MouseWheelScrolled:
+            position = m_window->mapPixelToCoords({ event.mouseWheelScroll.x, event.mouseWheelScroll.y });
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+sf::Vector2f WidgetPool::getMousePosition() const
+{
+    const auto position = (m_inputSource != nullptr ? m_inputSource->getMousePosition() : sf::Mouse::getPosition(*m_window));
+    return m_window->mapPixelToCoords(position);
+}
+
+void WidgetPool::setFocusedWidget(Widget* widget)
+{
+    if (widget == m_focusedWidget)
+        return;
+
+    const auto previousWidget = m_focusedWidget;
+    m_focusedWidget = widget;
+
+    if (previousWidget != nullptr)
+        previousWidget->changeFocus(false);
+
+    if (m_focusedWidget != nullptr)
+        m_focusedWidget->changeFocus(true);
+}
+
+Widget* WidgetPool::getFocusedWidget() const
+{
+    return m_focusedWidget;
+}
+
+void WidgetPool::focusNextWidget(const bool isBackward)
+{
+    std::vector <Widget*> widgets;
+    widgets.reserve(m_widgets.size());
+
+    for (const auto widget : m_topLevelWidgets)
+        appendSubtree(widget, widgets);
+
+    if (widgets.empty())
+        return;
+
+    // The search starts after the focused widget, or from the first widget if nothing is focused
+    const auto focused = std::find(widgets.begin(), widgets.end(), m_focusedWidget);
+    auto position = (focused != widgets.end() ? static_cast <size_t>(focused - widgets.begin()) : (isBackward ? 0 : widgets.size() - 1));
+
+    for (size_t i = 0; i < widgets.size(); i++)
+    {
+        position = (isBackward ? position + widgets.size() - 1 : position + 1) % widgets.size();
+
+        if (widgets[position]->isFocusable())
+        {
+            setFocusedWidget(widgets[position]);
+            return;
+        }
+    }
+}
+
+void WidgetPool::setTabNavigation(const bool isEnabled)
+{
+    m_isTabNavigationEnabled = isEnabled;
+}
+
+void WidgetPool::setPointerCapture(Widget* widget)
+{
+    m_pointerCapture = widget;
+}
+
+Widget* WidgetPool::getPointerCapture() const
+{
+    return m_pointerCapture;
+}
+
+void WidgetPool::forceThemeUpdate() const
+{
+    // Fonts may have been loaded since metrics and runs were calculated
+    m_shapedRunCache.clear();
+
+    for (const auto& widget : m_widgets)
+    {
+        if (widget->m_theme != nullptr)
+            widget->m_theme->getTextSettings().refreshFontMetrics();
+    }
+
+    for (const auto& widget : m_widgets)
+        widget->refreshTheme();
+
+    m_needsRedraw = true;
+}
+
+bool WidgetPool::prewarmGlyphs(const sf::Time timeLimit) const
+{
+    sf::Clock clock;
+    std::set <const Theme*> themes;
+
+    for (const auto& widget : m_widgets)
+    {
+        if (widget->m_theme != nullptr)
+            themes.insert(widget->m_theme);
+    }
+
+    for (const auto theme : themes)
+    {
+        const auto elapsedTime = clock.getElapsedTime();
+
+        if (timeLimit != sf::Time::Zero && elapsedTime >= timeLimit)
+            return false;
+
+        if (!theme->prewarmGlyphs(timeLimit == sf::Time::Zero ? timeLimit : timeLimit - elapsedTime))
+            return false;
+    }
+
+    return true;
+}
+
+bool WidgetPool::saveLayoutSnapshot(const std::string& fileName) const
+{
+    LayoutSnapshot snapshot;
+
+    // Every widget has a record, even an empty one, to keep the order
+    for (const auto& widget : m_widgets)
+    {
+        snapshot.beginRecord();
+        widget->saveLayout(snapshot);
+        snapshot.endRecord();
+    }
+
+    return snapshot.saveToFile(fileName);
+}
+
+size_t WidgetPool::loadLayoutSnapshot(const std::string& fileName)
+{
+    LayoutSnapshot snapshot;
+    if (!snapshot.loadFromFile(fileName))
+        return 0;
+
+    size_t restoredCount = 0;
+
+    for (const auto& widget : m_widgets)
+    {
+        if (!snapshot.openRecord())
+            break;
+
+        if (widget->restoreLayout(snapshot))
+            restoredCount++;
+
+        snapshot.closeRecord();
+    }
+
+    return restoredCount;
+}
+
+Widget* WidgetPool::getActiveWidget(const sf::Vector2f& mousePosition) const
+{
+    // Widgets can be drawn upon each other (it should not be made by the user intentionally)
+    // Anyway, the later we draw them, the bigger index they have
+    // We need to select the top widget
+    for (auto it = m_topLevelWidgets.crbegin(); it != m_topLevelWidgets.crend(); it++)
+    {
+        if (const auto widget = findWidgetAt(*it, mousePosition))
+            return widget;
+    }
+
+    return nullptr;
+}
+
+Widget* WidgetPool::findWidgetAt(Widget* widget, const sf::Vector2f& mousePosition) const
+{
+    if (widget->isHidden() || !widget->getSubtreeBounds().contains(mousePosition))
+        return nullptr;
+
+    // Children are drawn over the parent, in scrolled containers they are found in the coordinates of the content
+    if (!widget->m_children.empty())
+    {
+        const auto childPosition = widget->getChildrenTransform().getInverse().transformPoint(mousePosition);
+
+        for (auto it = widget->m_children.crbegin(); it != widget->m_children.crend(); it++)
+        {
+            if (const auto child = findWidgetAt(*it, childPosition))
+                return child;
+        }
+    }
+
+    return widget->getGlobalBounds().contains(mousePosition) ? widget : nullptr;
+}
+
+void WidgetPool::drawSubtree(const Widget& widget, DrawSink& sink, const sf::RenderStates& states, const sf::FloatRect& viewBounds) const
+{
+    if (widget.isHidden())
+        return;
+
+    const auto bounds = widget.getSubtreeBounds();
+
+    if (bounds.left > viewBounds.left + viewBounds.width || bounds.left + bounds.width < viewBounds.left ||
+        bounds.top > viewBounds.top + viewBounds.height || bounds.top + bounds.height < viewBounds.top)
+        return;
+
+    widget.render(sink, states);
+
+    if (widget.m_children.empty())
+        return;
+
+    // Children of a scrolled container are only moved by the transform, their layout stays the same
+    const auto transform = widget.getChildrenTransform();
+    auto childStates = states;
+    childStates.transform *= transform;
+    auto childViewBounds = viewBounds;
+
+    const auto oldView = sink.getView();
+    const auto isClipping = widget.isClippingChildren();
+
+    if (isClipping)
+    {
+        sf::View view;
+
+        if (!viewBounds.intersects(widget.getGlobalBounds(), childViewBounds) ||
+            !Widget::getClipView(sink, states.transform, widget.getGlobalBounds(), view))
+            return;
+
+        sink.setView(view);
+    }
+
+    childViewBounds = transform.getInverse().transformRect(childViewBounds);
+
+    for (const auto child : widget.m_children)
+        drawSubtree(*child, sink, childStates, childViewBounds);
+
+    if (isClipping)
+        sink.setView(oldView);
+}
+
+sf::Vector2f WidgetPool::getLocalPosition(const Widget& widget, const sf::Vector2f& mousePosition) const
+{
+    if (widget.m_parent == nullptr)
+        return mousePosition;
+
+    // Containers are passed from the top-level one, each of them moves the position to the coordinates of its children
+    const auto& parent = *widget.m_parent;
+    const auto parentPosition = getLocalPosition(parent, mousePosition);
+
+    if (parent.isClippingChildren() && !parent.getGlobalBounds().contains(parentPosition))
+        return sf::Vector2f(-std::numeric_limits <float>::max(), -std::numeric_limits <float>::max());
+
+    return parent.getChildrenTransform().getInverse().transformPoint(parentPosition);
+}
+
+void WidgetPool::appendSubtree(Widget* widget, std::vector <Widget*>& widgets) const
+{
+    widgets.push_back(widget);
+
+    for (const auto child : widget->m_children)
+        appendSubtree(child, widgets);
+}
+
+void WidgetPool::render(DrawSink& sink, const sf::RenderStates& states, const bool isFrameShown) const
+{
+    const auto& view = sink.getView();
+    const sf::FloatRect viewBounds(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+
+    // Backgrounds, outlines and icons drawn one after another take one draw call
+    BatchingSink batchingSink(sink, m_batchedVertices);
+
+    for (const auto widget : m_topLevelWidgets)
+        drawSubtree(*widget, batchingSink, states, viewBounds);
+
+    batchingSink.flush();
+
+    if (!isFrameShown)
+        return;
+
+    m_needsRedraw = false;
+
+    // The changes are in this frame, they are shown when it is submitted
+    m_drawnLatencies.insert(m_drawnLatencies.end(), m_pendingLatencies.begin(), m_pendingLatencies.end());
+    m_pendingLatencies.clear();
+}
+
+void WidgetPool::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    RenderTargetSink sink(target);
+    render(sink, states, true);
+}
+
+EventLoop::EventLoop(sf::RenderWindow& window) :
+    m_window(window),
+    m_windowInput(window),
+    m_input(&m_windowInput),
+    m_nextTimerId(0),
+    m_lastFrameTime(sf::Time::Zero),
+    m_activeFrameCount(0),
+    m_idleFrameCount(0)
+{
+    //ctor
+}
+
+EventLoop::~EventLoop()
+{
+    //dtor
+}
+
+bool EventLoop::waitFrame()
+{
+    auto& ui = WidgetPool::getInstance();
+
+    m_events.clear();
+    m_arrivalTimes.clear();
+
+    // Something is waiting to be drawn or applied, so the frame cannot wait
+    if (ui.needsRedraw() || ui.hasPostedUpdates() || !ui.m_changedObservables.empty())
+        pollEvents();
+    else
+        waitEvents();
+
+    // Transitions are advanced before the events: the new ones start on this frame and move on the next
+    const auto frameTime = m_clock.getElapsedTime();
+    ui.updateAnimations(frameTime - m_lastFrameTime);
+    m_lastFrameTime = frameTime;
+
+    ui.applyPostedUpdates();
+
+    if (!m_events.empty())
+        ui.processEvents(m_events, &m_arrivalTimes);
+
+    // Timers are not caused by the events
+    const bool isEventStamped = ui.m_isDispatching;
+    ui.m_isDispatching = false;
+
+    runDueTimers();
+
+    // Actions and timers have changed their values by now, the widgets changed here wait for the last event of the frame
+    ui.m_isDispatching = isEventStamped;
+    ui.applyBindings();
+    ui.m_isDispatching = false;
+
+    if (ui.needsRedraw())
+    {
+        m_activeFrameCount++;
+        return true;
+    }
+
+    m_idleFrameCount++;
+    return false;
+}
+
+void EventLoop::setInputSource(InputSource* source)
+{
+    m_input = (source != nullptr ? source : &m_windowInput);
+
+    // Widgets must see the same mouse as the events
+    WidgetPool::getInstance().setInputSource(source);
+}
+
+const std::vector <sf::Event>& EventLoop::getEvents() const
+{
+    return m_events;
+}
+
+size_t EventLoop::addTimer(const sf::Time interval, const std::function <void()> action, const bool isRepeated)
+{
+    m_timers.push_back({ m_nextTimerId, interval, m_clock.getElapsedTime() + interval, action, isRepeated });
+    return m_nextTimerId++;
+}
+
+void EventLoop::removeTimer(const size_t timerId)
+{
+    const auto isRemoved = [timerId](const Timer& timer) { return timer.id == timerId; };
+    m_timers.erase(std::remove_if(m_timers.begin(), m_timers.end(), isRemoved), m_timers.end());
+}
+
+size_t EventLoop::getActiveFrameCount() const
+{
+    return m_activeFrameCount;
+}
+
+size_t EventLoop::getIdleFrameCount() const
+{
+    return m_idleFrameCount;
+}
+
+bool EventLoop::pollEvents()
+{
+    const auto eventCount = m_events.size();
+    sf::Event event;
+
+    while (m_input->pollEvent(event))
+    {
+        m_events.push_back(event);
+        m_arrivalTimes.push_back(WidgetPool::getInstance().m_latencyClock.getElapsedTime());
+    }
+
+    return m_events.size() > eventCount;
+}
+
+void EventLoop::waitEvents()
+{
+    auto& ui = WidgetPool::getInstance();
+
+    // Without timers and other threads the thread can sleep inside the source until anything happens
+    if (m_timers.empty() && !ui.m_isPostingUsed.load(std::memory_order_relaxed))
+    {
+        sf::Event event;
+
+        if (m_input->waitEvent(event))
+        {
+            m_events.push_back(event);
+            m_arrivalTimes.push_back(ui.m_latencyClock.getElapsedTime());
+            pollEvents();
+        }
+
+        return;
+    }
+
+    // SFML cannot wait with a timeout, so the window is checked in short sleeps until the nearest timer or posted updates
+    const auto pollInterval = sf::milliseconds(10);
+
+    while (m_window.isOpen() && !pollEvents() && !ui.hasPostedUpdates())
+    {
+        auto timeLeft = pollInterval;
+        for (const auto& timer : m_timers)
+            timeLeft = std::min(timeLeft, timer.dueTime - m_clock.getElapsedTime());
+
+        if (timeLeft <= sf::Time::Zero)
+            return;
+
+        sf::sleep(timeLeft);
+    }
+}
+
+void EventLoop::runDueTimers()
+{
+    const auto currentTime = m_clock.getElapsedTime();
+
+    // Actions may add or remove timers, so the timers are searched by identifiers
+    std::vector <size_t> dueTimers;
+    for (const auto& timer : m_timers)
+    {
+        if (timer.dueTime <= currentTime)
+            dueTimers.push_back(timer.id);
+    }
+
+    for (const auto timerId : dueTimers)
+    {
+        const auto isDue = [timerId](const Timer& timer) { return timer.id == timerId; };
+        auto timer = std::find_if(m_timers.begin(), m_timers.end(), isDue);
+
+        if (timer == m_timers.end())
+            continue;
+
+        const auto action = timer->action;
+
+        if (timer->isRepeated)
+            timer->dueTime = std::max(timer->dueTime + timer->interval, currentTime);
+        else
+            m_timers.erase(timer);
+
+        if (action)
+            action();
+    }
+}
+
+Widget::Widget() :
+    m_theme(nullptr),
+    m_state(WidgetState::Idle),
+    m_contentNeedsUpdate(true),
+    m_animationStart(),
+    m_animationProgress(1.0f),
+    m_handle(0),
+    m_parent(nullptr),
+    m_subtreeBoundsNeedUpdate(true)
+{
+    // Every widget follows the mouse, other events are added by widgets that handle them and by actions
+    m_eventMask.set(sf::Event::MouseMoved);
+    m_eventMask.set(sf::Event::MouseButtonPressed);
+    m_eventMask.set(sf::Event::MouseButtonReleased);
+    m_eventMask.set(sf::Event::MouseLeft);
+
+    auto& ui = WidgetPool::getInstance();
+    ui.addWidget(this);
+}
+
+Widget::~Widget()
+{
+    for (const auto observable : m_bindings)
+        observable->removeSubscriber(this);
+
+    auto& ui = WidgetPool::getInstance();
+    ui.removeWidget(this);
+
+    if (m_parent != nullptr)
+    {
+        auto& siblings = m_parent->m_children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+        m_parent->invalidateSubtreeBounds();
+    }
+
+    // Children outlive the parent as top-level widgets
+    for (const auto child : m_children)
+    {
+        child->m_parent = nullptr;
+        child->m_topLevelPosition = ui.m_topLevelWidgets.insert(ui.m_topLevelWidgets.end(), child);
+    }
+}
+
+void Widget::setPosition(const sf::Vector2f& position)
+{
+    m_rectangle.setPosition(position);
+    m_contentNeedsUpdate = true;
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+void Widget::setSize(const sf::Vector2f& size)
+{
+    m_rectangle.setSize(size);
+    m_contentNeedsUpdate = true;
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+void Widget::setTheme(const Theme& theme)
+{
+    m_theme = &theme;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void Widget::setBackgroundTextureRect(const sf::IntRect& rectangle)
+{
+    m_rectangle.setTextureRect(rectangle);
+    invalidate();
+}
+
+void Widget::setAction(const sf::Event::EventType eventType, const std::function <void()> doAction)
+{
+    const auto action = std::find_if(m_doAction.begin(), m_doAction.end(), [eventType](const auto& action)
+    {
+        return action.first == eventType;
+    });
+
+    if (action != m_doAction.end())
+        action->second = doAction;
+    else
+        m_doAction.emplace_back(eventType, doAction);
+
+    m_eventMask.set(eventType);
+}
+
+sf::Vector2f Widget::getPosition() const
+{
+    return m_rectangle.getPosition();
+}
+
+sf::Vector2f Widget::getSize() const
+{
+    return m_rectangle.getSize();
+}
+
+const Theme& Widget::getTheme() const
+{
+    return *m_theme;
+}
+
+sf::IntRect Widget::getBackgroundTextureRect() const
+{
+    return m_rectangle.getTextureRect();
+}
+
+sf::FloatRect Widget::getLocalBounds() const
+{
+    return m_rectangle.getLocalBounds();
+}
+
+sf::FloatRect Widget::getGlobalBounds() const
+{
+    return m_rectangle.getGlobalBounds();
+}
+
+void Widget::show()
+{
+    m_state = WidgetState::Idle;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void Widget::hide()
+{
+    m_state = WidgetState::Hidden;
+    invalidate();
+}
+
+bool Widget::isHidden() const
+{
+    return m_state == WidgetState::Hidden;
+}
+
+const EventMask& Widget::getEventMask() const
+{
+    return m_eventMask;
+}
+
+bool Widget::isFocusable() const
+{
+    return isVisible() && (m_eventMask[sf::Event::TextEntered] || m_eventMask[sf::Event::KeyPressed] || m_eventMask[sf::Event::KeyReleased]);
+}
+
+bool Widget::isFocused() const
+{
+    return WidgetPool::getInstance().getFocusedWidget() == this;
+}
+
+void Widget::addChild(Widget& child)
+{
+    for (auto ancestor = this; ancestor != nullptr; ancestor = ancestor->m_parent)
+    {
+        if (ancestor == &child)
+            return;
+    }
+
+    if (child.m_parent == this)
+        return;
+
+    if (child.m_parent != nullptr)
+        child.m_parent->removeChild(child);
+
+    auto& ui = WidgetPool::getInstance();
+    ui.m_topLevelWidgets.erase(child.m_topLevelPosition);
+
+    child.m_parent = this;
+    m_children.push_back(&child);
+
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+void Widget::removeChild(Widget& child)
+{
+    const auto found = std::find(m_children.begin(), m_children.end(), &child);
+    if (found == m_children.end())
+        return;
+
+    m_children.erase(found);
+    child.m_parent = nullptr;
+
+    auto& ui = WidgetPool::getInstance();
+    child.m_topLevelPosition = ui.m_topLevelWidgets.insert(ui.m_topLevelWidgets.end(), &child);
+
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+Widget* Widget::getParent() const
+{
+    return m_parent;
+}
+
+const std::vector <Widget*>& Widget::getChildren() const
+{
+    return m_children;
+}
+
+bool Widget::isVisible() const
+{
+    for (auto widget = this; widget != nullptr; widget = widget->m_parent)
+    {
+        if (widget->isHidden())
+            return false;
+    }
+
+    return true;
+}
+
+sf::FloatRect Widget::getSubtreeBounds() const
+{
+    if (!m_subtreeBoundsNeedUpdate)
+        return m_subtreeBounds;
+
+    auto bounds = m_rectangle.getGlobalBounds();
+
+    // Children cut by the widget cannot be seen or hovered outside it
+    if (!isClippingChildren())
+    {
+        for (const auto child : m_children)
+        {
+            const auto childBounds = child->getSubtreeBounds();
+
+            const auto right = std::max(bounds.left + bounds.width, childBounds.left + childBounds.width);
+            const auto bottom = std::max(bounds.top + bounds.height, childBounds.top + childBounds.height);
+            bounds.left = std::min(bounds.left, childBounds.left);
+            bounds.top = std::min(bounds.top, childBounds.top);
+            bounds.width = right - bounds.left;
+            bounds.height = bottom - bounds.top;
+        }
+    }
+
+    m_subtreeBounds = bounds;
+    m_subtreeBoundsNeedUpdate = false;
+
+    return m_subtreeBounds;
+}
+
+void Widget::invalidateSubtreeBounds() const
+{
+    // Ancestors of a widget with outdated bounds are outdated too, so the walk stops there
+    for (auto widget = this; widget != nullptr && !widget->m_subtreeBoundsNeedUpdate; widget = widget->m_parent)
+        widget->m_subtreeBoundsNeedUpdate = true;
+}
+
+sf::Transform Widget::getChildrenTransform() const
+{
+    return sf::Transform::Identity;
+}
+
+bool Widget::isClippingChildren() const
+{
+    return false;
+}
+
+bool Widget::getClipView(const DrawSink& sink, const sf::Transform& transform, const sf::FloatRect& bounds, sf::View& view)
+{
+    const auto& currentView = sink.getView();
+    const auto& viewport = currentView.getViewport();
+    const sf::FloatRect viewBounds(currentView.getCenter() - currentView.getSize() / 2.0f, currentView.getSize());
+    const auto area = transform.transformRect(bounds);
+
+    // The area is converted to parts of the target and cut by the current viewport, which may be a clip of a container
+    const auto left = std::max(viewport.left, viewport.left + (area.left - viewBounds.left) / viewBounds.width * viewport.width);
+    const auto top = std::max(viewport.top, viewport.top + (area.top - viewBounds.top) / viewBounds.height * viewport.height);
+    const auto right = std::min(viewport.left + viewport.width,
+                                viewport.left + (area.left + area.width - viewBounds.left) / viewBounds.width * viewport.width);
+    const auto bottom = std::min(viewport.top + viewport.height,
+                                 viewport.top + (area.top + area.height - viewBounds.top) / viewBounds.height * viewport.height);
+
+    if (right <= left || bottom <= top)
+        return false;
+
+    // The view shows the same coordinates as the current one, only in the smaller viewport
+    view.reset(sf::FloatRect(viewBounds.left + (left - viewport.left) / viewport.width * viewBounds.width,
+                             viewBounds.top + (top - viewport.top) / viewport.height * viewBounds.height,
+                             (right - left) / viewport.width * viewBounds.width,
+                             (bottom - top) / viewport.height * viewBounds.height));
+    view.setViewport(sf::FloatRect(left, top, right - left, bottom - top));
+
+    return true;
+}
+
+WidgetHandle Widget::getHandle() const
+{
+    return m_handle;
+}
+
+void Widget::bindHidden(Observable <bool>& isHidden)
+{
+    bind(isHidden, [this, &isHidden]()
+    {
+        if (isHidden.get() == this->isHidden())
+            return;
+
+        if (isHidden.get())
+            hide();
+        else
+            show();
+    });
+}
+
+void Widget::bind(ObservableBase& observable, const std::function <void()> update)
+{
+    observable.m_subscribers.push_back({ this, update });
+    m_bindings.push_back(&observable);
+
+    update();
+}
+
+void Widget::forceThemeUpdate() const
+{
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void Widget::invalidate() const
+{
+    auto& pool = WidgetPool::getInstance();
+    pool.requestRedraw();
+    pool.trackInvalidation(*this);
+}
+
+void Widget::refreshTheme() const
+{
+    if (m_theme == nullptr)
+        return;
+
+    refreshRectangleTheme();
+}
+
+void Widget::refreshRectangleTheme() const
+{
+    const auto decorationSettings = getCurrentDecorationSettings();
+
+    if (decorationSettings == nullptr)
+        return;
+
+    const auto colors = getAnimatedColors(*decorationSettings);
+
+    // The outline is a part of the global bounds
+    if (m_rectangle.getOutlineThickness() != colors.outlineThickness)
+    {
+        m_rectangle.setOutlineThickness(colors.outlineThickness);
+        invalidateSubtreeBounds();
+    }
+
+    m_rectangle.setFillColor(colors.fillColor);
+    m_rectangle.setOutlineColor(colors.outlineColor);
+    m_rectangle.setTexture(decorationSettings->getBackgroundTexture());
+}
+
+void Widget::refreshColors() const
+{
+    refreshRectangleTheme();
+}
+
+Widget::DecorationColors Widget::getAnimatedColors(const DecorationSettings& decorationSettings) const
+{
+    DecorationColors colors = { decorationSettings.getFillColor(),
+                                decorationSettings.getTextColor(),
+                                decorationSettings.getOutlineColor(),
+                                decorationSettings.getOutlineThickness() };
+
+    if (m_animationProgress >= 1.0f)
+        return colors;
+
+    const auto mix = [this](const sf::Color& start, const sf::Color& end)
+    {
+        const auto mixChannel = [this](const sf::Uint8 a, const sf::Uint8 b)
+        {
+            return static_cast <sf::Uint8>(std::round(a + (b - a) * m_animationProgress));
+        };
+
+        return sf::Color(mixChannel(start.r, end.r), mixChannel(start.g, end.g), mixChannel(start.b, end.b), mixChannel(start.a, end.a));
+    };
+
+    colors.fillColor = mix(m_animationStart.fillColor, colors.fillColor);
+    colors.textColor = mix(m_animationStart.textColor, colors.textColor);
+    colors.outlineColor = mix(m_animationStart.outlineColor, colors.outlineColor);
+    colors.outlineThickness = m_animationStart.outlineThickness + (colors.outlineThickness - m_animationStart.outlineThickness) * m_animationProgress;
+
+    return colors;
+}
+
+const DecorationSettings* Widget::getCurrentDecorationSettings() const
+{
+    switch (m_state)
+    {
+        case WidgetState::Idle:
+            return &(m_theme->getIdleColorSettings());
+
+        case WidgetState::Hovered:
+            return &(m_theme->getHoveredColorSettings());
+
+        case WidgetState::Pressed:
+            return &(m_theme->getPressedColorSettings());
+
+        default:
+            return nullptr;
+    }
+}
+
+void Widget::changeState(const WidgetState state)
+{
+    if (m_state == state)
+        return;
+
+    const auto decorationSettings = (m_theme != nullptr ? getCurrentDecorationSettings() : nullptr);
+
+    // The transition starts from the colors being shown, even if the previous one has not finished
+    if (decorationSettings != nullptr && m_theme->getTransitionDuration() > sf::Time::Zero)
+    {
+        m_animationStart = getAnimatedColors(*decorationSettings);
+        m_animationProgress = 0.0f;
+        WidgetPool::getInstance().startAnimation(this);
+    }
+
+    m_state = state;
+    refreshTheme();
+    invalidate();
+}
+
+void Widget::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    RenderTargetSink sink(target);
+    render(sink, states);
+}
+
+void Widget::render(DrawSink& sink, sf::RenderStates states) const
+{
+    drawRectangle(sink, states);
+}
+
+void Widget::drawRectangle(DrawSink& sink, sf::RenderStates states) const
+{
+    sink.drawRectangle(m_rectangle, states);
+}
+
+void Widget::saveLayout(LayoutSnapshot&) const
+{
+    // The rectangle is set by the user, there is nothing to calculate
+}
+
+bool Widget::restoreLayout(LayoutSnapshot&)
+{
+    return false;
+}
+
+void Widget::reportMemory(MemoryReport& report) const
+{
+    const std::string type = getTypeName();
+
+    report.addWidget(type, getObjectSize());
+    reportComponents(report, type);
+}
+
+const char* Widget::getTypeName() const
+{
+    return "Widget";
+}
+
+size_t Widget::getObjectSize() const
+{
+    return sizeof(Widget);
+}
+
+void Widget::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    report.addComponent(type, "actions", m_doAction.capacity() * sizeof(decltype(m_doAction)::value_type));
+    report.addComponent(type, "children", m_children.capacity() * sizeof(Widget*));
+    report.addComponent(type, "bindings", m_bindings.capacity() * sizeof(ObservableBase*));
+
+    // A node in the list of all widgets, a node in the list of top-level ones, and a node with a bucket in the handle map
+    const auto listNodeSize = sizeof(Widget*) + 2 * sizeof(void*);
+    const auto handleNodeSize = sizeof(std::pair <const WidgetHandle, Widget*>) + 2 * sizeof(void*);
+    report.addComponent(type, "pool", listNodeSize * (m_parent == nullptr ? 2 : 1) + handleNodeSize);
+}
+
+// Every event outside resets the widget, the click is done on release inside
+const Widget::TransitionTable Widget::m_transitions =
+{
+    // MouseLeft: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false } }
+    },
+    // LeftButtonPressed: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false } }
+    },
+    // OtherButtonPressedOrReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // MouseMoved: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // TextEntered: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // OtherInput: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    }
+};
+
+void Widget::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+{
+    if (m_state == WidgetState::Hidden)
+        return;
+
+    const bool isMouseInside = m_rectangle.getGlobalBounds().contains(mousePosition);
+    const auto& transition = getTransitionTable()[getInputKind(event)][isMouseInside][static_cast <size_t>(m_state)];
+
+    if (transition.hasEffect)
+        applyTransitionEffect(event);
+
+    changeState(transition.state);
+
+    if (transition.callsAction)
+        doAction(event.type);
+}
+
+const Widget::TransitionTable& Widget::getTransitionTable() const
+{
+    return m_transitions;
+}
+
+void Widget::applyTransitionEffect(const sf::Event&)
+{
+    // Simple widgets only change their state
+}
+
+void Widget::changeFocus(const bool)
+{
+    // Simple widgets look the same with the focus
+}
+
+Widget::InputKind Widget::getInputKind(const sf::Event& event)
+{
+    switch (event.type)
+    {
+        case sf::Event::MouseLeft:
+            return MouseLeft;
+
+        case sf::Event::MouseButtonPressed:
+            return event.mouseButton.button == sf::Mouse::Left ? LeftButtonPressed : OtherButtonPressedOrReleased;
+
+        case sf::Event::MouseButtonReleased:
+            return event.mouseButton.button == sf::Mouse::Left ? LeftButtonReleased : OtherButtonPressedOrReleased;
+
+        case sf::Event::MouseMoved:
+            return MouseMoved;
+
+        case sf::Event::TextEntered:
+            return TextEntered;
+
+        default:
+            return OtherInput;
+    }
+}
+
+void Widget::doAction(const sf::Event::EventType eventType)
+{
+    const auto action = std::find_if(m_doAction.cbegin(), m_doAction.cend(), [eventType](const auto& action)
+    {
+        return action.first == eventType;
+    });
+
+    if (action != m_doAction.cend() && action->second != nullptr)
+        action->second();
+}
+
+const sf::String TextBasedWidget::m_wordSeparators = L" \n\t";
+
+TextBasedWidget::TextBasedWidget() :
+    Widget(),
+    m_padding(5.0f, 10.0f),
+    m_isMultiline(false),
+    m_isTrimmable(true),
+    m_distanceFieldVerticesNeedUpdate(true)
+{
+    //ctor
+}
+
+TextBasedWidget::~TextBasedWidget()
+{
+    //dtor
+}
+
+void TextBasedWidget::setSizeFitToText()
+{
+    updateTextSplitting();
+    refreshTheme();
+
+    float width = m_padding.x * 2;
+    float lineWidth = 0.0f;
+
+    for (const auto& line : m_lines)
+    {
+        const auto bounds = getScaledBounds(line);
+        lineWidth = std::max(lineWidth, bounds.left + bounds.width);
+    }
+
+    width += lineWidth;
+
+    float height = m_padding.y * 2;
+    height += m_theme->getTextSettings().getFontMetrics().fullHeight * m_lines.size();
+
+    setSize({ width, height });
+    placeText();
+
+    m_contentNeedsUpdate = false;
+}
+
+void TextBasedWidget::setString(const sf::String& text)
+{
+    m_string = text;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void TextBasedWidget::setString(sf::String&& text)
+{
+    m_string = std::move(text);
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void TextBasedWidget::setUtf8String(const std::string_view text)
+{
+    // The old storage is reused, and single characters fit in the small string buffer of the temporary
+    m_string.clear();
+
+    for (auto begin = text.begin(); begin != text.end();)
+    {
+        sf::Uint32 codePoint = 0;
+        begin = sf::Utf8::decode(begin, text.end(), codePoint);
+        m_string += codePoint;
+    }
+
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void TextBasedWidget::setPadding(const sf::Vector2f& padding)
+{
+    m_padding = padding;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void TextBasedWidget::setMultilined(bool isMultiline)
+{
+    m_isMultiline = isMultiline;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void TextBasedWidget::setPosition(const sf::Vector2f& position)
+{
+    m_rectangle.setPosition(position);
+    m_contentNeedsUpdate = true;
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+void TextBasedWidget::refreshTheme() const
+{
+    if (m_theme == nullptr)
+        return;
+
+    refreshRectangleTheme();
+    refreshTextTheme();
+
+    m_contentNeedsUpdate = true;
+}
+
+void TextBasedWidget::refreshColors() const
+{
+    refreshRectangleTheme();
+    refreshTextTheme();
+}
+
+void TextBasedWidget::refreshTextTheme() const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto decorationSettings = getCurrentDecorationSettings();
+
+    if (decorationSettings == nullptr)
+        return;
+
+    const auto textColor = getAnimatedColors(*decorationSettings).textColor;
+
+    for (auto& line : m_lines)
+    {
+        line.setFont(textSettings.getFont());
+        line.setCharacterSize(textSettings.getGlyphCharacterSize());
+        line.setScale(textSettings.getGlyphScale(), textSettings.getGlyphScale());
+        line.setFillColor(textColor);
+        line.setStyle(decorationSettings->getTextStyle());
+    }
+
+    m_distanceFieldVerticesNeedUpdate = true;
+}
+
+const sf::String& TextBasedWidget::getString() const
+{
+    return m_string;
+}
+
+bool TextBasedWidget::isMultiline() const
+{
+    return m_isMultiline;
+}
+
+size_t TextBasedWidget::findFirstWordSeparatorPosition(size_t begin) const
+{
+    for (; begin < m_string.getSize(); begin++)
+    {
+        for (size_t i = 0; i < m_wordSeparators.getSize(); i++)
+        {
+            if (m_string[begin] == m_wordSeparators[i])
+                return begin;
+        }
+    }
+
+    return sf::String::InvalidPos;
+}
+
+void TextBasedWidget::updateContent() const
+{
+    if (!m_contentNeedsUpdate)
+        return;
+
+    updateTextSplitting();
+    refreshTheme();
+    placeText();
+
+    m_contentNeedsUpdate = false;
+}
+
+void TextBasedWidget::updateTextSplitting() const
+{
+    if (!m_isMultiline)
+    {
+        size_t begin = 0;
+        size_t end = m_string.getSize();
+
+        if (m_isTrimmable)
+            trimRange(begin, end);
+
+        setLine(0, begin, end);
+        m_lines.resize(1);
+
+        return;
+    }
+
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto maxWidth = (m_rectangle.getSize().x - 2 * m_padding.x) / textSettings.getGlyphScale();
+
+    // The whole string is measured once and parts of it are measured from the positions of their characters.
+    // The string changes with every key typed, so it is measured into the widget and not into the shared cache
+    ShapedRunCache::measure(m_string, textSettings.getFont(), textSettings.getGlyphCharacterSize(), sf::Text::Regular, m_splittingRun);
+    const auto& run = m_splittingRun;
+
+    // Words are kept as parts of the string in the arena, so splitting does not use the heap once the arena has grown
+    struct Word
+    {
+        size_t begin;           //!< Index of the first character
+        size_t end;             //!< Index after the last character
+        sf::Uint32 separator;   //!< Separator after the word, '\n' if the word was split, zero at the end of the string
+    };
+
+    auto& arena = WidgetPool::getInstance().getScratchArena();
+    arena.reset();
+
+    std::pmr::vector <Word> words(&arena);
+
+    for (size_t beginPosition = 0, endPosition = 0; beginPosition < m_string.getSize();)
+    {
+        Word word = { beginPosition, 0, 0 };
+        endPosition = findFirstWordSeparatorPosition(beginPosition);
+
+        if (endPosition == sf::String::InvalidPos)
+            endPosition = m_string.getSize();
+        else
+            word.separator = m_string[endPosition];
+
+        word.end = endPosition;
+
+        // Split very long words that do not fit the rectangle at all
+        for (; beginPosition < endPosition; beginPosition++)
+        {
+            if (getCharacterRight(run, word.begin, beginPosition) > maxWidth)
+                break;
+        }
+
+        if (beginPosition < endPosition)
+        {
+            // At least one character is taken, otherwise the word would never end
+            if (beginPosition == word.begin)
+                beginPosition++;
+
+            word.end = beginPosition;
+            word.separator = '\n';
+        }
+        else
+            beginPosition = endPosition + 1;
+
+        words.push_back(word);
+    }
+
+    // Lines are parts of the string too: words follow each other with one separator between them
+    size_t lineCount = 0;
+    size_t lineBegin = 0;
+    size_t lineEnd = 0;
+    size_t measuredEnd = 0;
+    float lineRight = 0.0f;
+    bool isLineEmpty = true;
+    bool isLineReady = false;
+
+    for (size_t i = 0; i < words.size();)
+    {
+        const auto& word = words[i];
+
+        if (isLineEmpty)
+        {
+            lineBegin = word.begin;
+            lineEnd = word.begin;
+            measuredEnd = word.begin;
+            lineRight = 0.0f;
+            isLineEmpty = false;
+        }
+
+        // Only the characters added since the previous word are measured
+        for (; measuredEnd < word.end; measuredEnd++)
+            lineRight = std::max(lineRight, getCharacterRight(run, lineBegin, measuredEnd));
+
+        if (lineRight > maxWidth && lineEnd > lineBegin)
+            isLineReady = true;
+        else if (i + 1 == words.size())
+        {
+            lineEnd = word.end;
+            if (word.separator != 0 && word.separator != '\n')
+                lineEnd++;
+
+            isLineReady = true;
+            i++;
+        }
+        else
+        {
+            lineEnd = word.end;
+            if (word.separator == '\n')
+                isLineReady = true;
+            else
+                lineEnd++;
+
+            i++;
+        }
+
+        if (isLineReady)
+        {
+            if (m_isTrimmable)
+                trimRange(lineBegin, lineEnd);
+
+            setLine(lineCount++, lineBegin, lineEnd);
+
+            isLineEmpty = true;
+            isLineReady = false;
+        }
+    }
+
+    // Lines are kept with their storage and only the extra ones are removed
+    m_lines.resize(lineCount);
+}
+
+void TextBasedWidget::trimRange(size_t& begin, size_t& end) const
+{
+    const auto isSeparator = [](const sf::Uint32 character)
+    {
+        return std::find(m_wordSeparators.begin(), m_wordSeparators.end(), character) != m_wordSeparators.end();
+    };
+
+    const auto first = std::find_if_not(m_string.begin() + begin, m_string.begin() + end, isSeparator) - m_string.begin();
+
+    // Parts made of separators only are kept as they are
+    if (static_cast <size_t>(first) == end)
+        return;
+
+    begin = first;
+
+    while (isSeparator(m_string[end - 1]))
+        end--;
+}
+
+float TextBasedWidget::getCharacterRight(const ShapedRunCache::ShapedRun& run, const size_t begin, const size_t index) const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto& font = textSettings.getFont();
+    const auto characterSize = textSettings.getGlyphCharacterSize();
+
+    // Kerning with the character before the part is already in the position of its first character
+    const auto character = m_string[index];
+    const auto x = run.positions[index] - run.positions[begin];
+
+    if (character == U'\r' || character == U'\n')
+        return 0.0f;
+
+    if (character == U' ' || character == U'\t')
+        return x + font.getGlyph(U' ', characterSize, false).advance * (character == U'\t' ? 4 : 1);
+
+    const auto& glyph = font.getGlyph(character, characterSize, false);
+    return x + glyph.bounds.left + glyph.bounds.width;
+}
+
+void TextBasedWidget::setLine(const size_t index, const size_t begin, const size_t end) const
+{
+    if (index == m_lines.size())
+        m_lines.emplace_back();
+
+    // The whole string is copied at once into the storage of the line
+    if (begin == 0 && end == m_string.getSize())
+    {
+        m_lines[index].setString(m_string);
+        return;
+    }
+
+    // Single characters fit in the small string buffer, so the line storage is the only memory used
+    m_lineString.clear();
+
+    for (auto i = begin; i < end; i++)
+        m_lineString += m_string[i];
+
+    m_lines[index].setString(m_lineString);
+}
+
+void TextBasedWidget::placeText() const
+{
+    const auto position = m_rectangle.getPosition();
+    const auto size = m_rectangle.getSize();
+
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto horizontalAlignment = textSettings.getHorizontalAlignment();
+    const auto verticalAlignment = textSettings.getVerticalAlignment();
+    const auto& metrics = textSettings.getFontMetrics();
+
+    sf::Vector2f textPosition;
+
+    for (size_t i = 0; i < m_lines.size(); i++)
+    {
+        const auto bounds = getScaledBounds(m_lines[i]);
+
+        switch (horizontalAlignment)
+        {
+            case TextHorizontalAlignment::Left:
+                textPosition.x = position.x + m_padding.x;
+                break;
+
+            case TextHorizontalAlignment::Center:
+                textPosition.x = position.x + (size.x - bounds.width) / 2.0f - bounds.left;
+                break;
+
+            case TextHorizontalAlignment::Right:
+                textPosition.x = position.x + size.x - m_padding.x - bounds.left - bounds.width;
+                break;
+        }
+
+        switch (verticalAlignment)
+        {
+            case TextVerticalAlignment::Top:
+                textPosition.y = position.y + m_padding.y + i * metrics.fullHeight;
+                break;
+
+            case TextVerticalAlignment::Center:
+                textPosition.y = position.y + (size.y - m_lines.size() * metrics.fullHeight - metrics.ascenderLine + metrics.descenderLine) / 2.0f + i * metrics.fullHeight;
+                break;
+
+            case TextVerticalAlignment::Bottom:
+                textPosition.y = position.y + size.y - m_padding.y - (m_lines.size() - i) * metrics.fullHeight - metrics.ascenderLine + metrics.descenderLine;
+                break;
+        }
+
+        // If coordinates are not integer, the text gets blurred
+        textPosition.x = std::round(textPosition.x);
+        textPosition.y = std::round(textPosition.y);
+        m_lines[i].setPosition(textPosition);
+    }
+
+    m_distanceFieldVerticesNeedUpdate = true;
+}
+
+void TextBasedWidget::drawText(DrawSink& sink, sf::RenderStates states) const
+{
+    // Clip text
+    auto bounds = m_rectangle.getGlobalBounds();
+    bounds.left += m_padding.x;
+    bounds.top += m_padding.y;
+    bounds.width -= m_padding.x * 2;
+    bounds.height -= m_padding.y * 2;
+
+    sf::View view;
+    if (!getClipView(sink, states.transform, bounds, view))
+        return;
+
+    const auto oldView = sink.getView();
+    sink.setView(view);
+
+    const auto distanceFieldFont = m_theme->getTextSettings().getDistanceFieldFont();
+
+    if (distanceFieldFont != nullptr && distanceFieldFont->getShader() != nullptr)
+    {
+        if (m_distanceFieldVerticesNeedUpdate)
+        {
+            // Arrays are kept to reuse their memory
+            for (auto& batch : m_distanceFieldVertices)
+                batch.second.clear();
+
+            for (const auto& line : m_lines)
+                distanceFieldFont->appendText(line, m_distanceFieldVertices);
+
+            m_distanceFieldVerticesNeedUpdate = false;
+        }
+
+        states.shader = distanceFieldFont->getShader();
+
+        for (const auto& batch : m_distanceFieldVertices)
+        {
+            states.texture = batch.first;
+            sink.drawVertices(batch.second, states);
+        }
+    }
+    else
+    {
+        for (const auto& line : m_lines)
+            sink.drawGlyphRun(line, states);
+    }
+
+    sink.setView(oldView);
+}
+
+sf::FloatRect TextBasedWidget::getScaledBounds(const sf::Text& text)
+{
+    if (text.getFont() == nullptr)
+        return sf::FloatRect();
+
+    // The same labels are measured many times across lists and tables
+    auto& cache = WidgetPool::getInstance().getShapedRunCache();
+    const auto& bounds = cache.getRun(text.getString(), *text.getFont(), text.getCharacterSize(), text.getStyle()).bounds;
+    const auto scale = text.getScale();
+
+    return sf::FloatRect(bounds.left * scale.x, bounds.top * scale.y, bounds.width * scale.x, bounds.height * scale.y);
+}
+
+void TextBasedWidget::saveLayout(LayoutSnapshot& snapshot) const
+{
+    // Hidden widgets are laid out again when they are shown. Without the font hash, another font with the same name could take the layout
+    if (m_theme == nullptr || m_state == WidgetState::Hidden || m_theme->getTextSettings().getFontHash() == 0)
+        return;
+
+    updateContent();
+
+    snapshot.write(getLayoutFingerprint());
+    snapshot.write(static_cast <sf::Uint32>(m_lines.size()));
+
+    for (const auto& line : m_lines)
+    {
+        snapshot.writeString(line.getString());
+        snapshot.write(line.getPosition());
+    }
+}
+
+void TextBasedWidget::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    Widget::reportComponents(report, type);
+
+    // sf::Text keeps a copy of its string and six vertices for each glyph
+    auto linesSize = m_lines.capacity() * sizeof(sf::Text);
+    for (const auto& line : m_lines)
+        linesSize += line.getString().getSize() * (sizeof(sf::Uint32) + 6 * sizeof(sf::Vertex));
+
+    size_t distanceFieldSize = 0;
+    for (const auto& batch : m_distanceFieldVertices)
+        distanceFieldSize += sizeof(batch) + batch.second.getVertexCount() * sizeof(sf::Vertex);
+
+    report.addComponent(type, "text lines", linesSize);
+    report.addComponent(type, "string", (m_string.getSize() + m_lineString.getSize()) * sizeof(sf::Uint32));
+    report.addComponent(type, "distance field", distanceFieldSize);
+}
+
+bool TextBasedWidget::restoreLayout(LayoutSnapshot& snapshot)
+{
+    if (m_theme == nullptr || m_state == WidgetState::Hidden || m_theme->getTextSettings().getFontHash() == 0)
+        return false;
+
+    sf::Uint64 fingerprint = 0;
+    sf::Uint32 lineCount = 0;
+
+    if (!snapshot.read(fingerprint) || fingerprint != getLayoutFingerprint())
+        return false;
+
+    // Each line contains at least one character of the string
+    if (!snapshot.read(lineCount) || lineCount > m_string.getSize() + 1)
+        return false;
+
+    std::vector <sf::Text> lines(lineCount);
+
+    for (auto& line : lines)
+    {
+        sf::String string;
+        sf::Vector2f position;
+
+        if (!snapshot.readString(string) || !snapshot.read(position))
+            return false;
+
+        line.setString(string);
+        line.setPosition(position);
+    }
+
+    m_lines = std::move(lines);
+
+    // The layout is known, only the style must be applied
+    refreshRectangleTheme();
+    refreshTextTheme();
+    m_contentNeedsUpdate = false;
+
+    return true;
+}
+
+sf::Uint64 TextBasedWidget::getLayoutFingerprint() const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto fontHash = textSettings.getFontHash();
+    const auto characterSize = textSettings.getCharacterSize();
+    const auto glyphCharacterSize = textSettings.getGlyphCharacterSize();
+    const auto horizontalAlignment = textSettings.getHorizontalAlignment();
+    const auto verticalAlignment = textSettings.getVerticalAlignment();
+    const auto textStyle = getCurrentDecorationSettings()->getTextStyle();
+    const auto position = m_rectangle.getPosition();
+    const auto size = m_rectangle.getSize();
+    const bool flags[] = { m_isMultiline, m_isTrimmable };
+
+    auto hash = LayoutSnapshot::hash(&fontHash, sizeof(fontHash));
+    hash = LayoutSnapshot::hash(&characterSize, sizeof(characterSize), hash);
+    hash = LayoutSnapshot::hash(&glyphCharacterSize, sizeof(glyphCharacterSize), hash);
+    hash = LayoutSnapshot::hash(&horizontalAlignment, sizeof(horizontalAlignment), hash);
+    hash = LayoutSnapshot::hash(&verticalAlignment, sizeof(verticalAlignment), hash);
+    hash = LayoutSnapshot::hash(&textStyle, sizeof(textStyle), hash);
+    hash = LayoutSnapshot::hash(&position, sizeof(position), hash);
+    hash = LayoutSnapshot::hash(&size, sizeof(size), hash);
+    hash = LayoutSnapshot::hash(&m_padding, sizeof(m_padding), hash);
+    hash = LayoutSnapshot::hash(flags, sizeof(flags), hash);
+    hash = LayoutSnapshot::hash(m_string.getData(), m_string.getSize() * sizeof(sf::Uint32), hash);
+
+    return hash;
+}
+
+void TextBasedWidget::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden)
+        return;
+
+    updateContent();
+
+    drawRectangle(sink, states);
+    drawText(sink, states);
+}
+
+PushButton::PushButton() : TextBasedWidget()
+{
+    //ctor
+}
+
+PushButton::~PushButton()
+{
+    //dtor
+}
+
+const char* PushButton::getTypeName() const
+{
+    return "PushButton";
+}
+
+size_t PushButton::getObjectSize() const
+{
+    return sizeof(PushButton);
+}
+
+IconButton::IconButton() :
+    Widget(),
+    m_isIconTextureRectSet(false)
+{
+    //ctor
+}
+
+IconButton::~IconButton()
+{
+    //dtor
+}
+
+const char* IconButton::getTypeName() const
+{
+    return "IconButton";
+}
+
+size_t IconButton::getObjectSize() const
+{
+    return sizeof(IconButton);
+}
+
+void IconButton::setPosition(const sf::Vector2f& position)
+{
+    m_rectangle.setPosition(position);
+    m_icon.setPosition(position);
+    m_contentNeedsUpdate = true;
+    invalidateSubtreeBounds();
+    invalidate();
+}
+
+void IconButton::setSize(const sf::Vector2f& size)
+{
+    m_rectangle.setSize(size);
+    invalidateSubtreeBounds();
+
+    // Icon resize is delayed because we cannot ensure that the programmer use methods in the right order
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void IconButton::setIconTexture(const sf::Texture& texture)
+{
+    m_icon.setTexture(texture);
+    m_iconTextureSize = texture.getSize();
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void IconButton::setIconTextureRect(const sf::IntRect& rectangle)
+{
+    m_icon.setTextureRect(rectangle);
+    m_isIconTextureRectSet = true;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+const sf::Texture* IconButton::getIconTexture() const
+{
+    return m_icon.getTexture();
+}
+
+sf::IntRect IconButton::getIconTextureRect() const
+{
+    return m_icon.getTextureRect();
+}
+
+void IconButton::updateSpriteSize() const
+{
+    const auto bounds = m_icon.getLocalBounds();
+    const auto size = m_rectangle.getSize();
+
+    // An empty icon is not drawn and cannot be scaled
+    if (bounds.width + bounds.left <= 0.0f || bounds.height + bounds.top <= 0.0f)
+        return;
+
+    sf::Vector2f factor;
+
+    factor.x = size.x / (bounds.width + bounds.left);
+    factor.y = size.y / (bounds.height + bounds.top);
+
+    m_icon.setScale(factor);
+}
+
+void IconButton::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden)
+        return;
+
+    // A texture given while loading had no size, so the whole texture is taken once it is loaded
+    const auto texture = m_icon.getTexture();
+    if (texture != nullptr && texture->getSize() != m_iconTextureSize)
+    {
+        m_iconTextureSize = texture->getSize();
+
+        if (!m_isIconTextureRectSet)
+            m_icon.setTextureRect(sf::IntRect(0, 0, m_iconTextureSize.x, m_iconTextureSize.y));
+
+        m_contentNeedsUpdate = true;
+    }
+
+    if (m_contentNeedsUpdate)
+    {
+        refreshTheme();
+        updateSpriteSize();
+        m_contentNeedsUpdate = false;
+    }
+
+    sink.drawRectangle(m_rectangle, states);
+
+    // The texture may be still loading
+    if (m_icon.getTexture() != nullptr && m_icon.getTexture()->getSize().x > 0)
+        sink.drawSprite(m_icon, states);
+}
+
+Panel::Panel() : Widget()
+{
+    //ctor
+}
+
+Panel::~Panel()
+{
+    //dtor
+}
+
+const char* Panel::getTypeName() const
+{
+    return "Panel";
+}
+
+size_t Panel::getObjectSize() const
+{
+    return sizeof(Panel);
+}
+
+void Panel::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden || m_theme == nullptr)
+        return;
+
+    if (m_contentNeedsUpdate)
+    {
+        refreshTheme();
+        m_contentNeedsUpdate = false;
+    }
+
+    sink.drawRectangle(m_rectangle, states);
+}
+
+ScrollPanel::ScrollPanel() : Panel(), m_scrollOffset(0.0f, 0.0f), m_scrollStep(48.0f)
+{
+    m_eventMask.set(sf::Event::MouseWheelScrolled);
+}
+
+ScrollPanel::~ScrollPanel()
+{
+    //dtor
+}
+
+const char* ScrollPanel::getTypeName() const
+{
+    return "ScrollPanel";
+}
+
+size_t ScrollPanel::getObjectSize() const
+{
+    return sizeof(ScrollPanel);
+}
+
+void ScrollPanel::setScrollOffset(const sf::Vector2f& offset)
+{
+    // The content can be scrolled until its far border reaches the border of the panel
+    const auto bounds = m_rectangle.getGlobalBounds();
+    const auto content = getContentBounds();
+
+    const auto maxOffsetX = std::max(0.0f, content.left + content.width - bounds.left - bounds.width);
+    const auto maxOffsetY = std::max(0.0f, content.top + content.height - bounds.top - bounds.height);
+    const sf::Vector2f newOffset(std::clamp(offset.x, 0.0f, maxOffsetX), std::clamp(offset.y, 0.0f, maxOffsetY));
+
+    if (newOffset == m_scrollOffset)
+        return;
+
+    // Only the transform changes: children are neither moved nor laid out again
+    m_scrollOffset = newOffset;
+    invalidate();
+}
+
+const sf::Vector2f& ScrollPanel::getScrollOffset() const
+{
+    return m_scrollOffset;
+}
+
+void ScrollPanel::setScrollStep(const float step)
+{
+    m_scrollStep = step;
+}
+
+sf::FloatRect ScrollPanel::getContentBounds() const
+{
+    if (m_children.empty())
+        return m_rectangle.getGlobalBounds();
+
+    auto bounds = m_children.front()->getSubtreeBounds();
+
+    for (const auto child : m_children)
+    {
+        const auto childBounds = child->getSubtreeBounds();
+
+        const auto right = std::max(bounds.left + bounds.width, childBounds.left + childBounds.width);
+        const auto bottom = std::max(bounds.top + bounds.height, childBounds.top + childBounds.height);
+        bounds.left = std::min(bounds.left, childBounds.left);
+        bounds.top = std::min(bounds.top, childBounds.top);
+        bounds.width = right - bounds.left;
+        bounds.height = bottom - bounds.top;
+    }
+
+    return bounds;
+}
+
+sf::Transform ScrollPanel::getChildrenTransform() const
+{
+    sf::Transform transform;
+    transform.translate(-m_scrollOffset);
+
+    return transform;
+}
+
+bool ScrollPanel::isClippingChildren() const
+{
+    return true;
+}
+
+void ScrollPanel::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+{
+    if (event.type == sf::Event::MouseWheelScrolled && m_state != WidgetState::Hidden && m_rectangle.getGlobalBounds().contains(mousePosition))
+    {
+        // Scrolling up shows the upper part of the content, the horizontal wheel moves it sideways
+        auto offset = m_scrollOffset;
+
+        if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
+            offset.y -= event.mouseWheelScroll.delta * m_scrollStep;
+        else
+            offset.x -= event.mouseWheelScroll.delta * m_scrollStep;
+
+        setScrollOffset(offset);
+    }
+
+    Widget::processEvent(event, mousePosition);
+}
+
+DropDownList::DropDownList() : TextBasedWidget(), m_isOpened(false)
+{
+    // Items are children of the panel, so they are hidden all at once
+    addChild(m_itemPanel);
+    m_itemPanel.hide();
+}
+
+DropDownList::~DropDownList()
+{
+    //dtor
+}
+
+const char* DropDownList::getTypeName() const
+{
+    return "DropDownList";
+}
+
+size_t DropDownList::getObjectSize() const
+{
+    // The panel of items is a widget, it reports itself
+    return sizeof(DropDownList) - sizeof(Panel);
+}
+
+void DropDownList::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    TextBasedWidget::reportComponents(report, type);
+
+    // Items are widgets and report themselves, only the links of the list are counted
+    report.addComponent(type, "items", m_items.size() * 2 * sizeof(void*));
+}
+
+void DropDownList::addListItem(const sf::String& label, const std::function <void()> doAction)
+{
+    const auto x = getPosition().x;
+    const auto y = (m_items.empty() ?
+                    getGlobalBounds().top + getGlobalBounds().height :
+                    m_items.back().getGlobalBounds().top + m_items.back().getGlobalBounds().height);
+
+    m_items.emplace_back();
+
+    m_items.back().setString(label);
+    m_items.back().setAction(sf::Event::MouseButtonReleased, doAction);
+    m_items.back().setTheme(*m_itemsTheme);
+    m_items.back().setPadding(m_padding);
+    m_items.back().setPosition({x, y});
+    m_items.back().setSizeFitToText();
+
+    const auto longestItem = max_element(m_items.cbegin(), m_items.cend(), [](const PushButton& a, const PushButton& b)
+    {
+        return a.getSize().x < b.getSize().x;
+    });
+
+    const auto width = longestItem->getSize().x;
+    const auto height = longestItem->getSize().y;
+
+    for (auto& item : m_items)
+        item.setSize({width, height});
+
+    m_itemPanel.addChild(m_items.back());
+
+    const auto top = m_items.front().getPosition().y;
+    m_itemPanel.setPosition({x, top});
+    m_itemPanel.setSize({width, m_items.back().getPosition().y + height - top});
+}
+
+void DropDownList::showItems()
+{
+    m_itemPanel.show();
+    m_isOpened = true;
+}
+
+void DropDownList::hideItems()
+{
+    m_itemPanel.hide();
+    m_isOpened = false;
+}
+
+void DropDownList::setItemsTheme(const Theme& theme)
+{
+    m_itemsTheme = &theme;
+    for (auto& item : m_items)
+        item.setTheme(theme);
+}
+
+// A click on the pressed list shows the items
+const Widget::TransitionTable DropDownList::m_closedTransitions =
+{
+    // MouseLeft: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonPressed: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, true } }
+    },
+    // OtherButtonPressedOrReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // MouseMoved: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // TextEntered: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // OtherInput: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    }
+};
+
+// The list stays pressed while the items are shown, any click hides them
+const Widget::TransitionTable DropDownList::m_openedTransitions =
+{
+    // MouseLeft: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonPressed: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, true }, { WidgetState::Idle, true, true }, { WidgetState::Idle, true, true } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, true } }
+    },
+    // OtherButtonPressedOrReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // MouseMoved: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // TextEntered: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // OtherInput: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    }
+};
+
+const Widget::TransitionTable& DropDownList::getTransitionTable() const
+{
+    return m_isOpened ? m_openedTransitions : m_closedTransitions;
+}
+
+void DropDownList::applyTransitionEffect(const sf::Event&)
+{
+    if (m_isOpened)
+        hideItems();
+    else
+        showItems();
+}
+
+void DropDownList::changeFocus(const bool isFocused)
+{
+    if (isFocused || !m_isOpened)
+        return;
+
+    hideItems();
+
+    if (m_state != WidgetState::Hidden)
+        changeState(WidgetState::Idle);
+}
+
+TextBox::TextBox() : TextBasedWidget(), m_maxInputLength(sf::String::InvalidPos)
+{
+    m_isTrimmable = false;
+    m_eventMask.set(sf::Event::TextEntered);
+}
+
+TextBox::~TextBox()
+{
+    //dtor
+}
+
+const char* TextBox::getTypeName() const
+{
+    return "TextBox";
+}
+
+size_t TextBox::getObjectSize() const
+{
+    return sizeof(TextBox);
+}
+
+size_t TextBox::getMaxInputLength() const
+{
+    return m_maxInputLength;
+}
+
+void TextBox::setMaxInputLength(const size_t maxInputLength)
+{
+    m_maxInputLength = maxInputLength;
+}
+
+// The text box stays pressed until a click outside, the text is typed only while it is pressed
+const Widget::TransitionTable TextBox::m_transitions =
+{
+    // MouseLeft: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonPressed: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // OtherButtonPressedOrReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // MouseMoved: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // TextEntered: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, true, true } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, true, true } }
+    },
+    // OtherInput: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    }
+};
+
+const Widget::TransitionTable& TextBox::getTransitionTable() const
+{
+    return m_transitions;
+}
+
+void TextBox::changeFocus(const bool isFocused)
+{
+    if (m_state == WidgetState::Hidden)
+        return;
+
+    if (isFocused)
+        changeState(WidgetState::Pressed);
+    else if (m_state == WidgetState::Pressed)
+        changeState(WidgetState::Idle);
+}
+
+void TextBox::applyTransitionEffect(const sf::Event& event)
+{
+    // Process backspace
+    if (event.text.unicode == '\b')
+    {
+        if (!m_string.isEmpty())
+            m_string.erase(m_string.getSize() - 1);
+    }
+    else if (m_string.getSize() < m_maxInputLength)
+    {
+        if (event.text.unicode != '\r')
+            m_string += event.text.unicode;
+        else
+            m_string += '\n';
+    }
+
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+CheckBox::CheckBox() : TextBasedWidget(), m_isChecked(false)
+{
+    // Set the default checkmark
+    m_string = L"X";
+}
+
+CheckBox::~CheckBox()
+{
+    //dtor
+}
+
+const char* CheckBox::getTypeName() const
+{
+    return "CheckBox";
+}
+
+size_t CheckBox::getObjectSize() const
+{
+    return sizeof(CheckBox);
+}
+
+bool CheckBox::isChecked() const
+{
+    return m_isChecked;
+}
+
+void CheckBox::setChecked(const bool isChecked)
+{
+    m_isChecked = isChecked;
+    invalidate();
+}
+
+void CheckBox::bindChecked(Observable <bool>& isChecked)
+{
+    bind(isChecked, [this, &isChecked]()
+    {
+        if (isChecked.get() != m_isChecked)
+            setChecked(isChecked.get());
+    });
+}
+
+// Like a simple widget, but the checkmark is toggled by the release after the press
+const Widget::TransitionTable CheckBox::m_transitions =
+{
+    // MouseLeft: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Idle, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonPressed: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // LeftButtonReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Hovered, true, true } }
+    },
+    // OtherButtonPressedOrReleased: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, false, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // MouseMoved: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Hovered, true, false }, { WidgetState::Hovered, false, false }, { WidgetState::Pressed, false, false } }
+    },
+    // TextEntered: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    },
+    // OtherInput: mouse outside, mouse inside
+    {
+        { { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false }, { WidgetState::Idle, false, false } },
+        { { WidgetState::Idle, true, false }, { WidgetState::Hovered, true, false }, { WidgetState::Pressed, true, false } }
+    }
+};
+
+const Widget::TransitionTable& CheckBox::getTransitionTable() const
+{
+    return m_transitions;
+}
+
+void CheckBox::applyTransitionEffect(const sf::Event&)
+{
+    setChecked(!m_isChecked);
+}
+
+void CheckBox::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden)
+        return;
+
+    updateContent();
+
+    drawRectangle(sink, states);
+
+    if (m_isChecked)
+        drawText(sink, states);
+}
+
+StaticText::StaticText() : TextBasedWidget()
+{
+    // Static text handles no events
+    m_eventMask.reset();
+}
+
+StaticText::~StaticText()
+{
+    //dtor
+}
+
+const char* StaticText::getTypeName() const
+{
+    return "StaticText";
+}
+
+size_t StaticText::getObjectSize() const
+{
+    return sizeof(StaticText);
+}
+
+void StaticText::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+{
+    // Static text does nothing
+    return;
+}
+
+DataGrid::DataGrid() :
+    Widget(),
+    m_rowCount(0),
+    m_columnWidthsNeedUpdate(true),
+    m_cellPadding(4.0f, 2.0f),
+    m_scrollOffset(0.0),
+    m_textColor(sf::Color::Black)
+{
+    m_headerVertices.setPrimitiveType(sf::Triangles);
+    m_eventMask.set(sf::Event::MouseWheelScrolled);
+}
+
+DataGrid::~DataGrid()
+{
+    //dtor
+}
+
+const char* DataGrid::getTypeName() const
+{
+    return "DataGrid";
+}
+
+size_t DataGrid::getObjectSize() const
+{
+    return sizeof(DataGrid);
+}
+
+void DataGrid::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    Widget::reportComponents(report, type);
+
+    auto headersSize = m_headers.capacity() * sizeof(sf::String) + m_headerVertices.getVertexCount() * sizeof(sf::Vertex);
+    for (const auto& header : m_headers)
+        headersSize += header.getSize() * sizeof(sf::Uint32);
+
+    auto rowsSize = m_rows.size() * sizeof(Row);
+    for (const auto& row : m_rows)
+        rowsSize += row.vertices.getVertexCount() * sizeof(sf::Vertex);
+
+    report.addComponent(type, "headers", headersSize);
+    report.addComponent(type, "columns", (m_columnWidths.capacity() + m_measuredWidths.capacity()) * sizeof(float));
+    report.addComponent(type, "rows", rowsSize);
+}
+
+void DataGrid::setDataSource(const DataSource dataSource)
+{
+    m_dataSource = dataSource;
+    m_rows.clear();
+    m_columnWidthsNeedUpdate = true;
+    invalidate();
+}
+
+void DataGrid::setRowCount(const size_t rowCount)
+{
+    m_rowCount = rowCount;
+
+    // Rows that do not exist anymore are dropped on drawing
+    invalidate();
+}
+
+void DataGrid::setColumnCount(const size_t columnCount)
+{
+    m_headers.resize(columnCount);
+    m_columnWidths.resize(columnCount, 0.0f);
+    m_columnWidthsNeedUpdate = true;
+    invalidate();
+}
+
+void DataGrid::setColumnHeader(const size_t column, const sf::String& header)
+{
+    if (column >= m_headers.size())
+        return;
+
+    m_headers[column] = header;
+    m_columnWidthsNeedUpdate = true;
+    invalidate();
+}
+
+void DataGrid::setColumnWidth(const size_t column, const float width)
+{
+    if (column >= m_columnWidths.size())
+        return;
+
+    m_columnWidths[column] = width;
+    m_columnWidthsNeedUpdate = true;
+    invalidate();
+}
+
+void DataGrid::setCellPadding(const sf::Vector2f& padding)
+{
+    m_cellPadding = padding;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void DataGrid::setScrollOffset(const double offset)
+{
+    auto clampedOffset = std::max(0.0, offset);
+
+    if (m_theme != nullptr)
+        clampedOffset = std::min(clampedOffset, getMaxScrollOffset());
+
+    if (clampedOffset == m_scrollOffset)
+        return;
+
+    m_scrollOffset = clampedOffset;
+    invalidate();
+}
+
+void DataGrid::scrollToRow(const size_t row)
+{
+    setScrollOffset(static_cast <double>(row) * getRowHeight());
+}
+
+void DataGrid::refreshData()
+{
+    m_rows.clear();
+    invalidate();
+}
+
+size_t DataGrid::getRowCount() const
+{
+    return m_rowCount;
+}
+
+size_t DataGrid::getColumnCount() const
+{
+    return m_columnWidths.size();
+}
+
+float DataGrid::getColumnWidth(const size_t column) const
+{
+    if (m_theme != nullptr && m_columnWidthsNeedUpdate)
+        updateColumnWidths();
+
+    if (column < m_measuredWidths.size())
+        return m_measuredWidths[column];
+
+    return column < m_columnWidths.size() ? m_columnWidths[column] : 0.0f;
+}
+
+float DataGrid::getRowHeight() const
+{
+    if (m_theme == nullptr)
+        return 0.0f;
+
+    return m_theme->getTextSettings().getFontMetrics().fullHeight + 2 * m_cellPadding.y;
+}
+
+double DataGrid::getScrollOffset() const
+{
+    return m_scrollOffset;
+}
+
+size_t DataGrid::getRowAt(const sf::Vector2f& point) const
+{
+    const auto rowHeight = getRowHeight();
+    const auto bounds = m_rectangle.getGlobalBounds();
+    const auto rowsTop = bounds.top + getHeaderHeight();
+
+    if (rowHeight <= 0.0f || !bounds.contains(point) || point.y < rowsTop)
+        return NoRow;
+
+    const auto row = static_cast <size_t>((point.y - rowsTop + m_scrollOffset) / rowHeight);
+    return row < m_rowCount ? row : NoRow;
+}
+
+void DataGrid::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+{
+    const auto rowsPerWheelStep = 3.0;
+
+    // The grid also gets events as the last clicked widget, so the mouse must be checked
+    if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel &&
+        m_state != WidgetState::Hidden && m_rectangle.getGlobalBounds().contains(mousePosition))
+    {
+        setScrollOffset(m_scrollOffset - event.mouseWheelScroll.delta * rowsPerWheelStep * getRowHeight());
+    }
+
+    Widget::processEvent(event, mousePosition);
+}
+
+float DataGrid::getHeaderHeight() const
+{
+    const auto hasHeader = std::any_of(m_headers.begin(), m_headers.end(), [](const sf::String& header) { return !header.isEmpty(); });
+    return hasHeader ? getRowHeight() : 0.0f;
+}
+
+double DataGrid::getMaxScrollOffset() const
+{
+    const auto rowsHeight = static_cast <double>(m_rowCount) * getRowHeight();
+    const auto visibleHeight = static_cast <double>(m_rectangle.getSize().y - getHeaderHeight());
+
+    return std::max(0.0, rowsHeight - visibleHeight);
+}
+
+void DataGrid::getVisibleRows(size_t& first, size_t& last) const
+{
+    const double rowHeight = getRowHeight();
+    const auto visibleHeight = std::max(0.0, static_cast <double>(m_rectangle.getSize().y - getHeaderHeight()));
+
+    if (rowHeight <= 0.0 || m_rowCount == 0)
+    {
+        first = last = 0;
+        return;
+    }
+
+    first = std::min(m_rowCount, static_cast <size_t>(m_scrollOffset / rowHeight));
+    last = std::min(m_rowCount, static_cast <size_t>(std::ceil((m_scrollOffset + visibleHeight) / rowHeight)));
+}
+
+void DataGrid::updateColumnWidths() const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+    auto& cache = WidgetPool::getInstance().getShapedRunCache();
+
+    const auto measure = [this, &textSettings, &cache](const sf::String& string, const sf::Uint32 style)
+    {
+        const auto& bounds = cache.getRun(string, textSettings.getFont(), textSettings.getCharacterSize(), style).bounds;
+        return bounds.left + bounds.width + 2 * m_cellPadding.x;
+    };
+
+    // Only the rows visible now are measured, so the widths do not depend on the number of rows
+    size_t firstRow = 0;
+    size_t lastRow = 0;
+    getVisibleRows(firstRow, lastRow);
+
+    m_measuredWidths = m_columnWidths;
+
+    for (size_t column = 0; column < m_measuredWidths.size(); column++)
+    {
+        if (m_measuredWidths[column] > 0.0f)
+            continue;
+
+        auto width = measure(m_headers[column], sf::Text::Bold);
+
+        for (auto row = firstRow; row < lastRow && m_dataSource; row++)
+            width = std::max(width, measure(m_dataSource(row, column), sf::Text::Regular));
+
+        m_measuredWidths[column] = width;
+    }
+
+    m_columnWidthsNeedUpdate = false;
+}
+
+void DataGrid::updateRows() const
+{
+    size_t first = 0;
+    size_t last = 0;
+    getVisibleRows(first, last);
+
+    while (!m_rows.empty() && m_rows.front().index < first)
+        m_rows.pop_front();
+
+    while (!m_rows.empty() && m_rows.back().index >= last)
+        m_rows.pop_back();
+
+    if (m_rows.empty())
+    {
+        for (auto row = first; row < last; row++)
+            m_rows.push_back(buildRow(row));
+
+        return;
+    }
+
+    // Rows that stay visible are kept as they are
+    for (auto row = m_rows.front().index; row > first; row--)
+        m_rows.push_front(buildRow(row - 1));
+
+    for (auto row = m_rows.back().index + 1; row < last; row++)
+        m_rows.push_back(buildRow(row));
+}
+
+DataGrid::Row DataGrid::buildRow(const size_t index) const
+{
+    Row row;
+    row.index = index;
+    row.vertices.setPrimitiveType(sf::Triangles);
+
+    if (!m_dataSource)
+        return row;
+
+    float left = 0.0f;
+
+    for (size_t column = 0; column < m_measuredWidths.size(); column++)
+    {
+        appendCell(row.vertices, m_dataSource(index, column), left, m_measuredWidths[column], sf::Text::Regular);
+        left += m_measuredWidths[column];
+    }
+
+    return row;
+}
+
+void DataGrid::appendCell(sf::VertexArray& vertices, const sf::String& string, const float left, const float width, const sf::Uint32 style) const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto& font = textSettings.getFont();
+    const auto characterSize = textSettings.getCharacterSize();
+    const bool isBold = (style & sf::Text::Bold) != 0;
+
+    // Positions are shared with measuring, so identical cells are shaped once
+    const auto& run = WidgetPool::getInstance().getShapedRunCache().getRun(string, font, characterSize, style);
+
+    const auto right = left + width - m_cellPadding.x;
+    const auto y = m_cellPadding.y + static_cast <float>(characterSize);
+
+    for (size_t i = 0; i < string.getSize(); i++)
+    {
+        const auto codePoint = string[i];
+        if (codePoint == L' ' || codePoint == L'\t' || codePoint == L'\n')
+            continue;
+
+        const auto& glyph = font.getGlyph(codePoint, characterSize, isBold);
+        const auto x = left + m_cellPadding.x + run.positions[i];
+
+        // The rest of the text does not fit the column
+        if (x + glyph.bounds.left + glyph.bounds.width > right)
+            break;
+
+        appendGlyphQuad(vertices, glyph.bounds, glyph.textureRect, sf::Vector2f(x, y), m_textColor);
+    }
+}
+
+void DataGrid::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden || m_theme == nullptr)
+        return;
+
+    // The font or its size may have changed
+    if (m_contentNeedsUpdate)
+    {
+        refreshTheme();
+        m_columnWidthsNeedUpdate = true;
+        m_contentNeedsUpdate = false;
+    }
+
+    if (m_columnWidthsNeedUpdate)
+    {
+        updateColumnWidths();
+        m_rows.clear();
+        m_headerVertices.clear();
+    }
+
+    // Colors of built rows are changed in place, for example, on hovering
+    const auto textColor = getAnimatedColors(*getCurrentDecorationSettings()).textColor;
+
+    if (textColor != m_textColor)
+    {
+        m_textColor = textColor;
+
+        for (auto& row : m_rows)
+        {
+            for (size_t i = 0; i < row.vertices.getVertexCount(); i++)
+                row.vertices[i].color = textColor;
+        }
+
+        for (size_t i = 0; i < m_headerVertices.getVertexCount(); i++)
+            m_headerVertices[i].color = textColor;
+    }
+
+    m_scrollOffset = std::min(m_scrollOffset, getMaxScrollOffset());
+    updateRows();
+
+    const auto headerHeight = getHeaderHeight();
+
+    if (headerHeight > 0.0f && m_headerVertices.getVertexCount() == 0)
+    {
+        float left = 0.0f;
+
+        for (size_t column = 0; column < m_headers.size(); column++)
+        {
+            appendCell(m_headerVertices, m_headers[column], left, m_measuredWidths[column], sf::Text::Bold);
+            left += m_measuredWidths[column];
+        }
+    }
+
+    sink.drawRectangle(m_rectangle, states);
+
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto& font = textSettings.getFont();
+    const auto characterSize = textSettings.getCharacterSize();
+    const auto position = m_rectangle.getPosition();
+    const auto size = m_rectangle.getSize();
+    const double rowHeight = getRowHeight();
+
+    // Clip cells by the widget, rows also by the header
+    const auto oldView = sink.getView();
+
+    // Parts cut off by a scrolled container are skipped
+    const auto setClip = [&sink, &states, &oldView](const sf::FloatRect& bounds)
+    {
+        sf::View view;
+        sink.setView(oldView);
+
+        if (!getClipView(sink, states.transform, bounds, view))
+            return false;
+
+        sink.setView(view);
+        return true;
+    };
+
+    if (setClip(sf::FloatRect(position.x, position.y, size.x, headerHeight)))
+    {
+        auto headerStates = states;
+        headerStates.texture = &font.getTexture(characterSize);
+        headerStates.transform.translate(position);
+        sink.drawVertices(m_headerVertices, headerStates);
+    }
+
+    if (setClip(sf::FloatRect(position.x, position.y + headerHeight, size.x, size.y - headerHeight)))
+    {
+        for (const auto& row : m_rows)
+        {
+            // Rows are only moved: the offset is subtracted in double, the result is small enough for float
+            const auto top = static_cast <float>(static_cast <double>(row.index) * rowHeight - m_scrollOffset);
+
+            auto rowStates = states;
+            rowStates.texture = &font.getTexture(characterSize);
+            rowStates.transform.translate(position.x, position.y + headerHeight + top);
+            sink.drawVertices(row.vertices, rowStates);
+        }
+    }
+
+    sink.setView(oldView);
+}
+
+LogConsole::LogConsole(const size_t capacity) :
+    Widget(),
+    m_firstEntry(0),
+    m_capacity(std::max <size_t>(capacity, 1)),
+    m_wrappedLineCount(0),
+    m_wrapWidth(-1.0f),
+    m_scrollOffset(0),
+    m_isAutoScrolling(true),
+    m_padding(4.0f, 4.0f),
+    m_verticesNeedUpdate(true),
+    m_textColor(sf::Color::Black)
+{
+    m_vertices.setPrimitiveType(sf::Triangles);
+    m_eventMask.set(sf::Event::MouseWheelScrolled);
+}
+
+LogConsole::~LogConsole()
+{
+    //dtor
+}
+
+const char* LogConsole::getTypeName() const
+{
+    return "LogConsole";
+}
+
+size_t LogConsole::getObjectSize() const
+{
+    return sizeof(LogConsole);
+}
+
+void LogConsole::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    Widget::reportComponents(report, type);
+
+    auto entriesSize = m_entries.capacity() * sizeof(Entry);
+    for (const auto& entry : m_entries)
+        entriesSize += entry.line.getSize() * sizeof(sf::Uint32) + entry.wrapPositions.capacity() * sizeof(size_t);
+
+    report.addComponent(type, "entries", entriesSize);
+    report.addComponent(type, "advances", m_advances.capacity() * sizeof(float));
+    report.addComponent(type, "glyphs", m_vertices.getVertexCount() * sizeof(sf::Vertex));
+}
+
+void LogConsole::appendLine(const sf::String& line)
+{
+    // Lines are wrapped at once if the width is known, otherwise all of them are wrapped on drawing
+    const bool canWrap = (m_theme != nullptr && m_wrapWidth >= 0.0f && !m_contentNeedsUpdate);
+    size_t addedLineCount = 0;
+
+    for (size_t begin = 0; begin <= line.getSize();)
+    {
+        auto end = line.find(L"\n", begin);
+        if (end == sf::String::InvalidPos)
+            end = line.getSize();
+
+        Entry* entry = nullptr;
+
+        if (m_entries.size() < m_capacity)
+        {
+            m_entries.emplace_back();
+            entry = &m_entries.back();
+        }
+        else
+        {
+            // The oldest entry is reused for the newest line
+            entry = &m_entries[m_firstEntry];
+            m_wrappedLineCount -= entry->wrapPositions.size();
+            m_firstEntry = (m_firstEntry + 1) % m_entries.size();
+        }
+
+        entry->line = line.substring(begin, end - begin);
+        entry->wrapPositions.clear();
+
+        if (canWrap)
+            wrapEntry(*entry);
+
+        m_wrappedLineCount += entry->wrapPositions.size();
+        addedLineCount += entry->wrapPositions.size();
+
+        begin = end + 1;
+    }
+
+    if (m_isAutoScrolling)
+        m_scrollOffset = 0;
+    else
+        m_scrollOffset += addedLineCount;
+
+    m_verticesNeedUpdate = true;
+    invalidate();
+}
+
+void LogConsole::clear()
+{
+    m_entries.clear();
+    m_firstEntry = 0;
+    m_wrappedLineCount = 0;
+    m_scrollOffset = 0;
+    m_verticesNeedUpdate = true;
+    invalidate();
+}
+
+void LogConsole::setCapacity(const size_t capacity)
+{
+    m_capacity = std::max <size_t>(capacity, 1);
+
+    // Entries are put in order, so the ring starts from the beginning again
+    const auto keptCount = std::min(m_entries.size(), m_capacity);
+    std::vector <Entry> entries;
+    entries.reserve(keptCount);
+
+    for (auto i = m_entries.size() - keptCount; i < m_entries.size(); i++)
+        entries.push_back(std::move(getEntry(i)));
+
+    m_entries = std::move(entries);
+    m_firstEntry = 0;
+
+    m_wrappedLineCount = 0;
+    for (const auto& entry : m_entries)
+        m_wrappedLineCount += entry.wrapPositions.size();
+
+    m_verticesNeedUpdate = true;
+    invalidate();
+}
+
+void LogConsole::setAutoScrolling(const bool isAutoScrolling)
+{
+    m_isAutoScrolling = isAutoScrolling;
+
+    if (m_isAutoScrolling)
+        setScrollOffset(0);
+}
+
+void LogConsole::setPadding(const sf::Vector2f& padding)
+{
+    m_padding = padding;
+    m_contentNeedsUpdate = true;
+    invalidate();
+}
+
+void LogConsole::setScrollOffset(const size_t offset)
+{
+    const auto visibleLineCount = getVisibleLineCount();
+    const auto maxOffset = (m_wrappedLineCount > visibleLineCount ? m_wrappedLineCount - visibleLineCount : 0);
+
+    m_scrollOffset = std::min(offset, maxOffset);
+    m_verticesNeedUpdate = true;
+    invalidate();
+}
+
+size_t LogConsole::getLineCount() const
+{
+    return m_entries.size();
+}
+
+size_t LogConsole::getCapacity() const
+{
+    return m_capacity;
+}
+
+const sf::String& LogConsole::getLine(const size_t index) const
+{
+    return getEntry(index).line;
+}
+
+bool LogConsole::isAutoScrolling() const
+{
+    return m_isAutoScrolling;
+}
+
+size_t LogConsole::getScrollOffset() const
+{
+    return m_scrollOffset;
+}
+
+void LogConsole::processEvent(const sf::Event event, const sf::Vector2f& mousePosition)
+{
+    const auto linesPerWheelStep = 3.0f;
+
+    if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel &&
+        m_state != WidgetState::Hidden && m_rectangle.getGlobalBounds().contains(mousePosition))
+    {
+        // Scrolling up shows older lines
+        const auto step = static_cast <long long>(std::round(event.mouseWheelScroll.delta * linesPerWheelStep));
+        setScrollOffset(static_cast <size_t>(std::max(0ll, static_cast <long long>(m_scrollOffset) + step)));
+    }
+
+    Widget::processEvent(event, mousePosition);
+}
+
+LogConsole::Entry& LogConsole::getEntry(const size_t index) const
+{
+    return m_entries[(m_firstEntry + index) % m_entries.size()];
+}
+
+void LogConsole::wrapEntry(Entry& entry) const
+{
+    const auto& line = entry.line;
+    entry.wrapPositions.assign(1, 0);
+
+    // Kerning is skipped: logs are usually monospaced, and it is too slow for thousands of lines per frame
+    float x = 0.0f;
+    size_t lastBreak = 0;
+
+    for (size_t i = 0; i < line.getSize(); i++)
+    {
+        const auto codePoint = line[i];
+        const auto advance = getAdvance(codePoint);
+
+        // Spaces may go beyond the border, words are moved to the next line
+        if (codePoint == L' ' || codePoint == L'\t')
+        {
+            x += advance;
+            lastBreak = i + 1;
+            continue;
+        }
+
+        if (x + advance > m_wrapWidth && i > entry.wrapPositions.back())
+        {
+            // The word is split only if it is longer than the line
+            const auto wrapPosition = (lastBreak > entry.wrapPositions.back() ? lastBreak : i);
+            entry.wrapPositions.push_back(wrapPosition);
+
+            // The carried part is measured again from the start of the new line, tabs included
+            x = 0.0f;
+            for (auto j = wrapPosition; j < i; j++)
+                x += getAdvance(line[j]);
+        }
+
+        x += advance;
+    }
+}
+
+float LogConsole::getAdvance(const sf::Uint32 codePoint) const
+{
+    const auto& textSettings = m_theme->getTextSettings();
+
+    if (codePoint >= 256)
+        return textSettings.getFont().getGlyph(codePoint, textSettings.getCharacterSize(), false).advance;
+
+    if (m_advances.empty())
+        m_advances.resize(256, -1.0f);
+
+    if (m_advances[codePoint] < 0.0f)
+    {
+        if (codePoint == L'\t')
+            m_advances[codePoint] = getAdvance(L' ') * 4;
+        else
+            m_advances[codePoint] = textSettings.getFont().getGlyph(codePoint, textSettings.getCharacterSize(), false).advance;
+    }
+
+    return m_advances[codePoint];
+}
+
+size_t LogConsole::getVisibleLineCount() const
+{
+    if (m_theme == nullptr)
+        return 0;
+
+    const auto lineHeight = m_theme->getTextSettings().getFontMetrics().fullHeight;
+    const auto height = m_rectangle.getSize().y - 2 * m_padding.y;
+
+    return (lineHeight > 0.0f && height > 0.0f) ? static_cast <size_t>(height / lineHeight) : 0;
+}
+
+void LogConsole::updateVertices() const
+{
+    m_vertices.clear();
+
+    const auto visibleLineCount = getVisibleLineCount();
+    const auto& textSettings = m_theme->getTextSettings();
+    const auto& font = textSettings.getFont();
+    const auto characterSize = textSettings.getCharacterSize();
+    const auto lineHeight = textSettings.getFontMetrics().fullHeight;
+
+    // Visible lines are searched from the newest one, whole entries are skipped while scrolled
+    std::vector <std::pair <size_t, size_t>> visibleLines;
+    visibleLines.reserve(visibleLineCount);
+
+    size_t skippedCount = 0;
+
+    for (auto i = m_entries.size(); i > 0 && visibleLines.size() < visibleLineCount; i--)
+    {
+        const auto& entry = getEntry(i - 1);
+
+        if (skippedCount + entry.wrapPositions.size() <= m_scrollOffset)
+        {
+            skippedCount += entry.wrapPositions.size();
+            continue;
+        }
+
+        for (auto j = entry.wrapPositions.size(); j > 0 && visibleLines.size() < visibleLineCount; j--)
+        {
+            if (skippedCount < m_scrollOffset)
+                skippedCount++;
+            else
+                visibleLines.emplace_back(i - 1, j - 1);
+        }
+    }
+
+    const auto position = m_rectangle.getPosition();
+
+    for (size_t k = 0; k < visibleLines.size(); k++)
+    {
+        const auto& visibleLine = visibleLines[visibleLines.size() - 1 - k];
+        const auto& entry = getEntry(visibleLine.first);
+        const auto begin = entry.wrapPositions[visibleLine.second];
+        const auto end = (visibleLine.second + 1 < entry.wrapPositions.size() ? entry.wrapPositions[visibleLine.second + 1] : entry.line.getSize());
+
+        float x = position.x + m_padding.x;
+        const float y = position.y + m_padding.y + k * lineHeight + characterSize;
+
+        for (auto i = begin; i < end; i++)
+        {
+            const auto codePoint = entry.line[i];
+
+            if (codePoint == L' ' || codePoint == L'\t')
+            {
+                x += getAdvance(codePoint);
+                continue;
+            }
+
+            const auto& glyph = font.getGlyph(codePoint, characterSize, false);
+            appendGlyphQuad(m_vertices, glyph.bounds, glyph.textureRect, sf::Vector2f(x, y), m_textColor);
+
+            x += glyph.advance;
+        }
+    }
+
+    m_verticesNeedUpdate = false;
+}
+
+void LogConsole::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden || m_theme == nullptr)
+        return;
+
+    // The font, its size or the width may have changed, so everything is wrapped again
+    if (m_contentNeedsUpdate)
+    {
+        refreshTheme();
+        m_advances.clear();
+        m_wrapWidth = -1.0f;
+        m_contentNeedsUpdate = false;
+    }
+
+    const auto size = m_rectangle.getSize();
+    const auto wrapWidth = std::max(0.0f, size.x - 2 * m_padding.x);
+
+    if (wrapWidth != m_wrapWidth)
+    {
+        m_wrapWidth = wrapWidth;
+        m_wrappedLineCount = 0;
+
+        for (auto& entry : m_entries)
+        {
+            wrapEntry(entry);
+            m_wrappedLineCount += entry.wrapPositions.size();
+        }
+
+        m_verticesNeedUpdate = true;
+    }
+
+    const auto textColor = getAnimatedColors(*getCurrentDecorationSettings()).textColor;
+
+    if (textColor != m_textColor)
+    {
+        m_textColor = textColor;
+        m_verticesNeedUpdate = true;
+    }
+
+    const auto visibleLineCount = getVisibleLineCount();
+    m_scrollOffset = std::min(m_scrollOffset, m_wrappedLineCount > visibleLineCount ? m_wrappedLineCount - visibleLineCount : 0);
+
+    if (m_verticesNeedUpdate)
+        updateVertices();
+
+    sink.drawRectangle(m_rectangle, states);
+
+    // Clip text
+    auto bounds = m_rectangle.getGlobalBounds();
+    bounds.left += m_padding.x;
+    bounds.top += m_padding.y;
+    bounds.width -= m_padding.x * 2;
+    bounds.height -= m_padding.y * 2;
+
+    sf::View view;
+    if (!getClipView(sink, states.transform, bounds, view))
+        return;
+
+    const auto oldView = sink.getView();
+    sink.setView(view);
+
+    const auto& textSettings = m_theme->getTextSettings();
+    states.texture = &textSettings.getFont().getTexture(textSettings.getCharacterSize());
+    sink.drawVertices(m_vertices, states);
+
+    sink.setView(oldView);
+}
+
+Plot::Plot(const size_t capacity) :
+    Widget(),
+    m_capacity(std::max <size_t>(capacity, 1)),
+    m_minimum(0.0f),
+    m_maximum(1.0f),
+    m_columnCount(0),
+    m_columnWidth(1.0f),
+    m_samplesPerColumn(1),
+    m_columnsNeedUpdate(true)
+{
+    //ctor
+}
+
+Plot::~Plot()
+{
+    //dtor
+}
+
+const char* Plot::getTypeName() const
+{
+    return "Plot";
+}
+
+size_t Plot::getObjectSize() const
+{
+    return sizeof(Plot);
+}
+
+void Plot::reportComponents(MemoryReport& report, const std::string& type) const
+{
+    Widget::reportComponents(report, type);
+
+    auto samplesSize = m_series.capacity() * sizeof(Series);
+    size_t columnsSize = 0;
+
+    for (const auto& series : m_series)
+    {
+        samplesSize += series.samples.capacity() * sizeof(float);
+        columnsSize += series.columns.capacity() * sizeof(Column) + series.vertices.capacity() * sizeof(sf::Vertex);
+    }
+
+    report.addComponent(type, "samples", samplesSize);
+    report.addComponent(type, "columns", columnsSize);
+}
+
+size_t Plot::addSeries(const sf::Color& color)
+{
+    m_series.emplace_back();
+
+    auto& series = m_series.back();
+    series.color = color;
+    series.samples.resize(m_capacity);
+    series.sampleCount = 0;
+
+    m_columnsNeedUpdate = true;
+    invalidate();
+
+    return m_series.size() - 1;
+}
+
+void Plot::addSample(const size_t series, const float value)
+{
+    if (series >= m_series.size() || std::isnan(value))
+        return;
+
+    auto& target = m_series[series];
+    const auto sampleIndex = target.sampleCount++;
+    target.samples[sampleIndex % m_capacity] = value;
+
+    // Columns are made from all samples on drawing if they are out of date
+    if (!m_columnsNeedUpdate)
+        addToColumn(target, sampleIndex, value);
+
+    invalidate();
+}
+
+void Plot::clear()
+{
+    for (auto& series : m_series)
+        series.sampleCount = 0;
+
+    m_columnsNeedUpdate = true;
+    invalidate();
+}
+
+void Plot::setRange(const float minimum, const float maximum)
+{
+    m_minimum = minimum;
+    m_maximum = maximum;
+    m_columnsNeedUpdate = true;
+    invalidate();
+}
+
+void Plot::setSeriesColor(const size_t series, const sf::Color& color)
+{
+    if (series >= m_series.size())
+        return;
+
+    auto& target = m_series[series];
+    target.color = color;
+
+    for (size_t i = 0; i < target.vertices.size(); i++)
+    {
+        if (target.columns[i / 4].index != NoColumn)
+            target.vertices[i].color = color;
+    }
+
+    invalidate();
+}
+
+size_t Plot::getSeriesCount() const
+{
+    return m_series.size();
+}
+
+size_t Plot::getCapacity() const
+{
+    return m_capacity;
+}
+
+sf::Uint64 Plot::getSampleCount(const size_t series) const
+{
+    return series < m_series.size() ? m_series[series].sampleCount : 0;
+}
+
+float Plot::getMinimum() const
+{
+    return m_minimum;
+}
+
+float Plot::getMaximum() const
+{
+    return m_maximum;
+}
+
+void Plot::addToColumn(Series& series, const sf::Uint64 sampleIndex, const float value) const
+{
+    const auto columnIndex = sampleIndex / m_samplesPerColumn;
+    const auto slot = static_cast <size_t>(columnIndex % m_columnCount);
+    auto& column = series.columns[slot];
+
+    if (column.index != columnIndex)
+        column = { columnIndex, value, value, value, value };
+    else
+    {
+        column.last = value;
+        column.minimum = std::min(column.minimum, value);
+        column.maximum = std::max(column.maximum, value);
+    }
+
+    // The column is a vertical line from its minimum to its maximum,
+    // and it is joined with the last sample of the previous column
+    const auto x = (slot + 0.5f) * m_columnWidth;
+    auto top = getY(column.maximum);
+    auto bottom = getY(column.minimum);
+
+    // Lines shorter than a pixel may be not drawn at all
+    if (bottom - top < 1.0f)
+        bottom = top + 1.0f;
+
+    const auto& previous = series.columns[(slot + m_columnCount - 1) % m_columnCount];
+    const auto hasPrevious = (columnIndex > 0 && previous.index == columnIndex - 1);
+    const auto previousY = getY(hasPrevious ? previous.last : column.first);
+
+    auto vertex = &series.vertices[slot * 4];
+    vertex[0] = sf::Vertex(sf::Vector2f(hasPrevious ? x - m_columnWidth : x, previousY), series.color);
+    vertex[1] = sf::Vertex(sf::Vector2f(x, getY(column.first)), series.color);
+    vertex[2] = sf::Vertex(sf::Vector2f(x, top), series.color);
+    vertex[3] = sf::Vertex(sf::Vector2f(x, bottom), series.color);
+}
+
+void Plot::updateColumns() const
+{
+    // A column is a pixel wide, unless there are fewer samples than pixels
+    const auto width = std::max(1.0f, std::floor(m_rectangle.getSize().x));
+    m_columnCount = std::min(static_cast <size_t>(width), m_capacity);
+    m_columnWidth = width / m_columnCount;
+    m_samplesPerColumn = (m_capacity + m_columnCount - 1) / m_columnCount;
+    m_columnsSize = m_rectangle.getSize();
+
+    for (auto& series : m_series)
+    {
+        series.columns.assign(m_columnCount, { NoColumn, 0.0f, 0.0f, 0.0f, 0.0f });
+        series.vertices.assign(m_columnCount * 4, sf::Vertex(sf::Vector2f(), sf::Color::Transparent));
+
+        // Only whole columns of kept samples are shown, so the oldest column is not cut
+        const auto keptCount = std::min <sf::Uint64>(series.sampleCount, m_capacity);
+        auto firstIndex = series.sampleCount - keptCount;
+        firstIndex = (firstIndex + m_samplesPerColumn - 1) / m_samplesPerColumn * m_samplesPerColumn;
+
+        for (auto i = firstIndex; i < series.sampleCount; i++)
+            addToColumn(series, i, series.samples[i % m_capacity]);
+    }
+
+    m_columnsNeedUpdate = false;
+}
+
+float Plot::getY(const float value) const
+{
+    const auto height = m_rectangle.getSize().y;
+    const auto range = m_maximum - m_minimum;
+
+    if (range == 0.0f)
+        return height / 2;
+
+    const auto ratio = std::max(0.0f, std::min(1.0f, (value - m_minimum) / range));
+    return (1.0f - ratio) * height;
+}
+
+void Plot::render(DrawSink& sink, sf::RenderStates states) const
+{
+    if (m_state == WidgetState::Hidden || m_theme == nullptr)
+        return;
+
+    if (m_contentNeedsUpdate)
+    {
+        refreshTheme();
+        m_contentNeedsUpdate = false;
+
+        // Position and decorations do not change columns
+        if (m_rectangle.getSize() != m_columnsSize)
+            m_columnsNeedUpdate = true;
+    }
+
+    if (m_columnsNeedUpdate)
+        updateColumns();
+
+    sink.drawRectangle(m_rectangle, states);
+
+    // Clip lines
+    const auto bounds = m_rectangle.getGlobalBounds();
+    sf::View view;
+    if (!getClipView(sink, states.transform, bounds, view))
+        return;
+
+    const auto oldView = sink.getView();
+    sink.setView(view);
+
+    // The newest column is put at the right border: columns after it in the ring are drawn first
+    // from the left border, then columns from the beginning of the ring up to the newest one
+    states.transform.translate(m_rectangle.getPosition());
+
+    for (const auto& series : m_series)
+    {
+        if (series.sampleCount == 0)
+            continue;
+
+        const auto newestSlot = static_cast <size_t>((series.sampleCount - 1) / m_samplesPerColumn % m_columnCount);
+
+        auto olderStates = states;
+        olderStates.transform.translate(-(newestSlot + 1.0f) * m_columnWidth, 0.0f);
+        if (newestSlot + 1 < m_columnCount)
+            sink.drawVertices(&series.vertices[(newestSlot + 1) * 4], (m_columnCount - newestSlot - 1) * 4, sf::Lines, olderStates);
+
+        auto newerStates = states;
+        newerStates.transform.translate((m_columnCount - newestSlot - 1.0f) * m_columnWidth, 0.0f);
+        sink.drawVertices(&series.vertices[0], (newestSlot + 1) * 4, sf::Lines, newerStates);
+    }
+
+    sink.setView(oldView);
+}
+
+UiLoader::UiLoader() : m_lineNumber(0)
+{
+    //ctor
+}
+
+UiLoader::~UiLoader()
+{
+    //dtor
+}
+
+void UiLoader::addFont(const std::string& name, const sf::Font& font, const sf::Uint64 fontHash)
+{
+    m_fonts[name] = std::make_pair(&font, fontHash);
+}
+
+void UiLoader::addTexture(const std::string& name, const sf::Texture& texture)
+{
+    m_textures[name] = &texture;
+}
+
+bool UiLoader::loadFromFile(const std::string& fileName)
+{
+    clear();
+
+    std::ifstream fin(fileName, std::ios::binary);
+    if (!fin)
+    {
+        sf::err() << "Failed to open UI description \"" << fileName << "\"" << std::endl;
+        return false;
+    }
+
+    fin.seekg(0, std::ios::end);
+    m_source.resize(static_cast <size_t>(fin.tellg()));
+    fin.seekg(0, std::ios::beg);
+    fin.read(&m_source[0], m_source.size());
+
+    if (!parse())
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool UiLoader::loadFromMemory(const std::string_view description)
+{
+    clear();
+
+    // The only copy of the description: all names and values refer to it while parsing
+    m_source.assign(description.data(), description.size());
+
+    if (!parse())
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void UiLoader::clear()
+{
+    m_widgetsByName.clear();
+    m_themesByName.clear();
+    m_decorationsByName.clear();
+    m_textSettingsByName.clear();
+
+    // Widgets refer to themes, themes refer to settings
+    m_widgets.clear();
+    m_themes.clear();
+    m_decorationSettings.clear();
+    m_textSettings.clear();
+
+    m_source.clear();
+    m_lineNumber = 0;
+}
+
+Widget* UiLoader::getWidget(const std::string_view name) const
+{
+    const auto it = m_widgetsByName.find(name);
+    return it != m_widgetsByName.cend() ? it->second : nullptr;
+}
+
+TextSettings* UiLoader::getTextSettings(const std::string_view name) const
+{
+    const auto it = m_textSettingsByName.find(name);
+    return it != m_textSettingsByName.cend() ? it->second : nullptr;
+}
+
+DecorationSettings* UiLoader::getDecorationSettings(const std::string_view name) const
+{
+    const auto it = m_decorationsByName.find(name);
+    return it != m_decorationsByName.cend() ? it->second : nullptr;
+}
+
+const Theme* UiLoader::getTheme(const std::string_view name) const
+{
+    const auto it = m_themesByName.find(name);
+    return it != m_themesByName.cend() ? it->second : nullptr;
+}
+
+bool UiLoader::parse()
+{
+    std::string_view source(m_source);
+    std::vector <Property> properties;
+    std::vector <TextBasedWidget*> widgetsToFit;
+
+    for (m_lineNumber = 1; !source.empty(); m_lineNumber++)
+    {
+        const auto lineEnd = source.find('\n');
+        auto line = source.substr(0, lineEnd);
+        source.remove_prefix(lineEnd == std::string_view::npos ? source.size() : lineEnd + 1);
+
+        // Empty lines and comments
+        Property type;
+        if (!nextToken(line, type))
+            continue;
+
+        Property name;
+        if (!type.value.empty() || !nextToken(line, name) || !name.value.empty())
+            return reportError("type and name are expected at the beginning of the line", type.key);
+
+        properties.clear();
+        for (Property property; nextToken(line, property);)
+            properties.push_back(property);
+
+        if (!line.empty())
+            return reportError("closing quote is missing", line);
+
+        bool isCreated = false;
+        bool fitToText = false;
+
+        if (type.key == "TextSettings")
+            isCreated = createTextSettings(name.key, properties);
+        else if (type.key == "DecorationSettings")
+            isCreated = createDecorationSettings(name.key, properties);
+        else if (type.key == "Theme")
+            isCreated = createTheme(name.key, properties);
+        else
+            isCreated = createWidget(type.key, name.key, properties, fitToText);
+
+        if (!isCreated)
+            return false;
+
+        if (fitToText)
+            widgetsToFit.push_back(static_cast <TextBasedWidget*>(m_widgets.back().get()));
+    }
+
+    // Sizes depend on the text and the theme, so they are calculated only once when everything is set
+    for (auto widget : widgetsToFit)
+        widget->setSizeFitToText();
+
+    return true;
+}
+
+bool UiLoader::nextToken(std::string_view& line, Property& token)
+{
+    const auto tokenBegin = line.find_first_not_of(" \t\r");
+
+    // Nothing is left or the rest is a comment
+    if (tokenBegin == std::string_view::npos || line[tokenBegin] == '#')
+    {
+        line = std::string_view();
+        return false;
+    }
+
+    line.remove_prefix(tokenBegin);
+
+    const auto keyEnd = line.find_first_of(" \t\r=");
+    token.key = line.substr(0, keyEnd);
+    token.value = std::string_view();
+
+    if (keyEnd == std::string_view::npos || line[keyEnd] != '=')
+    {
+        line.remove_prefix(token.key.size());
+        return true;
+    }
+
+    line.remove_prefix(keyEnd + 1);
+
+    if (!line.empty() && line[0] == '"')
+    {
+        size_t closingQuote = 1;
+        for (; closingQuote < line.size() && line[closingQuote] != '"'; closingQuote++)
+        {
+            if (line[closingQuote] == '\\')
+                closingQuote++;
+        }
+
+        // The line is left non-empty to report the error
+        if (closingQuote >= line.size())
+            return false;
+
+        token.value = line.substr(1, closingQuote - 1);
+        line.remove_prefix(closingQuote + 1);
+    }
+    else
+    {
+        const auto valueEnd = line.find_first_of(" \t\r");
+        token.value = line.substr(0, valueEnd);
+        line.remove_prefix(token.value.size());
+    }
+
+    return true;
+}
+
+bool UiLoader::reportError(const std::string_view message, const std::string_view subject) const
+{
+    sf::err() << "Failed to load UI description (line " << m_lineNumber << "): " << message << " '" << subject << "'" << std::endl;
+    return false;
+}
+
+bool UiLoader::createTextSettings(const std::string_view name, const std::vector <Property>& properties)
+{
+    if (m_textSettingsByName.find(name) != m_textSettingsByName.cend())
+        return reportError("text settings are already defined", name);
+
+    const sf::Font* font = nullptr;
+    sf::Uint64 fontHash = 0;
+    unsigned int characterSize = 30;
+    auto horizontalAlignment = TextHorizontalAlignment::Center;
+    auto verticalAlignment = TextVerticalAlignment::Center;
+    sf::String glyphs;
+
+    for (const auto& property : properties)
+    {
+        bool isCorrect = false;
+
+        if (property.key == "font")
+        {
+            const auto it = m_fonts.find(property.value);
+            isCorrect = (it != m_fonts.cend());
+
+            if (isCorrect)
+            {
+                font = it->second.first;
+                fontHash = it->second.second;
+            }
+        }
+        else if (property.key == "characterSize")
+            isCorrect = parseUnsigned(property.value, characterSize);
+        else if (property.key == "horizontalAlignment")
+            isCorrect = parseHorizontalAlignment(property.value, horizontalAlignment);
+        else if (property.key == "verticalAlignment")
+            isCorrect = parseVerticalAlignment(property.value, verticalAlignment);
+        else if (property.key == "glyphs")
+        {
+            glyphs += parseString(property.value);
+            isCorrect = true;
+        }
+        else
+            return reportError("unknown property", property.key);
+
+        if (!isCorrect)
+            return reportError("incorrect value", property.value);
+    }
+
+    if (font == nullptr)
+        return reportError("font is not specified for", name);
+
+    m_textSettings.push_back(std::make_unique <TextSettings>(*font, characterSize, horizontalAlignment, verticalAlignment));
+    m_textSettings.back()->setFontHash(fontHash);
+    m_textSettings.back()->addGlyphs(glyphs);
+    m_textSettingsByName.emplace(name, m_textSettings.back().get());
+
+    return true;
+}
+
+bool UiLoader::createDecorationSettings(const std::string_view name, const std::vector <Property>& properties)
+{
+    if (m_decorationsByName.find(name) != m_decorationsByName.cend())
+        return reportError("decoration settings are already defined", name);
+
+    auto settings = std::make_unique <DecorationSettings>();
+
+    for (const auto& property : properties)
+    {
+        bool isCorrect = false;
+        sf::Color color;
+
+        if (property.key == "fillColor")
+        {
+            isCorrect = parseColor(property.value, color);
+            settings->setFillColor(color);
+        }
+        else if (property.key == "textColor")
+        {
+            isCorrect = parseColor(property.value, color);
+            settings->setTextColor(color);
+        }
+        else if (property.key == "outlineColor")
+        {
+            isCorrect = parseColor(property.value, color);
+            settings->setOutlineColor(color);
+        }
+        else if (property.key == "textStyle")
+        {
+            sf::Uint32 style = sf::Text::Style::Regular;
+            isCorrect = parseTextStyle(property.value, style);
+            settings->setTextStyle(style);
+        }
+        else if (property.key == "outlineThickness")
+        {
+            float thickness = 0.0f;
+            isCorrect = parseFloat(property.value, thickness);
+            settings->setOutlineThickness(thickness);
+        }
+        else if (property.key == "backgroundTexture")
+        {
+            const auto it = m_textures.find(property.value);
+            isCorrect = (it != m_textures.cend());
+
+            if (isCorrect)
+                settings->setBackgroundTexture(it->second);
+        }
+        else
+            return reportError("unknown property", property.key);
+
+        if (!isCorrect)
+            return reportError("incorrect value", property.value);
+    }
+
+    m_decorationSettings.push_back(std::move(settings));
+    m_decorationsByName.emplace(name, m_decorationSettings.back().get());
+
+    return true;
+}
+
+bool UiLoader::createTheme(const std::string_view name, const std::vector <Property>& properties)
+{
+    if (m_themesByName.find(name) != m_themesByName.cend())
+        return reportError("theme is already defined", name);
+
+    const TextSettings* text = nullptr;
+    const DecorationSettings* idle = nullptr;
+    const DecorationSettings* hover = nullptr;
+    const DecorationSettings* press = nullptr;
+    float transitionDuration = 0.0f;
+
+    for (const auto& property : properties)
+    {
+        if (property.key == "text")
+            text = getTextSettings(property.value);
+        else if (property.key == "idle")
+            idle = getDecorationSettings(property.value);
+        else if (property.key == "hover")
+            hover = getDecorationSettings(property.value);
+        else if (property.key == "press")
+            press = getDecorationSettings(property.value);
+        else if (property.key == "transitionDuration")
+        {
+            if (!parseFloat(property.value, transitionDuration) || transitionDuration < 0.0f)
+                return reportError("incorrect value", property.value);
+        }
+        else
+            return reportError("unknown property", property.key);
+    }
+
+    if (text == nullptr || idle == nullptr || hover == nullptr || press == nullptr)
+        return reportError("theme requires existing 'text', 'idle', 'hover' and 'press' settings", name);
+
+    m_themes.push_back(std::make_unique <Theme>(*text, *idle, *hover, *press));
+    m_themes.back()->setTransitionDuration(sf::seconds(transitionDuration));
+    m_themesByName.emplace(name, m_themes.back().get());
+
+    return true;
+}
+
+bool UiLoader::createWidget(const std::string_view type, const std::string_view name, const std::vector <Property>& properties, bool& fitToText)
+{
+    if (m_widgetsByName.find(name) != m_widgetsByName.cend())
+        return reportError("widget is already defined", name);
+
+    std::unique_ptr <Widget> widget;
+
+    if (type == "PushButton")
+        widget = std::make_unique <PushButton>();
+    else if (type == "IconButton")
+        widget = std::make_unique <IconButton>();
+    else if (type == "DropDownList")
+        widget = std::make_unique <DropDownList>();
+    else if (type == "TextBox")
+        widget = std::make_unique <TextBox>();
+    else if (type == "CheckBox")
+        widget = std::make_unique <CheckBox>();
+    else if (type == "StaticText")
+        widget = std::make_unique <StaticText>();
+    else
+        return reportError("unknown type", type);
+
+    bool hasTheme = false;
+
+    for (const auto& property : properties)
+    {
+        if (!applyProperty(*widget, property, fitToText))
+            return false;
+
+        hasTheme = hasTheme || property.key == "theme";
+    }
+
+    if (fitToText && !hasTheme)
+        return reportError("size cannot fit the text without a theme", name);
+
+    m_widgets.push_back(std::move(widget));
+    m_widgetsByName.emplace(name, m_widgets.back().get());
+
+    return true;
+}
+
+bool UiLoader::applyProperty(Widget& widget, const Property& property, bool& fitToText) const
+{
+    const auto& key = property.key;
+    const auto& value = property.value;
+    bool isCorrect = false;
+
+    if (key == "theme")
+    {
+        const auto theme = getTheme(value);
+        isCorrect = (theme != nullptr);
+
+        if (isCorrect)
+            widget.setTheme(*theme);
+    }
+    else if (key == "position")
+    {
+        sf::Vector2f position;
+        isCorrect = parseVector(value, position);
+        widget.setPosition(position);
+    }
+    else if (key == "size" && value == "fit")
+    {
+        // Delayed till the end of loading to lay out the widget once
+        fitToText = (dynamic_cast <TextBasedWidget*>(&widget) != nullptr);
+        isCorrect = fitToText;
+    }
+    else if (key == "size")
+    {
+        sf::Vector2f size;
+        isCorrect = parseVector(value, size);
+        widget.setSize(size);
+    }
+    else if (key == "backgroundTextureRect")
+    {
+        sf::IntRect rectangle;
+        isCorrect = parseRect(value, rectangle);
+        widget.setBackgroundTextureRect(rectangle);
+    }
+    else if (key == "hidden")
+    {
+        bool isHidden = false;
+        isCorrect = parseBool(value, isHidden);
+
+        if (isHidden)
+            widget.hide();
+    }
+    else if (key == "string" || key == "padding" || key == "multilined")
+    {
+        auto textWidget = dynamic_cast <TextBasedWidget*>(&widget);
+        if (textWidget == nullptr)
+            return reportError("the widget has no text for property", key);
+
+        if (key == "string")
+        {
+            textWidget->setString(parseString(value));
+            isCorrect = true;
+        }
+        else if (key == "padding")
+        {
+            sf::Vector2f padding;
+            isCorrect = parseVector(value, padding);
+            textWidget->setPadding(padding);
+        }
+        else
+        {
+            bool isMultiline = false;
+            isCorrect = parseBool(value, isMultiline);
+            textWidget->setMultilined(isMultiline);
+        }
+    }
+    else if (key == "iconTexture" || key == "iconTextureRect")
+    {
+        auto iconButton = dynamic_cast <IconButton*>(&widget);
+        if (iconButton == nullptr)
+            return reportError("the widget has no icon for property", key);
+
+        if (key == "iconTexture")
+        {
+            const auto it = m_textures.find(value);
+            isCorrect = (it != m_textures.cend());
+
+            if (isCorrect)
+                iconButton->setIconTexture(*it->second);
+        }
+        else
+        {
+            sf::IntRect rectangle;
+            isCorrect = parseRect(value, rectangle);
+            iconButton->setIconTextureRect(rectangle);
+        }
+    }
+    else if (key == "maxInputLength")
+    {
+        auto textBox = dynamic_cast <TextBox*>(&widget);
+        if (textBox == nullptr)
+            return reportError("only TextBox has property", key);
+
+        unsigned int maxInputLength = 0;
+        isCorrect = parseUnsigned(value, maxInputLength);
+        textBox->setMaxInputLength(maxInputLength);
+    }
+    else if (key == "checked")
+    {
+        auto checkBox = dynamic_cast <CheckBox*>(&widget);
+        if (checkBox == nullptr)
+            return reportError("only CheckBox has property", key);
+
+        bool isChecked = false;
+        isCorrect = parseBool(value, isChecked);
+        checkBox->setChecked(isChecked);
+    }
+    else if (key == "itemsTheme")
+    {
+        auto dropDownList = dynamic_cast <DropDownList*>(&widget);
+        if (dropDownList == nullptr)
+            return reportError("only DropDownList has property", key);
+
+        const auto theme = getTheme(value);
+        isCorrect = (theme != nullptr);
+
+        if (isCorrect)
+            dropDownList->setItemsTheme(*theme);
+    }
+    else
+        return reportError("unknown property", key);
+
+    if (!isCorrect)
+        return reportError("incorrect value", value);
+
+    return true;
+}
+
+bool UiLoader::parseFloat(const std::string_view value, float& result)
+{
+    // Values always refer to 'm_source', so the number is followed by a delimiter or '\0'
+    char* end = nullptr;
+    result = std::strtof(value.data(), &end);
+
+    return !value.empty() && end == value.data() + value.size();
+}
+
+bool UiLoader::parseUnsigned(const std::string_view value, unsigned int& result)
+{
+    if (value.empty() || value[0] < '0' || value[0] > '9')
+        return false;
+
+    char* end = nullptr;
+    result = static_cast <unsigned int>(std::strtoul(value.data(), &end, 10));
+
+    return end == value.data() + value.size();
+}
+
+bool UiLoader::parseBool(const std::string_view value, bool& result)
+{
+    result = (value == "true");
+    return result || value == "false";
+}
+
+bool UiLoader::parseVector(const std::string_view value, sf::Vector2f& result)
+{
+    const auto comma = value.find(',');
+    if (comma == std::string_view::npos)
+        return false;
+
+    return parseFloat(value.substr(0, comma), result.x) && parseFloat(value.substr(comma + 1), result.y);
+}
+
+bool UiLoader::parseRect(const std::string_view value, sf::IntRect& result)
+{
+    int* fields[] = { &result.left, &result.top, &result.width, &result.height };
+    auto rest = value;
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        const auto comma = rest.find(',');
+        const auto field = rest.substr(0, comma);
+
+        if (field.empty() || (i + 1 < 4) != (comma != std::string_view::npos))
+            return false;
+
+        char* end = nullptr;
+        *fields[i] = static_cast <int>(std::strtol(field.data(), &end, 10));
+
+        if (end != field.data() + field.size())
+            return false;
+
+        rest.remove_prefix(comma == std::string_view::npos ? rest.size() : comma + 1);
+    }
+
+    return true;
+}
+
+bool UiLoader::parseColor(const std::string_view value, sf::Color& result)
+{
+    if (!value.empty() && value[0] == '#')
+    {
+        if (value.size() != 7 && value.size() != 9)
+            return false;
+
+        sf::Uint32 rgba = 0;
+
+        for (size_t i = 1; i < value.size(); i++)
+        {
+            const auto c = value[i];
+
+            if (c >= '0' && c <= '9')
+                rgba = rgba * 16 + (c - '0');
+            else if (c >= 'A' && c <= 'F')
+                rgba = rgba * 16 + (c - 'A' + 10);
+            else if (c >= 'a' && c <= 'f')
+                rgba = rgba * 16 + (c - 'a' + 10);
+            else
+                return false;
+        }
+
+        // Opaque if alpha is omitted
+        if (value.size() == 7)
+            rgba = (rgba << 8) | 0xFF;
+
+        result = sf::Color(rgba);
+        return true;
+    }
+
+    if (value == "Black")
+        result = sf::Color::Black;
+    else if (value == "White")
+        result = sf::Color::White;
+    else if (value == "Red")
+        result = sf::Color::Red;
+    else if (value == "Green")
+        result = sf::Color::Green;
+    else if (value == "Blue")
+        result = sf::Color::Blue;
+    else if (value == "Yellow")
+        result = sf::Color::Yellow;
+    else if (value == "Magenta")
+        result = sf::Color::Magenta;
+    else if (value == "Cyan")
+        result = sf::Color::Cyan;
+    else if (value == "Transparent")
+        result = sf::Color::Transparent;
+    else
+        return false;
+
+    return true;
+}
+
+bool UiLoader::parseTextStyle(const std::string_view value, sf::Uint32& result)
+{
+    result = sf::Text::Style::Regular;
+    auto rest = value;
+
+    while (!rest.empty())
+    {
+        const auto separator = rest.find('|');
+        const auto style = rest.substr(0, separator);
+
+        if (style == "Bold")
+            result |= sf::Text::Style::Bold;
+        else if (style == "Italic")
+            result |= sf::Text::Style::Italic;
+        else if (style == "Underlined")
+            result |= sf::Text::Style::Underlined;
+        else if (style == "StrikeThrough")
+            result |= sf::Text::Style::StrikeThrough;
+        else if (style != "Regular")
+            return false;
+
+        rest.remove_prefix(separator == std::string_view::npos ? rest.size() : separator + 1);
+    }
+
+    return true;
+}
+
+bool UiLoader::parseHorizontalAlignment(const std::string_view value, TextHorizontalAlignment& result)
+{
+    if (value == "Left")
+        result = TextHorizontalAlignment::Left;
+    else if (value == "Center")
+        result = TextHorizontalAlignment::Center;
+    else if (value == "Right")
+        result = TextHorizontalAlignment::Right;
+    else
+        return false;
+
+    return true;
+}
+
+bool UiLoader::parseVerticalAlignment(const std::string_view value, TextVerticalAlignment& result)
+{
+    if (value == "Top")
+        result = TextVerticalAlignment::Top;
+    else if (value == "Center")
+        result = TextVerticalAlignment::Center;
+    else if (value == "Bottom")
+        result = TextVerticalAlignment::Bottom;
+    else
+        return false;
+
+    return true;
+}
+
+sf::String UiLoader::parseString(const std::string_view value)
+{
+    // Most strings have no escape sequences and are converted directly
+    if (value.find('\\') == std::string_view::npos)
+        return sf::String::fromUtf8(value.begin(), value.end());
+
+    std::string unescaped;
+    unescaped.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        if (value[i] == '\\' && i + 1 < value.size())
+        {
+            i++;
+
+            if (value[i] == 'n')
+                unescaped += '\n';
+            else if (value[i] == 't')
+                unescaped += '\t';
+            else
+                unescaped += value[i];
+        }
+        else
+            unescaped += value[i];
+    }
+
+    return sf::String::fromUtf8(unescaped.begin(), unescaped.end());
 }
 
 }   // namespace SmallGui